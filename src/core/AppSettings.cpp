@@ -1,5 +1,6 @@
 #include "core/AppSettings.h"
 
+#include <QFileInfo>
 #include <QFont>
 #include <QSettings>
 #include <algorithm>
@@ -81,6 +82,75 @@ void AppSettings::setDefaultFontFamily(const QString& family) {
     }
 }
 
+int AppSettings::undoLimit() const {
+    int val = m_settings->value("editor/undoLimit", 500).toInt();
+    return std::clamp(val, 0, 10000);
+}
+
+void AppSettings::setUndoLimit(int limit) {
+    limit = std::clamp(limit, 0, 10000);
+    int old = m_settings->value("editor/undoLimit", 500).toInt();
+    if (old != limit) {
+        m_settings->setValue("editor/undoLimit", limit);
+        emit undoLimitChanged(limit);
+    }
+}
+
+ViewportUpdateMode AppSettings::viewportUpdateMode() const {
+    int val = m_settings->value("performance/viewportUpdateMode", 0).toInt();
+    return static_cast<ViewportUpdateMode>(
+        std::clamp(val, 0, static_cast<int>(ViewportUpdateMode::Minimal)));
+}
+
+void AppSettings::setViewportUpdateMode(ViewportUpdateMode mode) {
+    int old = m_settings->value("performance/viewportUpdateMode", 0).toInt();
+    int val = static_cast<int>(mode);
+    if (old != val) {
+        m_settings->setValue("performance/viewportUpdateMode", val);
+        emit viewportUpdateModeChanged(mode);
+    }
+}
+
+bool AppSettings::showMinimap() const {
+    return m_settings->value("view/showMinimap", true).toBool();
+}
+
+void AppSettings::setShowMinimap(bool show) {
+    if (showMinimap() != show) {
+        m_settings->setValue("view/showMinimap", show);
+        emit showMinimapChanged(show);
+    }
+}
+
+bool AppSettings::showPerformanceHud() const {
+    return m_settings->value("debug/performanceHud", false).toBool();
+}
+
+void AppSettings::setShowPerformanceHud(bool show) {
+    if (showPerformanceHud() != show) {
+        m_settings->setValue("debug/performanceHud", show);
+        emit showPerformanceHudChanged(show);
+    }
+}
+
+int AppSettings::hibernateAfterMinutes() const {
+    int val = m_settings->value("performance/hibernateAfterMinutes", 30).toInt();
+    return std::clamp(val, 0, 24 * 60);
+}
+
+void AppSettings::setHibernateAfterMinutes(int minutes) {
+    m_settings->setValue("performance/hibernateAfterMinutes", std::clamp(minutes, 0, 24 * 60));
+}
+
+int AppSettings::tabMemoryBudgetMB() const {
+    int val = m_settings->value("performance/tabMemoryBudgetMB", 1024).toInt();
+    return std::max(val, 0);
+}
+
+void AppSettings::setTabMemoryBudgetMB(int megabytes) {
+    m_settings->setValue("performance/tabMemoryBudgetMB", std::max(megabytes, 0));
+}
+
 QByteArray AppSettings::windowGeometry() const {
     return m_settings->value("window/geometry").toByteArray();
 }
@@ -112,3 +182,70 @@ QString AppSettings::language() const {
 void AppSettings::setLanguage(const QString& lang) {
     m_settings->setValue("appearance/language", lang);
 }
+
+bool AppSettings::restoreSessionEnabled() const {
+    return m_settings->value("session/restore", true).toBool();
+}
+
+void AppSettings::setRestoreSessionEnabled(bool enabled) {
+    m_settings->setValue("session/restore", enabled);
+}
+
+QList<SessionTab> AppSettings::sessionTabs() const {
+    QList<SessionTab> tabs;
+    const int count = m_settings->beginReadArray("session/tabs");
+    for (int i = 0; i < count; ++i) {
+        m_settings->setArrayIndex(i);
+        SessionTab tab;
+        tab.filePath = m_settings->value("path").toString();
+        tab.zoom = m_settings->value("zoom", 0.0).toDouble();
+        tab.center = m_settings->value("center").toPointF();
+        tabs.append(tab);
+    }
+    m_settings->endArray();
+    return tabs;
+}
+
+int AppSettings::sessionCurrentTab() const {
+    return m_settings->value("session/current", 0).toInt();
+}
+
+void AppSettings::setSession(const QList<SessionTab>& tabs, int currentTab) {
+    // beginWriteArray keeps stale entries past the new size, so drop the old list
+    m_settings->remove("session/tabs");
+    m_settings->beginWriteArray("session/tabs", int(tabs.size()));
+    for (int i = 0; i < tabs.size(); ++i) {
+        m_settings->setArrayIndex(i);
+        m_settings->setValue("path", tabs[i].filePath);
+        m_settings->setValue("zoom", tabs[i].zoom);
+        m_settings->setValue("center", tabs[i].center);
+    }
+    m_settings->endArray();
+    m_settings->setValue("session/current", currentTab);
+}
+
+QStringList AppSettings::recentFiles() const {
+    return m_settings->value("files/recent").toStringList();
+}
+
+void AppSettings::addRecentFile(const QString& filePath) {
+    const QString path = QFileInfo(filePath).absoluteFilePath();
+    QStringList files = recentFiles();
+    if (!files.isEmpty() && files.first() == path)
+        return;
+    files.removeAll(path);
+    files.prepend(path);
+    while (files.size() > kMaxRecentFiles)
+        files.removeLast();
+    m_settings->setValue("files/recent", files);
+    emit recentFilesChanged();
+}
+
+void AppSettings::removeRecentFile(const QString& filePath) {
+    const QString path = QFileInfo(filePath).absoluteFilePath();
+    QStringList files = recentFiles();
+    if (files.removeAll(path) == 0)
+        return;
+    m_settings->setValue("files/recent", files);
+    emit recentFilesChanged();
+}
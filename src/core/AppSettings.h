@@ -1,19 +1,36 @@
 #pragma once
 
 #include <QByteArray>
+#include <QList>
 #include <QObject>
+#include <QPointF>
 #include <QString>
+#include <QStringList>
 
 class QSettings;
 
 enum class AppTheme { Light, Dark };
 
+// How MindMapView repaints after scene changes; Automatic picks between full and
+// bounding-rect updates from the measured repaint cost
+enum class ViewportUpdateMode { Automatic, Full, BoundingRect, Minimal };
+
+// A map tab as it was left at exit: its file and what its view was showing.
+// A zoom of 0 means the view was never positioned and should fit the map.
+struct SessionTab {
+    QString filePath;
+    qreal zoom = 0.0;
+    QPointF center;
+};
+
 class AppSettings : public QObject {
     Q_OBJECT
 
 public:
     static AppSettings& instance();
 
+    static constexpr int kMaxRecentFiles = 50;
+
     AppTheme theme() const;
     void setTheme(AppTheme theme);
 
@@ -29,6 +46,29 @@ public:
     QString defaultFontFamily() const;
     void setDefaultFontFamily(const QString& family);
 
+    // Undo steps kept per map; 0 keeps the whole history
+    int undoLimit() const;
+    void setUndoLimit(int limit);
+
+    ViewportUpdateMode viewportUpdateMode() const;
+    void setViewportUpdateMode(ViewportUpdateMode mode);
+
+    bool showMinimap() const;
+    void setShowMinimap(bool show);
+
+    // Inactive tabs free their items after this many minutes; 0 never does
+    int hibernateAfterMinutes() const;
+    void setHibernateAfterMinutes(int minutes);
+
+    // Longest-idle tabs are hibernated while all tabs together hold more than
+    // this; 0 sets no budget
+    int tabMemoryBudgetMB() const;
+    void setTabMemoryBudgetMB(int megabytes);
+
+    // Debug: frame statistics overlay on the map view
+    bool showPerformanceHud() const;
+    void setShowPerformanceHud(bool show);
+
     QByteArray windowGeometry() const;
     void setWindowGeometry(const QByteArray& geometry);
 
@@ -41,11 +81,30 @@ public:
     QString language() const;
     void setLanguage(const QString& lang);
 
+    // Reopen the maps that were open at exit
+    bool restoreSessionEnabled() const;
+    void setRestoreSessionEnabled(bool enabled);
+
+    // Tabs saved at the last exit, and the index of the one that was current
+    QList<SessionTab> sessionTabs() const;
+    int sessionCurrentTab() const;
+    void setSession(const QList<SessionTab>& tabs, int currentTab);
+
+    // Most recently opened or saved maps first, at most kMaxRecentFiles
+    QStringList recentFiles() const;
+    void addRecentFile(const QString& filePath);
+    void removeRecentFile(const QString& filePath);
+
 signals:
     void themeChanged(AppTheme theme);
     void autoSaveSettingsChanged();
     void defaultFontSizeChanged(int size);
     void defaultFontFamilyChanged(const QString& family);
+    void undoLimitChanged(int limit);
+    void viewportUpdateModeChanged(ViewportUpdateMode mode);
+    void showMinimapChanged(bool show);
+    void showPerformanceHudChanged(bool show);
+    void recentFilesChanged();
 
 private:
     AppSettings();
@@ -0,0 +1,159 @@
+#include "core/BatchConverter.h"
+#include "scene/MindMapScene.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QProcess>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+BatchConverter::BatchConverter(QObject* parent) : QObject(parent) {}
+
+QStringList BatchConverter::supportedFormats() {
+    return {"png", "svg", "pdf", "md", "txt"};
+}
+
+bool BatchConverter::convertFile(const QString& inputPath, const QString& outputPath,
+                                 QString* errorMessage) {
+    auto fail = [errorMessage](const QString& message) {
+        if (errorMessage)
+            *errorMessage = message;
+        return false;
+    };
+
+    const QString format = QFileInfo(outputPath).suffix().toLower();
+    if (!supportedFormats().contains(format))
+        return fail(tr("Unsupported output format: %1").arg(outputPath));
+
+    MindMapScene scene;
+    if (!scene.loadFromFile(inputPath))
+        return fail(tr("Could not read file: %1").arg(inputPath));
+
+    bool ok = false;
+    if (format == "png") {
+        ok = scene.exportToPng(outputPath);
+    } else if (format == "svg") {
+        ok = scene.exportToSvg(outputPath);
+    } else if (format == "pdf") {
+        ok = scene.exportToPdf(outputPath);
+    } else {
+        QSaveFile file(outputPath);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            ok = format == "md" ? scene.exportToMarkdown(&file) : scene.exportToText(&file);
+            ok = ok && file.commit();
+        }
+    }
+
+    if (!ok)
+        return fail(tr("Could not write file: %1").arg(outputPath));
+    return true;
+}
+
+int BatchConverter::runBatch(const QString& dir, const QString& format, const QString& outputDir,
+                             int jobs) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QString suffix = format.toLower();
+    if (!supportedFormats().contains(suffix)) {
+        err << tr("Unsupported output format: %1").arg(format) << Qt::endl;
+        return 2;
+    }
+    const QDir root(dir);
+    if (!root.exists()) {
+        err << tr("No such directory: %1").arg(dir) << Qt::endl;
+        return 2;
+    }
+
+    const QDir target(outputDir.isEmpty() ? dir : outputDir);
+    QDirIterator it(dir, {"*.ymind"}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString input = it.next();
+        const QString relative = root.relativeFilePath(input);
+        QString output = target.filePath(relative);
+        output.chop(QFileInfo(input).suffix().size());
+        m_pending.append({input, output + suffix, QElapsedTimer()});
+    }
+    std::sort(m_pending.begin(), m_pending.end(),
+              [](const Job& a, const Job& b) { return a.input < b.input; });
+
+    if (m_pending.isEmpty()) {
+        out << tr("No .ymind files found in %1").arg(dir) << Qt::endl;
+        return 0;
+    }
+
+    QElapsedTimer total;
+    total.start();
+    const int fileCount = m_pending.size();
+
+    QEventLoop loop;
+    m_loop = &loop;
+    for (int i = 0; i < qMax(1, jobs); ++i)
+        startNext();
+    // Every child may already have failed to start
+    if (!m_running.isEmpty())
+        loop.exec();
+    m_loop = nullptr;
+
+    out << tr("%1 of %2 files converted, %3 failed, %4 ms")
+               .arg(m_succeeded)
+               .arg(fileCount)
+               .arg(m_failed)
+               .arg(total.elapsed())
+        << Qt::endl;
+    return m_failed > 0 ? 1 : 0;
+}
+
+void BatchConverter::startNext() {
+    if (m_pending.isEmpty()) {
+        if (m_running.isEmpty() && m_loop)
+            m_loop->quit();
+        return;
+    }
+
+    Job job = m_pending.takeFirst();
+    QDir().mkpath(QFileInfo(job.output).absolutePath());
+
+    auto* process = new QProcess(this);
+    process->setProgram(QCoreApplication::applicationFilePath());
+    process->setArguments({"--convert", job.input, job.output});
+    connect(process, &QProcess::finished, this,
+            [this, process](int exitCode, QProcess::ExitStatus status) {
+                finishJob(process, status == QProcess::NormalExit && exitCode == 0);
+            });
+    // Crashes also emit finished(); only a failed start needs handling here
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError e) {
+        if (e == QProcess::FailedToStart)
+            finishJob(process, false);
+    });
+
+    job.timer.start();
+    m_running.insert(process, job);
+    process->start();
+}
+
+void BatchConverter::finishJob(QProcess* process, bool ok) {
+    if (!m_running.contains(process))
+        return;
+    const Job job = m_running.take(process);
+
+    QTextStream out(stdout);
+    out << (ok ? "ok    " : "FAILED") << QString(" %1 ms  ").arg(job.timer.elapsed(), 7)
+        << QDir::toNativeSeparators(job.input) << Qt::endl;
+    if (ok) {
+        ++m_succeeded;
+    } else {
+        ++m_failed;
+        const QString details = QString::fromLocal8Bit(process->readAllStandardError()).trimmed();
+        if (!details.isEmpty())
+            QTextStream(stderr) << details << Qt::endl;
+    }
+
+    process->deleteLater();
+    startNext();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QEventLoop;
+class QProcess;
+
+// Headless conversion for scripted pipelines (`ymind --convert` and
+// `ymind --batch`). Runs without a MainWindow; main() selects the offscreen
+// platform before QApplication starts.
+class BatchConverter : public QObject {
+    Q_OBJECT
+
+public:
+    explicit BatchConverter(QObject* parent = nullptr);
+
+    // Output format follows the extension of |outputPath| (see supportedFormats)
+    static bool convertFile(const QString& inputPath, const QString& outputPath,
+                            QString* errorMessage = nullptr);
+    static QStringList supportedFormats();
+
+    // Converts every .ymind file under |dir| to |format|, mirroring the folder
+    // structure into |outputDir| (next to each input when empty). Each file runs
+    // in its own `ymind --convert` child process, at most |jobs| at a time,
+    // because scene rendering is tied to the GUI thread. Prints one timing line
+    // per file and returns the exit code: 0 on success, 1 if any file failed,
+    // 2 for bad arguments.
+    int runBatch(const QString& dir, const QString& format, const QString& outputDir, int jobs);
+
+private:
+    struct Job {
+        QString input;
+        QString output;
+        QElapsedTimer timer;
+    };
+
+    void startNext();
+    void finishJob(QProcess* process, bool ok);
+
+    QList<Job> m_pending;
+    QHash<QProcess*, Job> m_running;
+    QEventLoop* m_loop = nullptr;
+    int m_succeeded = 0;
+    int m_failed = 0;
+};
@@ -1,69 +1,94 @@
 #include "core/Commands.h"
-#include "scene/EdgeItem.h"
 #include "layout/LayoutEngine.h"
 #include "scene/MindMapScene.h"
 #include "scene/NodeItem.h"
 
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+
+// Strings are counted by capacity
+static qsizetype stringBytes(const QString& text) {
+    return text.capacity() * qsizetype(sizeof(QChar));
+}
+
+static qsizetype treeBytes(const NodeTree& tree) {
+    qsizetype bytes = tree.entries.capacity() * sizeof(NodeTree::Entry);
+    for (const auto& entry : tree.entries)
+        bytes += stringBytes(entry.text);
+    return bytes;
+}
+
+qsizetype retainedBytes(const QUndoCommand* command) {
+    qsizetype bytes = stringBytes(command->text());
+    if (auto* add = dynamic_cast<const AddNodeCommand*>(command))
+        bytes += add->retainedBytes();
+    else if (auto* remove = dynamic_cast<const RemoveNodeCommand*>(command))
+        bytes += remove->retainedBytes();
+    else if (auto* edit = dynamic_cast<const EditTextCommand*>(command))
+        bytes += edit->retainedBytes();
+    else if (auto* move = dynamic_cast<const MoveNodeCommand*>(command))
+        bytes += move->retainedBytes();
+    else if (auto* reparent = dynamic_cast<const ReparentNodeCommand*>(command))
+        bytes += reparent->retainedBytes();
+    else if (auto* sync = dynamic_cast<const SyncTreeCommand*>(command))
+        bytes += sync->retainedBytes();
+    else
+        bytes += sizeof(QUndoCommand);
+
+    for (int i = 0; i < command->childCount(); ++i)
+        bytes += retainedBytes(command->child(i));
+    return bytes;
+}
+
 // ===========================================================================
 // AddNodeCommand
 // ===========================================================================
 
 AddNodeCommand::AddNodeCommand(MindMapScene* scene, NodeItem* parent, const QString& text,
                                QUndoCommand* parentCmd)
-    : QUndoCommand("Add Node", parentCmd), m_scene(scene), m_parent(parent), m_text(text) {}
+    : QUndoCommand("Add Node", parentCmd),
+      m_scene(scene),
+      m_parentId(parent->id()),
+      m_text(text) {}
 
-AddNodeCommand::~AddNodeCommand() {
-    if (m_ownsObjects) {
-        delete m_edge;
-        delete m_node;
-    }
+NodeItem* AddNodeCommand::createdNode() const {
+    return m_scene->nodeById(m_nodeId);
 }
 
 void AddNodeCommand::redo() {
-    if (!m_node) {
-        // First time: create the node and edge
-        m_node = new NodeItem(m_text);
-        m_scene->addItem(m_node);
-        m_parent->addChild(m_node);
-
-        auto* edge = new EdgeItem(m_parent, m_node);
-        m_scene->addItem(edge);
-        m_parent->addEdge(edge);
-        m_node->addEdge(edge);
-        m_scene->registerEdge(edge);
-        m_edge = edge;
-
-        // Position avoiding overlap with existing nodes
-        m_node->setPos(LayoutEngine::initialChildPosition(m_node, m_parent, m_scene->rootNode(),
-                                                          m_scene->layoutStyle()));
-
-        QObject::connect(m_node, &NodeItem::doubleClicked, m_scene, &MindMapScene::startEditing);
+    NodeItem* parent = m_scene->nodeById(m_parentId);
+    if (!parent)
+        return;
+
+    NodeItem* node = m_scene->createChildNode(m_text, parent);
+    if (m_nodeId == 0) {
+        // First time: position avoiding overlap with existing nodes
+        m_nodeId = node->id();
+        m_pos = LayoutEngine::initialChildPosition(node, parent, m_scene->rootNode(),
+                                                   m_scene->layoutStyle());
     } else {
-        // Re-do: re-attach existing objects
-        m_scene->addItem(m_node);
-        m_scene->addItem(m_edge);
-        m_parent->addChild(m_node);
-        m_parent->addEdge(m_edge);
-        m_node->addEdge(m_edge);
-        m_scene->registerEdge(m_edge);
-        m_edge->updatePath();
+        // Re-do: the node comes back with the identity it had
+        node->setId(m_nodeId);
     }
+    node->setPos(m_pos);
 
     m_scene->clearSelection();
-    m_node->setSelected(true);
-    m_ownsObjects = false;
+    node->setSelected(true);
 }
 
 void AddNodeCommand::undo() {
-    // Detach from scene without deleting
-    m_parent->removeChild(m_node);
-    m_parent->removeEdge(m_edge);
-    m_node->removeEdge(m_edge);
-    m_scene->unregisterEdge(m_edge);
-    m_scene->removeItem(m_edge);
-    m_scene->removeItem(m_node);
+    NodeItem* node = m_scene->nodeById(m_nodeId);
+    if (!node)
+        return;
+
+    m_text = node->text();
+    m_pos = node->pos();
+    m_scene->destroySubtree(node);
+}
 
-    m_ownsObjects = true;
+qsizetype AddNodeCommand::retainedBytes() const {
+    return sizeof(*this) + stringBytes(m_text);
 }
 
 // ===========================================================================
@@ -71,106 +96,34 @@ void AddNodeCommand::undo() {
 // ===========================================================================
 
 RemoveNodeCommand::RemoveNodeCommand(MindMapScene* scene, NodeItem* node, QUndoCommand* parentCmd)
-    : QUndoCommand("Delete Node", parentCmd), m_scene(scene) {
-    m_snapshot = captureSubtree(node);
-}
-
-RemoveNodeCommand::~RemoveNodeCommand() {
-    if (m_ownsObjects) {
-        // We own the objects — delete them. Walk bottom-up.
-        std::function<void(const NodeSnapshot&)> cleanup = [&](const NodeSnapshot& snap) {
-            for (const auto& child : snap.children)
-                cleanup(child);
-            delete snap.edge;
-            delete snap.node;
-        };
-        cleanup(m_snapshot);
-    }
-}
-
-RemoveNodeCommand::NodeSnapshot RemoveNodeCommand::captureSubtree(NodeItem* node) const {
-    NodeSnapshot snap;
-    snap.node = node;
-    snap.parent = node->parentNode();
-    snap.position = node->pos();
-
-    // Find the edge connecting this node to its parent
-    snap.edge = nullptr;
-    if (snap.parent) {
-        snap.edge = m_scene->findEdge(snap.parent, node);
-    }
-
-    // Record index in parent's child list
-    snap.childIndex = 0;
-    if (snap.parent) {
-        snap.childIndex = snap.parent->childNodes().indexOf(node);
-    }
-
-    // Recursively capture children
-    for (auto* child : node->childNodes()) {
-        snap.children.append(captureSubtree(child));
-    }
-
-    return snap;
-}
-
-void RemoveNodeCommand::removeSubtree(const NodeSnapshot& snap) {
-    // Remove children bottom-up
-    for (const auto& child : snap.children) {
-        removeSubtree(child);
-    }
-
-    // Remove edge
-    if (snap.edge) {
-        snap.edge->sourceNode()->removeEdge(snap.edge);
-        snap.edge->targetNode()->removeEdge(snap.edge);
-        m_scene->unregisterEdge(snap.edge);
-        m_scene->removeItem(snap.edge);
-    }
-
-    // Remove from parent
-    if (snap.parent) {
-        snap.parent->removeChild(snap.node);
-    }
-
-    m_scene->removeItem(snap.node);
-}
-
-void RemoveNodeCommand::restoreSubtree(const NodeSnapshot& snap) {
-    // Restore this node
-    m_scene->addItem(snap.node);
-    snap.node->setPos(snap.position);
-
-    if (snap.parent) {
-        snap.parent->insertChild(snap.childIndex, snap.node);
-    }
-
-    // Restore edge
-    if (snap.edge) {
-        m_scene->addItem(snap.edge);
-        snap.parent->addEdge(snap.edge);
-        snap.node->addEdge(snap.edge);
-        m_scene->registerEdge(snap.edge);
-        snap.edge->updatePath();
-    }
-
-    // Restore children top-down
-    for (const auto& child : snap.children) {
-        restoreSubtree(child);
-    }
-}
+    : QUndoCommand("Delete Node", parentCmd),
+      m_scene(scene),
+      m_nodeId(node->id()),
+      m_parentId(node->parentNode() ? node->parentNode()->id() : 0),
+      m_childIndex(node->parentNode() ? node->parentNode()->childNodes().indexOf(node) : 0) {}
 
 void RemoveNodeCommand::redo() {
-    removeSubtree(m_snapshot);
-    m_ownsObjects = true;
+    NodeItem* node = m_scene->nodeById(m_nodeId);
+    if (!node)
+        return;
+
+    // Captured on every redo: positions may have changed since the last undo
+    m_snapshot = m_scene->captureTree(node);
+    m_scene->destroySubtree(node);
 }
 
 void RemoveNodeCommand::undo() {
-    restoreSubtree(m_snapshot);
-    m_ownsObjects = false;
+    NodeItem* node = m_scene->insertTree(m_snapshot, m_scene->nodeById(m_parentId), m_childIndex);
+    if (!node)
+        return;
+    m_snapshot = NodeTree();
 
     m_scene->clearSelection();
-    m_snapshot.node->setSelected(true);
+    node->setSelected(true);
+}
+
+qsizetype RemoveNodeCommand::retainedBytes() const {
+    return sizeof(*this) + treeBytes(m_snapshot);
 }
 
 // ===========================================================================
@@ -181,18 +134,40 @@ EditTextCommand::EditTextCommand(MindMapScene* scene, NodeItem* node, const QStr
                                  const QString& newText, QUndoCommand* parentCmd)
     : QUndoCommand("Edit Text", parentCmd),
       m_scene(scene),
-      m_node(node),
+      m_nodeId(node->id()),
       m_oldText(oldText),
-      m_newText(newText) {}
+      m_newText(newText),
+      m_timestamp(QDateTime::currentMSecsSinceEpoch()) {}
+
+void EditTextCommand::apply(const QString& text) {
+    if (NodeItem* node = m_scene->nodeById(m_nodeId)) {
+        node->setText(text);
+        m_scene->scheduleLayout();
+    }
+}
 
 void EditTextCommand::undo() {
-    m_node->setText(m_oldText);
-    m_scene->autoLayout();
+    apply(m_oldText);
 }
 
 void EditTextCommand::redo() {
-    m_node->setText(m_newText);
-    m_scene->autoLayout();
+    apply(m_newText);
+}
+
+bool EditTextCommand::mergeWith(const QUndoCommand* other) {
+    const auto* edit = static_cast<const EditTextCommand*>(other);
+    if (edit->m_nodeId != m_nodeId || edit->m_timestamp - m_timestamp > kMergeIntervalMs)
+        return false;
+
+    m_newText = edit->m_newText;
+    m_timestamp = edit->m_timestamp;
+    // Typing back to the original text leaves nothing to undo
+    setObsolete(m_newText == m_oldText);
+    return true;
+}
+
+qsizetype EditTextCommand::retainedBytes() const {
+    return sizeof(*this) + stringBytes(m_oldText) + stringBytes(m_newText);
 }
 
 // ===========================================================================
@@ -201,11 +176,20 @@ void EditTextCommand::redo() {
 
 MoveNodeCommand::MoveNodeCommand(NodeItem* node, const QPointF& oldPos, const QPointF& newPos,
                                  QUndoCommand* parentCmd)
-    : QUndoCommand("Move Node", parentCmd), m_node(node), m_oldPos(oldPos), m_newPos(newPos) {}
+    : QUndoCommand("Move Node", parentCmd),
+      m_scene(dynamic_cast<MindMapScene*>(node->scene())),
+      m_nodeId(node->id()),
+      m_oldPos(oldPos),
+      m_newPos(newPos) {}
+
+void MoveNodeCommand::moveTo(const QPointF& pos) {
+    NodeItem* node = m_scene ? m_scene->nodeById(m_nodeId) : nullptr;
+    if (node)
+        node->moveSubtree(pos - node->pos());
+}
 
 void MoveNodeCommand::undo() {
-    QPointF delta = m_oldPos - m_node->pos();
-    m_node->moveSubtree(delta);
+    moveTo(m_oldPos);
 }
 
 void MoveNodeCommand::redo() {
@@ -214,7 +198,176 @@ void MoveNodeCommand::redo() {
         m_firstRedo = false;
         return;
     }
-    QPointF delta = m_newPos - m_node->pos();
-    m_node->moveSubtree(delta);
+    moveTo(m_newPos);
+}
+
+bool MoveNodeCommand::mergeWith(const QUndoCommand* other) {
+    const auto* move = static_cast<const MoveNodeCommand*>(other);
+    if (move->m_nodeId != m_nodeId)
+        return false;
+
+    m_newPos = move->m_newPos;
+    setObsolete(m_newPos == m_oldPos);
+    return true;
+}
+
+qsizetype MoveNodeCommand::retainedBytes() const {
+    return sizeof(*this);
 }
 
+// ===========================================================================
+// ReparentNodeCommand
+// ===========================================================================
+
+ReparentNodeCommand::ReparentNodeCommand(MindMapScene* scene, NodeItem* node,
+                                         NodeItem* newParent, QUndoCommand* parentCmd)
+    : QUndoCommand("Reparent Node", parentCmd),
+      m_scene(scene),
+      m_nodeId(node->id()),
+      m_oldParentId(node->parentNode() ? node->parentNode()->id() : 0),
+      m_newParentId(newParent->id()) {}
+
+void ReparentNodeCommand::redo() {
+    NodeItem* node = m_scene->nodeById(m_nodeId);
+    NodeItem* oldParent = m_scene->nodeById(m_oldParentId);
+    if (!node || !oldParent)
+        return;
+
+    m_oldIndex = oldParent->childNodes().indexOf(node);
+    if (m_scene->reparentNode(node, m_scene->nodeById(m_newParentId)))
+        m_scene->scheduleLayout();
+}
+
+void ReparentNodeCommand::undo() {
+    NodeItem* node = m_scene->nodeById(m_nodeId);
+    if (m_scene->reparentNode(node, m_scene->nodeById(m_oldParentId), m_oldIndex))
+        m_scene->scheduleLayout();
+}
+
+qsizetype ReparentNodeCommand::retainedBytes() const {
+    return sizeof(*this);
+}
+
+// ===========================================================================
+// SyncTreeCommand
+// ===========================================================================
+
+namespace {
+
+// An entry as compared between two trees; sibling order is compared separately
+struct Placement {
+    quint64 parentId = 0;
+    QString text;
+    QPointF pos;
+
+    bool operator==(const Placement& other) const {
+        return parentId == other.parentId && text == other.text && pos == other.pos;
+    }
+};
+
+// By node ID; entries without one are left out
+QHash<quint64, Placement> placements(const NodeTree& tree) {
+    QHash<quint64, Placement> result;
+    result.reserve(tree.size());
+    for (int i = 0; i < tree.size(); ++i) {
+        const auto& entry = tree.entries[i];
+        if (entry.id == 0)
+            continue;
+        const bool hasParent = i > 0 && entry.parent >= 0 && entry.parent < i;
+        result.insert(entry.id, {hasParent ? tree.entries[entry.parent].id : 0, entry.text,
+                                 entry.pos});
+    }
+    return result;
+}
+
+// Child IDs per parent ID, in order
+QHash<quint64, QList<quint64>> childOrder(const NodeTree& tree) {
+    QHash<quint64, QList<quint64>> result;
+    for (int i = 1; i < tree.size(); ++i) {
+        const auto& entry = tree.entries[i];
+        if (entry.parent >= 0 && entry.parent < i)
+            result[tree.entries[entry.parent].id].append(entry.id);
+    }
+    return result;
+}
+
+} // namespace
+
+SyncTreeCommand::SyncTreeCommand(MindMapScene* scene, const NodeTree& target,
+                                 QUndoCommand* parentCmd)
+    : QUndoCommand("Reload from Disk", parentCmd),
+      m_scene(scene),
+      m_before(scene->captureTree(scene->rootNode())),
+      m_after(target) {
+    matchByRow();
+
+    // Entries left without an ID are new
+    int changes = 0;
+    for (const auto& entry : m_after.entries)
+        changes += entry.id == 0 ? 1 : 0;
+    const auto before = placements(m_before);
+    const auto after = placements(m_after);
+    for (auto it = after.cbegin(); it != after.cend(); ++it) {
+        auto old = before.constFind(it.key());
+        if (old == before.cend() || !(old.value() == it.value()))
+            ++changes;
+    }
+    for (auto it = before.cbegin(); it != before.cend(); ++it)
+        changes += after.contains(it.key()) ? 0 : 1;
+
+    // Siblings that only swapped places count once per parent
+    if (changes == 0) {
+        const auto oldOrder = childOrder(m_before);
+        const auto newOrder = childOrder(m_after);
+        for (auto it = newOrder.cbegin(); it != newOrder.cend(); ++it)
+            changes += it.value() == oldOrder.value(it.key()) ? 0 : 1;
+    }
+    m_changeCount = changes;
+}
+
+void SyncTreeCommand::matchByRow() {
+    if (m_after.isEmpty() || m_before.isEmpty())
+        return;
+
+    // The roots always match; other IDs the scene knows are kept
+    m_after.entries[0].id = m_before.entries[0].id;
+    QSet<quint64> claimed;
+    for (const auto& entry : m_after.entries) {
+        if (entry.id != 0 && m_scene->nodeById(entry.id))
+            claimed.insert(entry.id);
+    }
+
+    QList<int> rows(m_after.size(), 0);
+    for (int i = 1; i < m_after.size(); ++i) {
+        auto& entry = m_after.entries[i];
+        const int p = entry.parent >= 0 && entry.parent < i ? entry.parent : 0;
+        const int row = rows[p]++;
+        if (entry.id != 0 && claimed.contains(entry.id))
+            continue;
+        NodeItem* parent = m_scene->nodeById(m_after.entries[p].id);
+        NodeItem* candidate = parent ? parent->childAt(row) : nullptr;
+        if (candidate && !claimed.contains(candidate->id())) {
+            entry.id = candidate->id();
+            claimed.insert(entry.id);
+        } else {
+            entry.id = 0;
+        }
+    }
+}
+
+void SyncTreeCommand::redo() {
+    // Created nodes keep the IDs applyTree gave them for the next redo
+    m_scene->applyTree(m_after);
+}
+
+void SyncTreeCommand::undo() {
+    m_scene->applyTree(m_before);
+}
+
+int SyncTreeCommand::changeCount() const {
+    return m_changeCount;
+}
+
+qsizetype SyncTreeCommand::retainedBytes() const {
+    return sizeof(*this) + treeBytes(m_before) + treeBytes(m_after);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "scene/NodeTree.h"
+
 #include <QList>
 #include <QPointF>
 #include <QString>
@@ -7,7 +9,19 @@
 
 class MindMapScene;
 class NodeItem;
-class EdgeItem;
+
+// QUndoCommand::id() values for commands that merge with their predecessor
+enum CommandId {
+    EditTextCommandId = 1,
+    MoveNodeCommandId = 2,
+};
+
+// Approximate heap memory kept alive by |command| and its children: the command
+// itself, its strings and any subtree snapshot. Used for instrumentation only.
+qsizetype retainedBytes(const QUndoCommand* command);
+
+// Commands refer to nodes by ID and look them up through MindMapScene::nodeById,
+// so they stay valid when undo deletes and later rebuilds the items.
 
 // ---------------------------------------------------------------------------
 // AddNodeCommand
@@ -16,73 +30,75 @@ class AddNodeCommand : public QUndoCommand {
 public:
     AddNodeCommand(MindMapScene* scene, NodeItem* parent, const QString& text,
                    QUndoCommand* parentCmd = nullptr);
-    ~AddNodeCommand() override;
 
     void undo() override;
     void redo() override;
 
-    NodeItem* createdNode() const { return m_node; }
+    NodeItem* createdNode() const;
+    qsizetype retainedBytes() const;
 
 private:
     MindMapScene* m_scene;
-    NodeItem* m_parent;
-    NodeItem* m_node = nullptr;
-    EdgeItem* m_edge = nullptr;
+    quint64 m_parentId;
+    quint64 m_nodeId = 0; // assigned on the first redo
     QString m_text;
-    bool m_ownsObjects = false; // true when objects are detached from scene
+    QPointF m_pos;
 };
 
 // ---------------------------------------------------------------------------
 // RemoveNodeCommand
 // ---------------------------------------------------------------------------
+// The deleted subtree is kept as a NodeTree (text, position, structure, IDs)
+// rather than as detached items, and rebuilt in one batch on undo
 class RemoveNodeCommand : public QUndoCommand {
 public:
     RemoveNodeCommand(MindMapScene* scene, NodeItem* node, QUndoCommand* parentCmd = nullptr);
-    ~RemoveNodeCommand() override;
 
     void undo() override;
     void redo() override;
 
-private:
-    struct NodeSnapshot {
-        NodeItem* node;
-        EdgeItem* edge; // edge connecting to parent (nullptr for root)
-        NodeItem* parent;
-        QPointF position;
-        int childIndex; // index in parent's child list
-        QList<NodeSnapshot> children;
-    };
-
-    NodeSnapshot captureSubtree(NodeItem* node) const;
-    void removeSubtree(const NodeSnapshot& snap);
-    void restoreSubtree(const NodeSnapshot& snap);
+    qsizetype retainedBytes() const;
 
+private:
     MindMapScene* m_scene;
-    NodeSnapshot m_snapshot;
-    bool m_ownsObjects = false; // true when objects are detached from scene
+    quint64 m_nodeId;
+    quint64 m_parentId;
+    int m_childIndex; // index in the parent's child list
+    NodeTree m_snapshot;
 };
 
 // ---------------------------------------------------------------------------
 // EditTextCommand
 // ---------------------------------------------------------------------------
+// Edits of the same node less than kMergeIntervalMs apart collapse into one step
 class EditTextCommand : public QUndoCommand {
 public:
+    static constexpr qint64 kMergeIntervalMs = 2000;
+
     EditTextCommand(MindMapScene* scene, NodeItem* node, const QString& oldText,
                     const QString& newText, QUndoCommand* parentCmd = nullptr);
 
     void undo() override;
     void redo() override;
+    int id() const override { return EditTextCommandId; }
+    bool mergeWith(const QUndoCommand* other) override;
+
+    qsizetype retainedBytes() const;
 
 private:
+    void apply(const QString& text);
+
     MindMapScene* m_scene;
-    NodeItem* m_node;
+    quint64 m_nodeId;
     QString m_oldText;
     QString m_newText;
+    qint64 m_timestamp; // ms since epoch of the latest merged edit
 };
 
 // ---------------------------------------------------------------------------
 // MoveNodeCommand
 // ---------------------------------------------------------------------------
+// Consecutive moves of the same node collapse into one step
 class MoveNodeCommand : public QUndoCommand {
 public:
     MoveNodeCommand(NodeItem* node, const QPointF& oldPos, const QPointF& newPos,
@@ -90,11 +106,68 @@ public:
 
     void undo() override;
     void redo() override;
+    int id() const override { return MoveNodeCommandId; }
+    bool mergeWith(const QUndoCommand* other) override;
+
+    qsizetype retainedBytes() const;
 
 private:
-    NodeItem* m_node;
+    void moveTo(const QPointF& pos);
+
+    MindMapScene* m_scene;
+    quint64 m_nodeId;
     QPointF m_oldPos;
     QPointF m_newPos;
     bool m_firstRedo = true;
 };
 
+// ---------------------------------------------------------------------------
+// ReparentNodeCommand
+// ---------------------------------------------------------------------------
+// Moves a subtree under another node; both directions schedule a layout
+class ReparentNodeCommand : public QUndoCommand {
+public:
+    ReparentNodeCommand(MindMapScene* scene, NodeItem* node, NodeItem* newParent,
+                        QUndoCommand* parentCmd = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+    qsizetype retainedBytes() const;
+
+private:
+    MindMapScene* m_scene;
+    quint64 m_nodeId;
+    quint64 m_oldParentId;
+    quint64 m_newParentId;
+    int m_oldIndex = -1; // recorded on each redo; earlier siblings may have moved
+};
+
+// ---------------------------------------------------------------------------
+// SyncTreeCommand
+// ---------------------------------------------------------------------------
+// Brings the whole tree in line with a target copy (the file after another
+// program changed it) as one step. Both directions go through
+// MindMapScene::applyTree, so only the nodes that differ are touched. Target
+// entries are matched by ID, and by row under their matched parent when the ID
+// is missing or unknown, as in files written before IDs existed.
+class SyncTreeCommand : public QUndoCommand {
+public:
+    SyncTreeCommand(MindMapScene* scene, const NodeTree& target,
+                    QUndoCommand* parentCmd = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+    // Nodes added, removed, moved, renamed or repositioned
+    int changeCount() const;
+    qsizetype retainedBytes() const;
+
+private:
+    void matchByRow();
+
+    MindMapScene* m_scene;
+    NodeTree m_before;
+    NodeTree m_after;
+    int m_changeCount = 0;
+};
@@ -1,13 +1,20 @@
 #include "core/FileManager.h"
+#include "core/AppSettings.h"
+#include "scene/MindMapExporter.h"
 #include "scene/MindMapScene.h"
 #include "scene/MindMapView.h"
+#include "scene/NodeTree.h"
 #include "ui/TabManager.h"
 
+#include <QBuffer>
+#include <QClipboard>
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QGuiApplication>
 #include <QMainWindow>
 #include <QMessageBox>
+#include <QSaveFile>
 #include <QStackedWidget>
 #include <QStatusBar>
 
@@ -28,49 +35,28 @@ void FileManager::openFile() {
     if (filePath.isEmpty())
         return;
 
+    openFilePath(filePath);
+}
+
+void FileManager::openFilePath(const QString& filePath) {
     int existing = m_tabManager->findTabByFilePath(filePath);
     if (existing >= 0) {
         m_tabManager->switchToTab(existing);
         return;
     }
 
+    // Read and built in the background; the tab shows progress meanwhile and
+    // the file joins the recent list once it has loaded
     int cur = m_tabManager->currentIndex();
-    if (cur >= 0 && m_tabManager->isTabEmpty(cur)) {
-        auto* scene = m_tabManager->currentScene();
-        auto* view = m_tabManager->currentView();
-        if (!scene->loadFromFile(filePath)) {
-            QMessageBox::warning(m_window, "YMind", tr("Could not open file:\n%1").arg(filePath));
-            return;
-        }
-        m_tabManager->setCurrentFilePath(filePath);
-        auto& tab = m_tabManager->tab(cur);
-        if (tab.stack)
-            tab.stack->setCurrentIndex(1);
-        m_tabManager->updateTabText(cur);
-        view->zoomToFit();
-        m_tabManager->notifyTabChanged(cur);
-    } else {
-        auto* scene = new MindMapScene(m_window);
-        auto* view = new MindMapView(m_window);
-        view->setScene(scene);
-
-        if (!scene->loadFromFile(filePath)) {
-            QMessageBox::warning(m_window, "YMind", tr("Could not open file:\n%1").arg(filePath));
-            delete scene;
-            delete view;
-            return;
-        }
-
-        auto* stack = new QStackedWidget(m_window);
-        stack->addWidget(view);
-        stack->setCurrentIndex(0);
-
-        m_tabManager->addTab(scene, view, stack, filePath);
-        m_tabManager->currentView()->zoomToFit();
-    }
+    if (cur >= 0 && m_tabManager->isTabEmpty(cur))
+        m_tabManager->loadTab(cur, filePath);
+    else
+        m_tabManager->openTab(filePath);
 }
 
 void FileManager::saveFile() {
+    if (m_tabManager->isTabLoading(m_tabManager->currentIndex()))
+        return;
     if (m_tabManager->currentFilePath().isEmpty()) {
         saveFileAs();
         return;
@@ -79,9 +65,10 @@ void FileManager::saveFile() {
     auto* scene = m_tabManager->currentScene();
     QString path = m_tabManager->currentFilePath();
 
-    if (!scene->saveToFile(path)) {
+    if (!scene->saveToFile(path))
         QMessageBox::warning(m_window, "YMind", tr("Could not save file:\n%1").arg(path));
-    }
+    else
+        AppSettings::instance().addRecentFile(path);
 
     int cur = m_tabManager->currentIndex();
     if (cur >= 0) {
@@ -91,6 +78,8 @@ void FileManager::saveFile() {
 }
 
 void FileManager::saveFileAs() {
+    if (m_tabManager->isTabLoading(m_tabManager->currentIndex()))
+        return;
     QString filePath =
         QFileDialog::getSaveFileName(m_window, tr("Save Mind Map"), QString(),
                                      tr("YMind Files (*.ymind);;JSON Files (*.json);;All Files (*)"));
@@ -105,6 +94,7 @@ void FileManager::saveFileAs() {
         QMessageBox::warning(m_window, "YMind", tr("Could not save file:\n%1").arg(filePath));
         return;
     }
+    AppSettings::instance().addRecentFile(filePath);
 
     m_tabManager->setCurrentFilePath(filePath);
     int cur = m_tabManager->currentIndex();
@@ -117,10 +107,27 @@ void FileManager::saveFileAs() {
 // ---------------------------------------------------------------------------
 // Common export helper
 // ---------------------------------------------------------------------------
+void FileManager::copyToClipboard(
+    const std::function<bool(MindMapScene*, QIODevice*)>& exporter) {
+    auto* scene = m_tabManager->currentScene();
+    if (!scene || scene->isLoading())
+        return;
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    if (!exporter(scene, &buffer))
+        return;
+    QGuiApplication::clipboard()->setText(QString::fromUtf8(buffer.data()));
+    if (auto* mw = qobject_cast<QMainWindow*>(m_window))
+        mw->statusBar()->showMessage(tr("Copied to clipboard"), 3000);
+}
+
 void FileManager::doExport(const QString& dialogTitle, const QString& filter,
                            const QString& defaultExt,
                            std::function<bool(const QString&)> exporter,
                            const QString& errorLabel) {
+    if (m_tabManager->isTabLoading(m_tabManager->currentIndex()))
+        return;
     QString filePath = QFileDialog::getSaveFileName(m_window, dialogTitle, QString(), filter);
     if (filePath.isEmpty())
         return;
@@ -140,12 +147,10 @@ void FileManager::doExport(const QString& dialogTitle, const QString& filter,
 void FileManager::exportAsText() {
     doExport(tr("Export as Text"), tr("Text Files (*.txt);;All Files (*)"), ".txt",
              [this](const QString& path) {
-                 QFile file(path);
+                 QSaveFile file(path);
                  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
                      return false;
-                 file.write(m_tabManager->currentScene()->exportToText().toUtf8());
-                 file.close();
-                 return true;
+                 return m_tabManager->currentScene()->exportToText(&file) && file.commit();
              },
              tr("file"));
 }
@@ -153,16 +158,26 @@ void FileManager::exportAsText() {
 void FileManager::exportAsMarkdown() {
     doExport(tr("Export as Markdown"), tr("Markdown Files (*.md);;All Files (*)"), ".md",
              [this](const QString& path) {
-                 QFile file(path);
+                 QSaveFile file(path);
                  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
                      return false;
-                 file.write(m_tabManager->currentScene()->exportToMarkdown().toUtf8());
-                 file.close();
-                 return true;
+                 return m_tabManager->currentScene()->exportToMarkdown(&file) && file.commit();
              },
              tr("file"));
 }
 
+void FileManager::copyAsText() {
+    copyToClipboard([](MindMapScene* scene, QIODevice* device) {
+        return scene->exportToText(device);
+    });
+}
+
+void FileManager::copyAsMarkdown() {
+    copyToClipboard([](MindMapScene* scene, QIODevice* device) {
+        return scene->exportToMarkdown(device);
+    });
+}
+
 void FileManager::exportAsPng() {
     doExport(tr("Export as PNG"), tr("PNG Images (*.png);;All Files (*)"), ".png",
              [this](const QString& path) {
@@ -187,27 +202,57 @@ void FileManager::exportAsPdf() {
              "PDF");
 }
 
+void FileManager::exportAsPdfTiled() {
+    doExport(tr("Export as Tiled PDF"), tr("PDF Files (*.pdf);;All Files (*)"), ".pdf",
+             [this](const QString& path) {
+                 return MindMapExporter(m_tabManager->currentScene())
+                     .exportToPdf(path, MindMapExporter::PdfPagination::Tiled);
+             },
+             "PDF");
+}
+
+void FileManager::exportAsPdfPerBranch() {
+    doExport(tr("Export as PDF by Branch"), tr("PDF Files (*.pdf);;All Files (*)"), ".pdf",
+             [this](const QString& path) {
+                 return MindMapExporter(m_tabManager->currentScene())
+                     .exportToPdf(path, MindMapExporter::PdfPagination::PerBranch);
+             },
+             "PDF");
+}
+
 void FileManager::importFromText() {
-    QString filePath = QFileDialog::getOpenFileName(m_window, tr("Import from Text"), QString(),
-                                                    tr("Text Files (*.txt);;All Files (*)"));
+    QString filePath = QFileDialog::getOpenFileName(
+        m_window, tr("Import Outline"), QString(),
+        tr("Outlines (*.txt *.md *.markdown *.opml);;Text Files (*.txt);;"
+           "Markdown Files (*.md *.markdown);;OPML Files (*.opml);;All Files (*)"));
     if (filePath.isEmpty())
         return;
 
     QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
         QMessageBox::warning(m_window, "YMind", tr("Could not read file:\n%1").arg(filePath));
         return;
     }
-    QString text = QString::fromUtf8(file.readAll());
+    const QByteArray data = file.readAll();
     file.close();
 
+    // The parser is chosen by extension; anything unrecognised is read as tab-indented text
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    NodeTree tree;
+    if (suffix == "opml")
+        tree = NodeTree::fromOpml(data);
+    else if (suffix == "md" || suffix == "markdown")
+        tree = NodeTree::fromMarkdown(QString::fromUtf8(data));
+    else
+        tree = NodeTree::fromIndentedText(QString::fromUtf8(data));
+
     int cur = m_tabManager->currentIndex();
     if (cur >= 0 && m_tabManager->isTabEmpty(cur)) {
         auto* scene = m_tabManager->currentScene();
         auto* view = m_tabManager->currentView();
-        if (!scene->importFromText(text)) {
+        if (!scene->importTree(tree)) {
             QMessageBox::warning(m_window, "YMind",
-                                 tr("Could not parse text file:\n%1").arg(filePath));
+                                 tr("Could not parse outline file:\n%1").arg(filePath));
             return;
         }
         m_tabManager->setCurrentFilePath(QString());
@@ -221,9 +266,9 @@ void FileManager::importFromText() {
         auto* view = new MindMapView(m_window);
         view->setScene(scene);
 
-        if (!scene->importFromText(text)) {
+        if (!scene->importTree(tree)) {
             QMessageBox::warning(m_window, "YMind",
-                                 tr("Could not parse text file:\n%1").arg(filePath));
+                                 tr("Could not parse outline file:\n%1").arg(filePath));
             delete scene;
             delete view;
             return;
@@ -3,7 +3,9 @@
 #include <QObject>
 #include <functional>
 
+class MindMapScene;
 class TabManager;
+class QIODevice;
 class QWidget;
 
 class FileManager : public QObject {
@@ -13,16 +15,25 @@ public:
 
     void newFile();
     void openFile();
+    void openFilePath(const QString& filePath);
     void saveFile();
     void saveFileAs();
     void exportAsText();
     void exportAsMarkdown();
+    void copyAsText();
+    void copyAsMarkdown();
     void exportAsPng();
     void exportAsSvg();
     void exportAsPdf();
+    void exportAsPdfTiled();
+    void exportAsPdfPerBranch();
     void importFromText();
 
 private:
+    // Streams the current map through |exporter| into a buffer and puts the
+    // result on the clipboard
+    void copyToClipboard(const std::function<bool(MindMapScene*, QIODevice*)>& exporter);
+
     // Common export helper: shows save dialog, validates extension, runs exporter, shows status.
     // |dialogTitle|: title of the QFileDialog
     // |filter|: file filter string
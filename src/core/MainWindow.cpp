@@ -7,11 +7,13 @@
 #include "scene/MindMapScene.h"
 #include "scene/MindMapView.h"
 #include "ui/OutlineWidget.h"
+#include "ui/SearchBar.h"
 #include "core/AboutDialog.h"
 #include "core/SettingsDialog.h"
 #include "core/UpdateChecker.h"
 #include "ui/TabManager.h"
 #include "ui/ThemeManager.h"
+#include "ui/ThumbnailCache.h"
 
 #include <QAction>
 #include <QApplication>
@@ -72,19 +74,25 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
         updateWindowTitle();
         refreshOutline();
         updateContentVisibility();
-
-        // Reconnect undo stack -> refreshOutline for the new tab's scene
-        auto* scene = m_tabManager->currentScene();
-        if (scene) {
-            disconnect(scene->undoStack(), &QUndoStack::indexChanged, this, nullptr);
-            connect(scene->undoStack(), &QUndoStack::indexChanged, this,
-                    &MainWindow::refreshOutline);
-        }
+        m_searchBar->setScene(m_tabManager->currentScene());
+        m_searchBar->setView(m_tabManager->currentView());
     });
 
     connect(m_tabManager, &TabManager::saveRequested, m_fileManager, &FileManager::saveFile);
+    connect(m_tabManager, &TabManager::openFileRequested, m_fileManager,
+            &FileManager::openFilePath);
+    connect(m_tabManager, &TabManager::tabReloaded, this, [this](int index, int) {
+        const QString name = QFileInfo(m_tabManager->tabs().at(index).filePath).fileName();
+        statusBar()->showMessage(tr("Reloaded %1 from disk (Undo restores your version)")
+                                     .arg(name),
+                                 5000);
+    });
 
-    m_tabManager->addNewTab();
+    // Reopen the last session's maps; only the current one is read now
+    auto& settings = AppSettings::instance();
+    if (!settings.restoreSessionEnabled()
+        || !m_tabManager->restoreSession(settings.sessionTabs(), settings.sessionCurrentTab()))
+        m_tabManager->addNewTab();
 
     // Auto-save timer
     m_autoSaveTimer = new QTimer(this);
@@ -129,13 +137,9 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
 MainWindow::~MainWindow() {
     m_autoSaveTimer->stop();
 
-    // Disconnect undo stack signals that target this MainWindow before the base
-    // class destructor deletes child scenes (whose undo stacks would emit
-    // indexChanged during cleanup, calling refreshOutline on a half-destroyed object).
-    for (const auto& tab : m_tabManager->tabs()) {
-        if (tab.scene && tab.scene->undoStack())
-            disconnect(tab.scene->undoStack(), nullptr, this, nullptr);
-    }
+    // The outline follows the current scene; detach it before the base class
+    // destructor deletes the scenes
+    m_outlineWidget->setScene(nullptr);
 
     disconnect(m_tabManager, nullptr, this, nullptr);
     disconnect(&AppSettings::instance(), nullptr, this, nullptr);
@@ -208,6 +212,9 @@ void MainWindow::setupCentralLayout() {
     rightLayout->setSpacing(0);
     rightLayout->addWidget(m_toolbarWidget);
 
+    m_searchBar = new SearchBar(this);
+    rightLayout->addWidget(m_searchBar);
+
     rightLayout->addWidget(m_tabManager->contentStack(), 1);
 
     m_contentSplitter->addWidget(m_rightPanel);
@@ -325,7 +332,7 @@ void MainWindow::setupToolBar() {
     auto* layoutBtn =
         addButton("auto-layout", tr("Auto Layout"), tr("Automatically arrange all nodes (Ctrl+L)"));
     connect(layoutBtn, &QToolButton::clicked, this,
-            [this]() { if (auto* s = m_tabManager->currentScene()) s->autoLayout(); });
+            [this]() { if (auto* s = m_tabManager->currentScene()) s->scheduleLayout(); });
 
     addSeparator();
 
@@ -343,7 +350,7 @@ void MainWindow::setupToolBar() {
 
     addSeparator();
 
-    auto* exportBtn = new QToolButton(m_toolbarWidget);
+    auto* exportBtn = m_exportBtn = new QToolButton(m_toolbarWidget);
     exportBtn->setProperty("iconName", "export");
     exportBtn->setIcon(IconFactory::makeToolIcon("export"));
     exportBtn->setText(tr("Export"));
@@ -359,6 +366,10 @@ void MainWindow::setupToolBar() {
     exportBtnMenu->addAction(tr("As PNG..."), m_fileManager, &FileManager::exportAsPng);
     exportBtnMenu->addAction(tr("As SVG..."), m_fileManager, &FileManager::exportAsSvg);
     exportBtnMenu->addAction(tr("As PDF..."), m_fileManager, &FileManager::exportAsPdf);
+    exportBtnMenu->addAction(tr("As Tiled PDF..."), m_fileManager,
+                             &FileManager::exportAsPdfTiled);
+    exportBtnMenu->addAction(tr("As PDF by Branch..."), m_fileManager,
+                             &FileManager::exportAsPdfPerBranch);
     exportBtn->setMenu(exportBtnMenu);
     layout->addWidget(exportBtn);
 
@@ -409,6 +420,7 @@ void MainWindow::setupMenuBar() {
     auto* saveAsAct = fileMenu->addAction(tr("Save &As..."));
     saveAsAct->setShortcut(QKeySequence::SaveAs);
     connect(saveAsAct, &QAction::triggered, m_fileManager, &FileManager::saveFileAs);
+    m_mapOutputActions << saveAct << saveAsAct;
 
     fileMenu->addSeparator();
 
@@ -420,6 +432,7 @@ void MainWindow::setupMenuBar() {
     fileMenu->addSeparator();
 
     auto* exportMenu = fileMenu->addMenu(tr("&Export"));
+    m_mapOutputActions << exportMenu->menuAction();
 
     auto* exportTextAct = exportMenu->addAction(tr("As &Text..."));
     connect(exportTextAct, &QAction::triggered, m_fileManager, &FileManager::exportAsText);
@@ -438,7 +451,17 @@ void MainWindow::setupMenuBar() {
     auto* exportPdfAct = exportMenu->addAction(tr("As P&DF..."));
     connect(exportPdfAct, &QAction::triggered, m_fileManager, &FileManager::exportAsPdf);
 
-    auto* importAct = fileMenu->addAction(tr("&Import from Text..."));
+    auto* exportPdfTiledAct = exportMenu->addAction(tr("As Tiled PDF..."));
+    exportPdfTiledAct->setToolTip(tr("Paper-size pages at 100% with overlap marks"));
+    connect(exportPdfTiledAct, &QAction::triggered, m_fileManager,
+            &FileManager::exportAsPdfTiled);
+
+    auto* exportPdfBranchAct = exportMenu->addAction(tr("As PDF by &Branch..."));
+    exportPdfBranchAct->setToolTip(tr("An overview page, then one page per main branch"));
+    connect(exportPdfBranchAct, &QAction::triggered, m_fileManager,
+            &FileManager::exportAsPdfPerBranch);
+
+    auto* importAct = fileMenu->addAction(tr("&Import Outline..."));
     connect(importAct, &QAction::triggered, m_fileManager, &FileManager::importFromText);
 
     fileMenu->addSeparator();
@@ -459,6 +482,29 @@ void MainWindow::setupMenuBar() {
     connect(deleteAct, &QAction::triggered, this,
             [this]() { if (auto* s = m_tabManager->currentScene()) s->deleteSelected(); });
 
+    editMenu->addSeparator();
+
+    auto* copyTextAct = editMenu->addAction(tr("Copy as &Text"));
+    connect(copyTextAct, &QAction::triggered, m_fileManager, &FileManager::copyAsText);
+
+    auto* copyMdAct = editMenu->addAction(tr("Copy as &Markdown"));
+    connect(copyMdAct, &QAction::triggered, m_fileManager, &FileManager::copyAsMarkdown);
+    m_mapOutputActions << copyTextAct << copyMdAct;
+
+    editMenu->addSeparator();
+
+    auto* findAct = editMenu->addAction(tr("&Find..."));
+    findAct->setShortcut(QKeySequence::Find);
+    connect(findAct, &QAction::triggered, m_searchBar, &SearchBar::activate);
+
+    auto* findNextAct = editMenu->addAction(tr("Find &Next"));
+    findNextAct->setShortcut(QKeySequence::FindNext);
+    connect(findNextAct, &QAction::triggered, m_searchBar, &SearchBar::findNext);
+
+    auto* findPrevAct = editMenu->addAction(tr("Find Pre&vious"));
+    findPrevAct->setShortcut(QKeySequence::FindPrevious);
+    connect(findPrevAct, &QAction::triggered, m_searchBar, &SearchBar::findPrevious);
+
     // ---- View menu ----
     auto* viewMenu = menuBar()->addMenu(tr("&View"));
 
@@ -501,6 +547,17 @@ void MainWindow::setupMenuBar() {
         updateContentVisibility();
     });
 
+    auto* minimapAct = viewMenu->addAction(tr("&Minimap"));
+    minimapAct->setCheckable(true);
+    minimapAct->setChecked(AppSettings::instance().showMinimap());
+    connect(minimapAct, &QAction::toggled, &AppSettings::instance(), &AppSettings::setShowMinimap);
+
+    auto* hudAct = viewMenu->addAction(tr("&Performance Overlay"));
+    hudAct->setCheckable(true);
+    hudAct->setChecked(AppSettings::instance().showPerformanceHud());
+    connect(hudAct, &QAction::toggled, &AppSettings::instance(),
+            &AppSettings::setShowPerformanceHud);
+
     // Bidirectional sync: tab bar toggle buttons -> View menu actions
     connect(m_toggleOutlineBtn, &QToolButton::toggled, this, [this](bool checked) {
         QSignalBlocker blocker(m_toggleOutlineAct);
@@ -519,7 +576,7 @@ void MainWindow::setupMenuBar() {
     auto* autoLayoutAct = layoutMenu->addAction(tr("&Auto Layout"));
     autoLayoutAct->setShortcut(QKeySequence("Ctrl+L"));
     connect(autoLayoutAct, &QAction::triggered, this,
-            [this]() { if (auto* s = m_tabManager->currentScene()) s->autoLayout(); });
+            [this]() { if (auto* s = m_tabManager->currentScene()) s->scheduleLayout(); });
 
     // ---- Insert menu ----
     auto* insertMenu = menuBar()->addMenu(tr("&Insert"));
@@ -563,6 +620,7 @@ void MainWindow::setupMenuBar() {
 void MainWindow::closeEvent(QCloseEvent* event) {
     if (m_tabManager->maybeSave()) {
         saveWindowState();
+        saveSession();
         event->accept();
     } else {
         event->ignore();
@@ -604,6 +662,8 @@ void MainWindow::updateContentVisibility() {
 
     m_toolbarWidget->setVisible(showToolbar);
     m_outlineWidget->setVisible(showOutline);
+    if (onStartPage && m_searchBar->isVisible())
+        m_searchBar->dismiss();
 
     if (m_toggleOutlineBtn)
         m_toggleOutlineBtn->setVisible(!onStartPage);
@@ -614,13 +674,20 @@ void MainWindow::updateContentVisibility() {
         m_addChildAct->setEnabled(!onStartPage);
     if (m_addSiblingAct)
         m_addSiblingAct->setEnabled(!onStartPage);
+
+    // A map still being read has nothing to write yet
+    const bool loading = m_tabManager->isTabLoading(idx);
+    for (QAction* act : std::as_const(m_mapOutputActions))
+        act->setEnabled(!loading);
+    if (m_exportBtn)
+        m_exportBtn->setEnabled(!loading);
 }
 
 // ---------------------------------------------------------------------------
 // Outline refresh
 // ---------------------------------------------------------------------------
 void MainWindow::refreshOutline() {
-    m_outlineWidget->refresh(m_tabManager->currentScene());
+    m_outlineWidget->setScene(m_tabManager->currentScene());
     m_outlineWidget->setView(m_tabManager->currentView());
 }
 
@@ -653,6 +720,12 @@ void MainWindow::restoreWindowState() {
         QMainWindow::restoreState(state);
 }
 
+void MainWindow::saveSession() {
+    int currentTab = 0;
+    const QList<SessionTab> tabs = m_tabManager->sessionTabs(&currentTab);
+    AppSettings::instance().setSession(tabs, currentTab);
+}
+
 void MainWindow::setupAutoSaveTimer() {
     auto& s = AppSettings::instance();
     if (s.autoSaveEnabled()) {
@@ -665,7 +738,7 @@ void MainWindow::setupAutoSaveTimer() {
 void MainWindow::onAutoSaveTimeout() {
     for (int i = 0; i < m_tabManager->tabCount(); ++i) {
         const auto& tab = m_tabManager->tabs()[i];
-        if (!tab.filePath.isEmpty() && tab.scene->isModified()) {
+        if (!tab.filePath.isEmpty() && tab.scene->isModified() && !tab.scene->isLoading()) {
             if (tab.scene->saveToFile(tab.filePath)) {
                 m_tabManager->updateTabText(i);
             }
@@ -714,6 +787,12 @@ void MainWindow::applyTheme() {
             if (!tid.isEmpty())
                 card->setIcon(QIcon(IconFactory::makeTemplatePreview(tid, 160, 106)));
         }
+
+        // Recent-map thumbnails follow the theme's palette; the cache re-renders
+        // them and the start pages pick the new images up as they arrive
+        const auto recentCards = stack->findChildren<QToolButton*>("recentFileCard");
+        for (auto* card : recentCards)
+            ThumbnailCache::instance().thumbnail(card->property("filePath").toString());
     }
 }
 
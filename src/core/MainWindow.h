@@ -1,11 +1,14 @@
 #pragma once
 
+#include <QList>
 #include <QMainWindow>
 
 class TabManager;
 class FileManager;
 class OutlineWidget;
+class SearchBar;
 class UpdateChecker;
+class QAction;
 class QLabel;
 class QTimer;
 class QSplitter;
@@ -34,6 +37,7 @@ private:
     void openAbout();
     void saveWindowState();
     void restoreWindowState();
+    void saveSession();
     void setupAutoSaveTimer();
     void onAutoSaveTimeout();
     void onAutoSaveSettingsChanged();
@@ -48,6 +52,7 @@ private:
 
     // Widgets
     OutlineWidget* m_outlineWidget = nullptr;
+    SearchBar* m_searchBar = nullptr;
     QWidget* m_toolbarWidget = nullptr;
     QSplitter* m_contentSplitter = nullptr;
     QWidget* m_rightPanel = nullptr;
@@ -56,6 +61,7 @@ private:
     QToolButton* m_toggleToolbarBtn = nullptr;
     QToolButton* m_undoBtn = nullptr;
     QToolButton* m_redoBtn = nullptr;
+    QToolButton* m_exportBtn = nullptr;
     QLabel* m_statusHelpLabel = nullptr;
 
     QAction* m_toggleToolbarAct = nullptr;
@@ -64,6 +70,8 @@ private:
     QAction* m_redoAct = nullptr;
     QAction* m_addChildAct = nullptr;
     QAction* m_addSiblingAct = nullptr;
+    // Save, export and copy: off while the current tab's file is still loading
+    QList<QAction*> m_mapOutputActions;
 
     QTimer* m_autoSaveTimer = nullptr;
 };
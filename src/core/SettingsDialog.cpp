@@ -66,8 +66,59 @@ SettingsDialog::SettingsDialog(QWidget* parent) : QDialog(parent) {
     auto* hint = new QLabel(tr("Applies to newly created nodes only"));
     hint->setObjectName("settingsHint");
     editorLayout->addRow(hint);
+    m_undoLimitSpin = new QSpinBox;
+    m_undoLimitSpin->setRange(0, 10000);
+    m_undoLimitSpin->setSingleStep(50);
+    m_undoLimitSpin->setSpecialValueText(tr("Unlimited"));
+    m_undoLimitSpin->setSuffix(tr(" steps"));
+    editorLayout->addRow(tr("Undo history:"), m_undoLimitSpin);
+    auto* undoHint =
+        new QLabel(tr("Applies to newly opened maps and to open maps without undo history"));
+    undoHint->setObjectName("settingsHint");
+    editorLayout->addRow(undoHint);
     mainLayout->addWidget(editorGroup);
 
+    // Performance group
+    auto* performanceGroup = new QGroupBox(tr("Performance"));
+    auto* performanceLayout = new QFormLayout(performanceGroup);
+    m_updateModeCombo = new QComboBox;
+    m_updateModeCombo->addItem(tr("Automatic"), int(ViewportUpdateMode::Automatic));
+    m_updateModeCombo->addItem(tr("Full viewport"), int(ViewportUpdateMode::Full));
+    m_updateModeCombo->addItem(tr("Changed area"), int(ViewportUpdateMode::BoundingRect));
+    m_updateModeCombo->addItem(tr("Changed items only"), int(ViewportUpdateMode::Minimal));
+    performanceLayout->addRow(tr("Canvas repaint:"), m_updateModeCombo);
+    auto* updateModeHint =
+        new QLabel(tr("Automatic switches to partial repaints on slow displays"));
+    updateModeHint->setObjectName("settingsHint");
+    performanceLayout->addRow(updateModeHint);
+    m_hibernateSpin = new QSpinBox;
+    m_hibernateSpin->setRange(0, 24 * 60);
+    m_hibernateSpin->setSingleStep(5);
+    m_hibernateSpin->setSpecialValueText(tr("Never"));
+    m_hibernateSpin->setSuffix(tr(" min"));
+    performanceLayout->addRow(tr("Hibernate idle tabs after:"), m_hibernateSpin);
+    m_tabBudgetSpin = new QSpinBox;
+    m_tabBudgetSpin->setRange(0, 64 * 1024);
+    m_tabBudgetSpin->setSingleStep(256);
+    m_tabBudgetSpin->setSpecialValueText(tr("Unlimited"));
+    m_tabBudgetSpin->setSuffix(tr(" MB"));
+    performanceLayout->addRow(tr("Memory for all tabs:"), m_tabBudgetSpin);
+    auto* hibernateHint =
+        new QLabel(tr("Hibernated tabs keep their history and are rebuilt when shown"));
+    hibernateHint->setObjectName("settingsHint");
+    performanceLayout->addRow(hibernateHint);
+    mainLayout->addWidget(performanceGroup);
+
+    // Startup group
+    auto* startupGroup = new QGroupBox(tr("Startup"));
+    auto* startupLayout = new QFormLayout(startupGroup);
+    m_restoreSessionCheck = new QCheckBox(tr("Reopen maps from the last session"));
+    startupLayout->addRow(m_restoreSessionCheck);
+    auto* sessionHint = new QLabel(tr("Background tabs are read when first shown"));
+    sessionHint->setObjectName("settingsHint");
+    startupLayout->addRow(sessionHint);
+    mainLayout->addWidget(startupGroup);
+
     // Updates group
     auto* updatesGroup = new QGroupBox(tr("Updates"));
     auto* updatesLayout = new QFormLayout(updatesGroup);
@@ -97,6 +148,12 @@ void SettingsDialog::loadCurrentSettings() {
     m_autoSaveIntervalSpin->setEnabled(s.autoSaveEnabled());
     m_fontSizeSpin->setValue(s.defaultFontSize());
     m_fontFamilyCombo->setCurrentFont(QFont(s.defaultFontFamily()));
+    m_undoLimitSpin->setValue(s.undoLimit());
+    m_updateModeCombo->setCurrentIndex(
+        m_updateModeCombo->findData(int(s.viewportUpdateMode())));
+    m_hibernateSpin->setValue(s.hibernateAfterMinutes());
+    m_tabBudgetSpin->setValue(s.tabMemoryBudgetMB());
+    m_restoreSessionCheck->setChecked(s.restoreSessionEnabled());
     m_checkUpdatesCheck->setChecked(s.checkForUpdatesEnabled());
 
     int langIdx = m_languageCombo->findData(s.language());
@@ -117,6 +174,12 @@ void SettingsDialog::apply() {
     s.setAutoSaveIntervalMinutes(m_autoSaveIntervalSpin->value());
     s.setDefaultFontSize(m_fontSizeSpin->value());
     s.setDefaultFontFamily(m_fontFamilyCombo->currentFont().family());
+    s.setUndoLimit(m_undoLimitSpin->value());
+    s.setViewportUpdateMode(
+        static_cast<ViewportUpdateMode>(m_updateModeCombo->currentData().toInt()));
+    s.setHibernateAfterMinutes(m_hibernateSpin->value());
+    s.setTabMemoryBudgetMB(m_tabBudgetSpin->value());
+    s.setRestoreSessionEnabled(m_restoreSessionCheck->isChecked());
     s.setCheckForUpdatesEnabled(m_checkUpdatesCheck->isChecked());
     s.setLanguage(m_languageCombo->currentData().toString());
 }
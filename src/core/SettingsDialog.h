@@ -28,5 +28,10 @@ private:
     QSpinBox* m_autoSaveIntervalSpin;
     QFontComboBox* m_fontFamilyCombo;
     QSpinBox* m_fontSizeSpin;
+    QSpinBox* m_undoLimitSpin;
+    QComboBox* m_updateModeCombo;
+    QSpinBox* m_hibernateSpin;
+    QSpinBox* m_tabBudgetSpin;
+    QCheckBox* m_restoreSessionCheck;
     QCheckBox* m_checkUpdatesCheck;
 };
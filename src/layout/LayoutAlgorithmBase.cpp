@@ -23,6 +23,17 @@ qreal LayoutAlgorithmBase::LayoutAxis::nodeDepthSpan(NodeItem* node) const {
         return node->nodeRect().width();
 }
 
+qreal LayoutAlgorithmBase::LayoutAxis::storedSpan(NodeItem* node) const {
+    // The block is not centered on the node; reserving its larger half on both
+    // sides keeps it clear of the neighbours either way
+    const QRectF stored = node->storedChildBounds();
+    if (stored.isEmpty())
+        return 0;
+    if (spreadIsX)
+        return 2 * qMax(-stored.left(), stored.right());
+    return 2 * qMax(-stored.top(), stored.bottom());
+}
+
 LayoutAlgorithmBase::LayoutAxis LayoutAlgorithmBase::makeRightAxis(const LayoutParams& p) {
     return {false, p.depthSpacing, p.spreadSpacing, +1};
 }
@@ -107,7 +118,7 @@ qreal LayoutAlgorithmBase::measureSubtree(NodeItem* node, const LayoutAxis& axis
     auto children = node->childNodes();
     qreal selfSpan = axis.nodeSpan(node);
     if (children.isEmpty())
-        return selfSpan;
+        return qMax(selfSpan, axis.storedSpan(node));
 
     qreal total = 0;
     for (int i = 0; i < children.size(); ++i) {
@@ -31,6 +31,9 @@ protected:
         }
         qreal nodeSpan(NodeItem* node) const;
         qreal nodeDepthSpan(NodeItem* node) const;
+        // Spread taken by children still stored as a chunk, which move with
+        // the node as one block; 0 when there are none
+        qreal storedSpan(NodeItem* node) const;
     };
 
     static LayoutAxis makeRightAxis(const LayoutParams& p);
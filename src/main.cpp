@@ -1,12 +1,103 @@
 #include "core/AppSettings.h"
+#include "core/BatchConverter.h"
 #include "core/MainWindow.h"
+#include "core/TemplateRegistry.h"
+#include "layout/LayoutAlgorithmRegistry.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
 #include <QLibraryInfo>
 #include <QStyleFactory>
+#include <QTextStream>
+#include <QThread>
 #include <QTranslator>
 
+namespace {
+
+// Conversion modes never show a window, so they must be detected before
+// QApplication picks a platform plugin
+bool isConverterInvocation(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        if (arg == "--convert" || arg == "--batch" || arg.startsWith("--batch="))
+            return true;
+    }
+    return false;
+}
+
+int runConverter(QApplication& app) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QApplication::translate("main", "Convert YMind files without opening a window."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QString formats = BatchConverter::supportedFormats().join(", ");
+    QCommandLineOption convertOption(
+        "convert", QApplication::translate("main", "Convert <input> to <output>. The format "
+                                                   "follows the output extension (%1).")
+                       .arg(formats));
+    QCommandLineOption batchOption(
+        "batch", QApplication::translate("main", "Convert every .ymind file under <dir>."),
+        "dir");
+    QCommandLineOption formatOption(
+        "format", QApplication::translate("main", "Batch output format (%1).").arg(formats),
+        "format", "png");
+    QCommandLineOption outputOption(
+        "output",
+        QApplication::translate("main", "Batch output directory (default: next to each input)."),
+        "dir");
+    QCommandLineOption jobsOption(
+        "jobs", QApplication::translate("main", "Files converted in parallel (default: cores)."),
+        "n", QString::number(QThread::idealThreadCount()));
+    parser.addOptions({convertOption, batchOption, formatOption, outputOption, jobsOption});
+    parser.addPositionalArgument("input", QApplication::translate("main", "File to convert."));
+    parser.addPositionalArgument("output", QApplication::translate("main", "Output file."));
+    parser.process(app);
+
+    LayoutAlgorithmRegistry::instance().registerBuiltins();
+    TemplateRegistry::instance().loadBuiltins();
+
+    QTextStream err(stderr);
+    if (parser.isSet(convertOption)) {
+        const QStringList args = parser.positionalArguments();
+        if (args.size() != 2) {
+            err << QApplication::translate("main", "--convert needs an input and an output file.")
+                << Qt::endl;
+            return 2;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        if (!BatchConverter::convertFile(args[0], args[1], &error)) {
+            err << error << Qt::endl;
+            return 1;
+        }
+        const QString summary =
+            QString("%1 -> %2 (%3 ms)").arg(args[0], args[1]).arg(timer.elapsed());
+        QTextStream(stdout) << summary << Qt::endl;
+        return 0;
+    }
+
+    bool jobsOk = false;
+    const int jobs = parser.value(jobsOption).toInt(&jobsOk);
+    if (!jobsOk || jobs < 1) {
+        err << QApplication::translate("main", "--jobs must be a positive number.") << Qt::endl;
+        return 2;
+    }
+    BatchConverter converter;
+    return converter.runBatch(parser.value(batchOption), parser.value(formatOption),
+                              parser.value(outputOption), jobs);
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
+    const bool headless = isConverterInvocation(argc, argv);
+    if (headless && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
     QApplication app(argc, argv);
     app.setStyle(QStyleFactory::create("Fusion"));
     app.setOrganizationName("YMind");
@@ -30,6 +121,9 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (headless)
+        return runConverter(app);
+
     MainWindow window;
     window.show();
 
@@ -2,6 +2,7 @@
 #include "core/TemplateDescriptor.h"
 #include "scene/MindMapScene.h"
 #include "scene/NodeItem.h"
+#include "scene/RenderStats.h"
 #include "ui/ThemeManager.h"
 
 #include <QGraphicsSceneHoverEvent>
@@ -24,6 +25,7 @@ QRectF EdgeItem::boundingRect() const {
 
 void EdgeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*option*/,
                      QWidget* /*widget*/) {
+    RenderStats::Scope profile(RenderStats::EdgePaint);
     painter->setRenderHint(QPainter::Antialiasing);
 
     int lighten = ThemeManager::colors().edgeLightenFactor;
@@ -44,6 +46,9 @@ void EdgeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*option
 }
 
 void EdgeItem::updatePath() {
+    RenderStats::Scope profile(RenderStats::EdgeUpdate);
+    if (m_mindMapScene)
+        m_mindMapScene->markContentChanged(sceneBoundingRect());
     prepareGeometryChange();
 
     QPointF srcPos = m_source->pos();
@@ -91,6 +96,12 @@ void EdgeItem::updatePath() {
 
     m_startPoint = start;
     m_boundingRect = m_path.boundingRect().adjusted(-5, -5, 5, 5);
+    if (m_mindMapScene)
+        m_mindMapScene->markContentChanged(sceneBoundingRect());
+}
+
+QPainterPath EdgeItem::path() const {
+    return m_path;
 }
 
 NodeItem* EdgeItem::sourceNode() const {
@@ -131,8 +142,13 @@ void EdgeItem::hoverLeaveEvent(QGraphicsSceneHoverEvent* event) {
 }
 
 QVariant EdgeItem::itemChange(GraphicsItemChange change, const QVariant& value) {
-    if (change == ItemSceneHasChanged) {
+    if (change == ItemSceneChange) {
+        if (m_mindMapScene)
+            m_mindMapScene->markContentChanged(sceneBoundingRect());
+    } else if (change == ItemSceneHasChanged) {
         m_mindMapScene = dynamic_cast<MindMapScene*>(scene());
+        if (m_mindMapScene)
+            m_mindMapScene->markContentChanged(sceneBoundingRect());
     }
     return QGraphicsItem::itemChange(change, value);
 }
@@ -15,6 +15,7 @@ public:
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
 
     void updatePath();
+    QPainterPath path() const;
 
     NodeItem* sourceNode() const;
     NodeItem* targetNode() const;
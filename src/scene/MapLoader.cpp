@@ -0,0 +1,82 @@
+#include "scene/MapLoader.h"
+#include "scene/MindMapScene.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+
+// Entries created between checks of the slice clock
+constexpr int kBuildBatch = 128;
+
+} // namespace
+
+MapLoader::MapLoader(MindMapScene* scene, const QString& filePath, QObject* parent)
+    : QObject(parent),
+      m_scene(scene),
+      m_filePath(filePath),
+      m_cancelled(std::make_shared<std::atomic<bool>>(false)) {
+    m_sliceTimer = new QTimer(this);
+    m_sliceTimer->setSingleShot(true);
+    m_sliceTimer->setInterval(0);
+    connect(m_sliceTimer, &QTimer::timeout, this, &MapLoader::buildSlice);
+    connect(&m_watcher, &QFutureWatcher<MindMapSerializer::ParsedMap>::finished, this,
+            &MapLoader::onParsed);
+}
+
+MapLoader::~MapLoader() {
+    // The worker finishes on its own and its result is dropped
+    m_cancelled->store(true);
+    if (m_building && m_scene)
+        MindMapSerializer(m_scene).abortBuild(m_nodes);
+}
+
+void MapLoader::start() {
+    emit progress(0, -1);
+    m_watcher.setFuture(QtConcurrent::run([path = m_filePath, cancelled = m_cancelled]() {
+        return MindMapSerializer::parseFile(path, cancelled.get());
+    }));
+}
+
+QString MapLoader::filePath() const {
+    return m_filePath;
+}
+
+void MapLoader::onParsed() {
+    m_map = m_watcher.result();
+    if (!m_scene || !m_map.ok) {
+        emit finished(false);
+        return;
+    }
+    MindMapSerializer(m_scene).beginBuild(m_map);
+    m_building = true;
+    m_nodes.reserve(m_map.tree.size());
+    buildSlice();
+}
+
+void MapLoader::buildSlice() {
+    if (!m_scene)
+        return;
+
+    MindMapSerializer serializer(m_scene);
+    const int total = m_map.tree.size();
+    QElapsedTimer clock;
+    clock.start();
+    do {
+        serializer.buildNext(m_map, m_nodes, kBuildBatch);
+    } while (m_nodes.size() < total && clock.elapsed() < kSliceMs);
+    emit progress(int(m_nodes.size()), total);
+
+    if (m_nodes.size() < total) {
+        m_sliceTimer->start();
+        return;
+    }
+
+    serializer.finishBuild(m_map, m_nodes);
+    m_building = false;
+    m_nodes.clear();
+    m_map = {};
+    emit m_scene->fileLoaded(m_filePath);
+    emit finished(true);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "scene/MindMapSerializer.h"
+
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+#include <atomic>
+#include <memory>
+
+class MindMapScene;
+class NodeItem;
+class QTimer;
+
+// Opens a map file without blocking the GUI thread. The file is read and parsed
+// on a worker thread; the scene is then built from the parsed tree one time
+// slice per event-loop turn, so the window keeps painting while a large map
+// fills in. Deleting the loader cancels the load and leaves the scene empty if
+// building had started.
+class MapLoader : public QObject {
+    Q_OBJECT
+
+public:
+    // GUI-thread time spent creating items per event-loop turn
+    static constexpr int kSliceMs = 10;
+
+    MapLoader(MindMapScene* scene, const QString& filePath, QObject* parent = nullptr);
+    ~MapLoader() override;
+
+    void start();
+    QString filePath() const;
+
+signals:
+    // |total| is -1 while the file is still being read and parsed
+    void progress(int done, int total);
+    // On failure the scene is left as it was
+    void finished(bool ok);
+
+private:
+    void onParsed();
+    void buildSlice();
+
+    QPointer<MindMapScene> m_scene;
+    QString m_filePath;
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+    QFutureWatcher<MindMapSerializer::ParsedMap> m_watcher;
+    MindMapSerializer::ParsedMap m_map;
+    QList<NodeItem*> m_nodes;
+    bool m_building = false;
+    QTimer* m_sliceTimer;
+};
@@ -1,63 +1,172 @@
 #include "scene/MindMapExporter.h"
 #include "core/TemplateDescriptor.h"
+#include "scene/EdgeItem.h"
 #include "scene/MindMapScene.h"
 #include "scene/NodeItem.h"
+#include "scene/NodeTree.h"
+#include "scene/PngStreamWriter.h"
 #include "ui/ThemeManager.h"
 
+#include <QBuffer>
+#include <QFontDatabase>
+#include <QFontInfo>
 #include <QImage>
 #include <QPageSize>
 #include <QPainter>
+#include <QPdfWriter>
+#include <QPicture>
+#include <QSaveFile>
+#include <QStyleOptionGraphicsItem>
+#include <QTextLayout>
+#include <QTextStream>
+#include <QThread>
+#include <QXmlStreamWriter>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtMath>
 #include <QtPrintSupport/QPrinter>
-#include <QtSvg/QSvgGenerator>
 
-MindMapExporter::MindMapExporter(MindMapScene* scene) : m_scene(scene) {}
+#include <algorithm>
+
+namespace {
+
+QString svgNumber(qreal value) {
+    QString text = QString::number(value, 'f', 2);
+    while (text.endsWith('0'))
+        text.chop(1);
+    if (text.endsWith('.'))
+        text.chop(1);
+    return text == "-0" ? QStringLiteral("0") : text;
+}
 
-void MindMapExporter::exportNodeToText(NodeItem* node, int indent, QString& output) const {
-    output += QString(indent, '\t') + node->text() + '\n';
-    for (auto* child : node->childNodes()) {
-        exportNodeToText(child, indent + 1, output);
+QString svgPaint(const QColor& color) {
+    if (color.alpha() == 255)
+        return color.name(QColor::HexRgb);
+    return QString("rgba(%1,%2,%3,%4)")
+        .arg(color.red())
+        .arg(color.green())
+        .arg(color.blue())
+        .arg(svgNumber(color.alphaF()));
+}
+
+QString svgPathData(const QPainterPath& path) {
+    QString data;
+    for (int i = 0; i < path.elementCount(); ++i) {
+        const QPainterPath::Element e = path.elementAt(i);
+        switch (e.type) {
+        case QPainterPath::MoveToElement:
+            data += 'M';
+            break;
+        case QPainterPath::LineToElement:
+            data += 'L';
+            break;
+        case QPainterPath::CurveToElement:
+            data += 'C';
+            break;
+        case QPainterPath::CurveToDataElement:
+            data += ' ';
+            break;
+        }
+        data += svgNumber(e.x) + ' ' + svgNumber(e.y);
     }
+    return data;
+}
+
+} // namespace
+
+MindMapExporter::MindMapExporter(MindMapScene* scene) : m_scene(scene) {}
+
+QColor MindMapExporter::exportBackground() const {
+    const auto* td = m_scene->templateDescriptor();
+    return td ? td->activeColors().exportBackground : ThemeManager::colors().exportBackground;
 }
 
 QString MindMapExporter::exportToText() const {
-    QString output;
-    if (m_scene->m_rootNode)
-        exportNodeToText(m_scene->m_rootNode, 0, output);
-    return output;
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    exportToText(&buffer);
+    return QString::fromUtf8(buffer.data());
 }
 
-void MindMapExporter::exportNodeToMarkdown(NodeItem* node, int level, QString& output) const {
-    if (level == 0) {
-        output += "# " + node->text() + "\n\n";
-    } else if (level == 1) {
-        output += "## " + node->text() + "\n\n";
-    } else {
-        output += QString((level - 2) * 2, ' ') + "- " + node->text() + '\n';
-    }
-    for (auto* child : node->childNodes()) {
-        exportNodeToMarkdown(child, level + 1, output);
+bool MindMapExporter::exportToText(QIODevice* device) const {
+    m_scene->ensureAllLoaded();
+    QTextStream out(device);
+    if (!m_scene->m_rootNode)
+        return true;
+
+    // Pre-order walk with an explicit stack so deep maps cannot overflow it
+    QList<QPair<NodeItem*, int>> stack{{m_scene->m_rootNode, 0}};
+    while (!stack.isEmpty()) {
+        const auto [node, indent] = stack.takeLast();
+        for (int i = 0; i < indent; ++i)
+            out << '\t';
+        out << node->text() << '\n';
+
+        const auto children = node->childNodes();
+        for (int i = children.size() - 1; i >= 0; --i)
+            stack.append({children[i], indent + 1});
     }
-    if (level <= 1)
-        output += '\n';
+    out.flush();
+    return out.status() == QTextStream::Ok;
 }
 
 QString MindMapExporter::exportToMarkdown() const {
-    QString output;
-    if (m_scene->m_rootNode)
-        exportNodeToMarkdown(m_scene->m_rootNode, 0, output);
-    return output;
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    exportToMarkdown(&buffer);
+    return QString::fromUtf8(buffer.data());
+}
+
+bool MindMapExporter::exportToMarkdown(QIODevice* device) const {
+    m_scene->ensureAllLoaded();
+    QTextStream out(device);
+    if (!m_scene->m_rootNode)
+        return true;
+
+    // Headings get a blank line after their whole subtree, so they are pushed
+    // twice: once to write, once (|closing|) to end the section
+    struct Frame {
+        NodeItem* node;
+        int level;
+        bool closing;
+    };
+    QList<Frame> stack{{m_scene->m_rootNode, 0, false}};
+    while (!stack.isEmpty()) {
+        const Frame frame = stack.takeLast();
+        if (frame.closing) {
+            out << '\n';
+            continue;
+        }
+
+        if (frame.level == 0) {
+            out << "# " << frame.node->text() << "\n\n";
+        } else if (frame.level == 1) {
+            out << "## " << frame.node->text() << "\n\n";
+        } else {
+            for (int i = 0; i < (frame.level - 2) * 2; ++i)
+                out << ' ';
+            out << "- " << frame.node->text() << '\n';
+        }
+
+        if (frame.level <= 1)
+            stack.append({frame.node, frame.level, true});
+        const auto children = frame.node->childNodes();
+        for (int i = children.size() - 1; i >= 0; --i)
+            stack.append({children[i], frame.level + 1, false});
+    }
+    out.flush();
+    return out.status() == QTextStream::Ok;
 }
 
 bool MindMapExporter::exportToPng(const QString& filePath, int scaleFactor) {
+    m_scene->ensureAllLoaded();
     QRectF contentRect = m_scene->itemsBoundingRect().adjusted(-40, -40, 40, 40);
     QSize imageSize(static_cast<int>(contentRect.width() * scaleFactor),
                     static_cast<int>(contentRect.height() * scaleFactor));
+    if (qint64(imageSize.width()) * imageSize.height() > kSinglePassPixelLimit)
+        return exportToPngTiled(filePath, scaleFactor);
 
     QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
-    const auto* td = m_scene->templateDescriptor();
-    QColor bgColor =
-        td ? td->activeColors().exportBackground : ThemeManager::colors().exportBackground;
-    image.fill(bgColor);
+    image.fill(exportBackground());
 
     QPainter painter(&image);
     painter.setRenderHint(QPainter::Antialiasing);
@@ -67,26 +176,254 @@ bool MindMapExporter::exportToPng(const QString& filePath, int scaleFactor) {
     return image.save(filePath, "PNG");
 }
 
+bool MindMapExporter::exportToPngTiled(const QString& filePath, int scaleFactor,
+                                       qint64 tilePixels) {
+    m_scene->ensureAllLoaded();
+    const QRectF contentRect = m_scene->itemsBoundingRect().adjusted(-40, -40, 40, 40);
+    const qreal scale = scaleFactor;
+    const int width = static_cast<int>(contentRect.width() * scale);
+    const int height = static_cast<int>(contentRect.height() * scale);
+    if (width <= 0 || height <= 0)
+        return false;
+
+    // Tiles are full-width strips so each one hands the encoder whole rows
+    const int tileHeight = static_cast<int>(qBound<qint64>(1, tilePixels / width, height));
+    const QColor bgColor = exportBackground();
+    const bool hasAlpha = bgColor.alpha() < 255;
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    PngStreamWriter png(&file);
+    if (!png.begin(width, height, hasAlpha))
+        return false;
+
+    // Text can only be painted off the GUI thread where the platform allows it
+    const bool threaded = QFontDatabase::supportsThreadedFontRendering();
+    const int batchSize = threaded ? qMax(1, QThread::idealThreadCount()) : 1;
+
+    struct Tile {
+        QRect rect;
+        QPicture picture;
+    };
+    auto renderTile = [bgColor, hasAlpha](const Tile& tile) {
+        QImage image(tile.rect.size(), hasAlpha ? QImage::Format_ARGB32_Premultiplied
+                                                : QImage::Format_RGB32);
+        image.fill(bgColor);
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.drawPicture(0, 0, tile.picture);
+        painter.end();
+        return image.convertToFormat(hasAlpha ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
+    };
+
+    for (int top = 0; top < height; top += tileHeight * batchSize) {
+        // QGraphicsScene is not thread-safe, so tiles are recorded here and
+        // only the rasterization runs on the worker threads
+        QList<Tile> tiles;
+        for (int y = top; y < height && tiles.size() < batchSize; y += tileHeight) {
+            Tile tile;
+            tile.rect = QRect(0, y, width, qMin(tileHeight, height - y));
+            const QRectF source(contentRect.left(), contentRect.top() + tile.rect.top() / scale,
+                                width / scale, tile.rect.height() / scale);
+            QPainter recorder(&tile.picture);
+            recorder.setRenderHint(QPainter::Antialiasing);
+            m_scene->render(&recorder, QRectF(QPointF(0, 0), tile.rect.size()), source,
+                            Qt::IgnoreAspectRatio);
+            recorder.end();
+            tiles.append(tile);
+        }
+
+        const QList<QImage> strips =
+            batchSize > 1 ? QtConcurrent::blockingMapped<QList<QImage>>(tiles, renderTile)
+                          : QList<QImage>{renderTile(tiles.first())};
+        for (const QImage& strip : strips) {
+            if (!png.writeRows(strip))
+                return false;
+        }
+    }
+
+    return png.finish() && file.commit();
+}
+
 bool MindMapExporter::exportToSvg(const QString& filePath) {
-    QRectF contentRect = m_scene->itemsBoundingRect().adjusted(-40, -40, 40, 40);
+    m_scene->ensureAllLoaded();
+    const QRectF contentRect = m_scene->itemsBoundingRect().adjusted(-40, -40, 40, 40);
+    if (!m_scene->m_rootNode)
+        return false;
 
-    QSvgGenerator generator;
-    generator.setFileName(filePath);
-    generator.setSize(contentRect.size().toSize());
-    generator.setViewBox(QRectF(QPointF(0, 0), contentRect.size()));
-    generator.setTitle("YMind Export");
+    // Resolve colors: template-specific if available, else global
+    const ThemeColors& globalTC = ThemeManager::colors();
+    const QColor* palette = globalTC.nodePalette;
+    QColor shadowColor = globalTC.nodeShadow;
+    QColor textColor = globalTC.nodeText;
+    int lighten = globalTC.edgeLightenFactor;
+    qreal edgeWidth = 2.5;
+    if (const auto* td = m_scene->templateDescriptor()) {
+        const auto& tc = td->activeColors();
+        palette = tc.nodePalette;
+        shadowColor = tc.nodeShadow;
+        textColor = tc.nodeText;
+        lighten = tc.edgeLightenFactor;
+        edgeWidth = td->edgeStyle.width;
+    }
+    const QColor bgColor = exportBackground();
+    const QFont baseFont = m_scene->m_rootNode->font();
 
-    QPainter painter(&generator);
-    if (!painter.isActive())
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
         return false;
-    painter.setRenderHint(QPainter::Antialiasing);
-    m_scene->render(&painter, QRectF(), contentRect);
-    painter.end();
 
-    return true;
+    QXmlStreamWriter xml(&file);
+    xml.writeStartDocument();
+    xml.writeStartElement("svg");
+    xml.writeDefaultNamespace("http://www.w3.org/2000/svg");
+    xml.writeAttribute("width", svgNumber(contentRect.width()));
+    xml.writeAttribute("height", svgNumber(contentRect.height()));
+    xml.writeAttribute("viewBox", QString("0 0 %1 %2")
+                                      .arg(svgNumber(contentRect.width()),
+                                           svgNumber(contentRect.height())));
+    xml.writeTextElement("title", "YMind Export");
+
+    // Shared styles: one class per palette level for nodes and edges
+    xml.writeStartElement("defs");
+    QString css = QString(".bg{fill:%1}").arg(svgPaint(bgColor));
+    css += QString(".edge{fill:none;stroke-width:%1;stroke-linecap:round}")
+               .arg(svgNumber(edgeWidth));
+    css += ".node{filter:url(#shadow)}";
+    for (int i = 0; i < 6; ++i) {
+        css += QString(".l%1{fill:%2}").arg(i).arg(svgPaint(palette[i]));
+        css += QString(".e%1{stroke:%2}").arg(i).arg(svgPaint(palette[i].lighter(lighten)));
+    }
+    css += QString(".label{fill:%1;font-family:'%2';font-size:%3px;text-anchor:middle%4}")
+               .arg(svgPaint(textColor), baseFont.family())
+               .arg(QFontInfo(baseFont).pixelSize())
+               .arg(baseFont.bold() ? QStringLiteral(";font-weight:bold") : QString());
+    xml.writeTextElement("style", css);
+
+    xml.writeStartElement("filter");
+    xml.writeAttribute("id", "shadow");
+    xml.writeAttribute("x", "-20%");
+    xml.writeAttribute("y", "-20%");
+    xml.writeAttribute("width", "140%");
+    xml.writeAttribute("height", "160%");
+    xml.writeEmptyElement("feGaussianBlur");
+    xml.writeAttribute("in", "SourceAlpha");
+    xml.writeAttribute("stdDeviation", "5");
+    xml.writeEmptyElement("feOffset");
+    xml.writeAttribute("dy", "4");
+    xml.writeAttribute("result", "blur");
+    xml.writeEmptyElement("feFlood");
+    xml.writeAttribute("flood-color", shadowColor.name(QColor::HexRgb));
+    xml.writeAttribute("flood-opacity", svgNumber(shadowColor.alphaF()));
+    xml.writeEmptyElement("feComposite");
+    xml.writeAttribute("in2", "blur");
+    xml.writeAttribute("operator", "in");
+    xml.writeStartElement("feMerge");
+    xml.writeEmptyElement("feMergeNode");
+    xml.writeEmptyElement("feMergeNode");
+    xml.writeAttribute("in", "SourceGraphic");
+    xml.writeEndElement(); // feMerge
+    xml.writeEndElement(); // filter
+    xml.writeEndElement(); // defs
+
+    xml.writeEmptyElement("rect");
+    xml.writeAttribute("class", "bg");
+    xml.writeAttribute("width", "100%");
+    xml.writeAttribute("height", "100%");
+
+    xml.writeStartElement("g");
+    xml.writeAttribute("transform", QString("translate(%1 %2)")
+                                        .arg(svgNumber(-contentRect.left()),
+                                             svgNumber(-contentRect.top())));
+
+    // Edges first so nodes paint over their ends, matching the scene's z-order
+    for (auto* edge : m_scene->m_edges) {
+        xml.writeEmptyElement("path");
+        xml.writeAttribute("class",
+                           QString("edge e%1").arg(edge->targetNode()->level() % 6));
+        xml.writeAttribute("d", svgPathData(edge->path()));
+    }
+
+    // Nodes in pre-order, iteratively so deep maps cannot overflow the stack
+    QList<QPair<NodeItem*, int>> stack{{m_scene->m_rootNode, 0}};
+    while (!stack.isEmpty()) {
+        const auto [node, level] = stack.takeLast();
+        const QRectF rect = node->nodeRect().translated(node->pos());
+
+        xml.writeEmptyElement("rect");
+        xml.writeAttribute("class", QString("node l%1").arg(level % 6));
+        xml.writeAttribute("x", svgNumber(rect.x()));
+        xml.writeAttribute("y", svgNumber(rect.y()));
+        xml.writeAttribute("width", svgNumber(rect.width()));
+        xml.writeAttribute("height", svgNumber(rect.height()));
+        xml.writeAttribute("rx", svgNumber(NodeItem::kRadius));
+
+        writeSvgLabel(xml, node, rect.adjusted(NodeItem::kPadding, NodeItem::kPadding,
+                                               -NodeItem::kPadding, -NodeItem::kPadding),
+                      baseFont);
+
+        const auto children = node->childNodes();
+        for (int i = children.size() - 1; i >= 0; --i)
+            stack.append({children[i], level + 1});
+    }
+
+    xml.writeEndElement(); // g
+    xml.writeEndElement(); // svg
+    xml.writeEndDocument();
+
+    return !xml.hasError() && file.commit();
+}
+
+void MindMapExporter::writeSvgLabel(QXmlStreamWriter& xml, NodeItem* node, const QRectF& area,
+                                    const QFont& baseFont) const {
+    if (node->text().isEmpty())
+        return;
+
+    // Break lines exactly like NodeItem::paint (Qt::TextWrapAnywhere)
+    QTextLayout layout(node->text(), node->font());
+    QTextOption option(Qt::AlignHCenter);
+    option.setWrapMode(QTextOption::WrapAnywhere);
+    layout.setTextOption(option);
+    layout.beginLayout();
+    qreal height = 0;
+    while (true) {
+        QTextLine line = layout.createLine();
+        if (!line.isValid())
+            break;
+        line.setLineWidth(area.width());
+        line.setPosition(QPointF(0, height));
+        height += line.height();
+    }
+    layout.endLayout();
+
+    const qreal top = area.top() + (area.height() - height) / 2;
+    const QString x = svgNumber(area.center().x());
+
+    xml.writeStartElement("text");
+    xml.writeAttribute("class", "label");
+    if (node->font() != baseFont) {
+        xml.writeAttribute("style", QString("font-family:'%1';font-size:%2px")
+                                        .arg(node->font().family())
+                                        .arg(QFontInfo(node->font()).pixelSize()));
+    }
+    for (int i = 0; i < layout.lineCount(); ++i) {
+        const QTextLine line = layout.lineAt(i);
+        xml.writeStartElement("tspan");
+        xml.writeAttribute("x", x);
+        xml.writeAttribute("y", svgNumber(top + line.y() + line.ascent()));
+        xml.writeCharacters(node->text().mid(line.textStart(), line.textLength()).trimmed());
+        xml.writeEndElement();
+    }
+    xml.writeEndElement(); // text
 }
 
-bool MindMapExporter::exportToPdf(const QString& filePath) {
+bool MindMapExporter::exportToPdf(const QString& filePath, PdfPagination pagination,
+                                  const QPageSize& paperSize) {
+    if (pagination != PdfPagination::SinglePage)
+        return exportToPagedPdf(filePath, pagination, paperSize);
+
+    m_scene->ensureAllLoaded();
     QRectF contentRect = m_scene->itemsBoundingRect().adjusted(-40, -40, 40, 40);
 
     QPrinter printer(QPrinter::HighResolution);
@@ -105,50 +442,188 @@ bool MindMapExporter::exportToPdf(const QString& filePath) {
     return true;
 }
 
-bool MindMapExporter::importFromText(const QString& text) {
-    QStringList lines = text.split('\n', Qt::SkipEmptyParts);
-    if (lines.isEmpty())
+bool MindMapExporter::exportToPagedPdf(const QString& filePath, PdfPagination pagination,
+                                       const QPageSize& paperSize) {
+    m_scene->ensureAllLoaded();
+    NodeItem* root = m_scene->m_rootNode;
+    if (!root)
         return false;
+    const QRectF contentRect = m_scene->itemsBoundingRect().adjusted(-40, -40, 40, 40);
 
-    m_scene->clearScene();
-    m_scene->m_batchLoading = true;
+    QPdfWriter writer(filePath);
+    writer.setCreator("YMind");
+    writer.setTitle(root->text());
+    writer.setPageSize(paperSize);
+    writer.setPageMargins(QMarginsF(kPdfPageMargin, kPdfPageMargin, kPdfPageMargin,
+                                    kPdfPageMargin),
+                          QPageLayout::Millimeter);
+    const QRectF paintRect(QPointF(0, 0),
+                           writer.pageLayout().paintRectPixels(writer.resolution()).size());
+    // Scene units are screen pixels; print them at their 96 dpi size
+    const qreal scale = writer.resolution() / 96.0;
 
-    // Parse indented text into tree
-    // Stack tracks (indent_level, node) pairs
-    QList<QPair<int, NodeItem*>> stack;
+    struct Page {
+        QRectF source;
+        QSet<QGraphicsItem*> items; // empty: every item is shown
+        int row = -1;               // tile position, -1 when not tiled
+        int column = -1;
+        bool lastRow = true;
+        bool lastColumn = true;
+    };
+    QList<Page> pages;
 
-    for (const QString& line : lines) {
-        // Count leading tabs
-        int indent = 0;
-        while (indent < line.size() && line[indent] == '\t')
-            indent++;
+    // Planning is cheap next to painting, and painting scene items is tied to
+    // the GUI thread and the single PDF painter, so the export runs serially
+    if (pagination == PdfPagination::Tiled) {
+        QList<QRectF> boxes;
+        QList<NodeItem*> nodes{root};
+        for (qsizetype i = 0; i < nodes.size(); ++i) {
+            nodes.append(nodes[i]->childNodes());
+            boxes.append(nodes[i]->sceneBoundingRect());
+        }
+        const QSizeF tile = paintRect.size() / scale;
+        const qreal strideX = tile.width() - kPdfTileOverlap;
+        const qreal strideY = tile.height() - kPdfTileOverlap;
+        const int columns =
+            qMax(1, qCeil((contentRect.width() - kPdfTileOverlap) / strideX));
+        const int rows = qMax(1, qCeil((contentRect.height() - kPdfTileOverlap) / strideY));
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < columns; ++c) {
+                Page page;
+                page.source = QRectF(QPointF(contentRect.left() + c * strideX,
+                                             contentRect.top() + r * strideY),
+                                     tile);
+                // Sparse maps leave many tiles empty; skip them
+                const bool used = std::any_of(boxes.cbegin(), boxes.cend(),
+                                              [&page](const QRectF& box) {
+                                                  return box.intersects(page.source);
+                                              });
+                if (!used)
+                    continue;
+                page.row = r;
+                page.column = c;
+                page.lastRow = r == rows - 1;
+                page.lastColumn = c == columns - 1;
+                pages.append(page);
+            }
+        }
+    } else {
+        Page overview;
+        overview.source = contentRect;
+        pages.append(overview);
 
-        QString nodeText = line.mid(indent).trimmed();
-        if (nodeText.isEmpty())
-            continue;
+        // Each branch page shows the branch's nodes and the edges inside it
+        for (NodeItem* branch : root->childNodes()) {
+            Page page;
+            QList<NodeItem*> nodes{branch};
+            for (qsizetype i = 0; i < nodes.size(); ++i) {
+                NodeItem* node = nodes[i];
+                nodes.append(node->childNodes());
+                page.items.insert(node);
+                page.source |= node->sceneBoundingRect();
+                if (node != branch) {
+                    if (auto* edge = m_scene->findEdge(node->parentNode(), node))
+                        page.items.insert(edge);
+                }
+            }
+            page.source.adjust(-40, -40, 40, 40);
+            pages.append(page);
+        }
+    }
+
+    QPainter painter(&writer);
+    if (!painter.isActive())
+        return false;
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // Pages are painted in order through one writer, so fonts and other
+    // resources are embedded once and shared by every page
+    for (int i = 0; i < pages.size(); ++i) {
+        const Page& page = pages[i];
+        if (i > 0)
+            writer.newPage();
 
-        if (stack.isEmpty()) {
-            // First node becomes root
-            m_scene->m_rootNode = m_scene->createRootNode(nodeText);
-            stack.append({indent, m_scene->m_rootNode});
+        if (page.row >= 0) {
+            const QRectF target(paintRect.topLeft(), page.source.size() * scale);
+            m_scene->render(&painter, target, page.source);
+            drawPdfTileMarks(painter, page.row, page.column, page.lastRow, page.lastColumn,
+                             target, kPdfTileOverlap * scale);
+        } else if (!page.items.isEmpty()) {
+            renderItems(painter, paintRect, page.source, page.items);
         } else {
-            // Find the parent: walk back up the stack to find the most recent
-            // node with a smaller indent
-            while (stack.size() > 1 && stack.last().first >= indent)
-                stack.removeLast();
-
-            NodeItem* parent = stack.last().second;
-            NodeItem* node = m_scene->addNode(nodeText, parent);
-            stack.append({indent, node});
+            m_scene->render(&painter, paintRect, page.source);
         }
     }
+    painter.end();
+
+    return true;
+}
+
+void MindMapExporter::renderItems(QPainter& painter, const QRectF& target, const QRectF& source,
+                                  const QSet<QGraphicsItem*>& items) const {
+    if (source.isEmpty() || target.isEmpty())
+        return;
+
+    // Centered and scaled like QGraphicsScene::render with Qt::KeepAspectRatio
+    const qreal scale = qMin(target.width() / source.width(), target.height() / source.height());
+    painter.save();
+    painter.setClipRect(target);
+    painter.translate(target.center());
+    painter.scale(scale, scale);
+    painter.translate(-source.center());
+
+    QStyleOptionGraphicsItem option;
+    const auto candidates =
+        m_scene->items(source, Qt::IntersectsItemBoundingRect, Qt::AscendingOrder);
+    for (QGraphicsItem* item : candidates) {
+        if (!item->isVisible() || !items.contains(item->topLevelItem()))
+            continue;
+        painter.save();
+        painter.setTransform(item->sceneTransform(), true);
+        painter.setOpacity(item->effectiveOpacity());
+        option.state = item->isSelected() ? QStyle::State_Selected : QStyle::State_None;
+        option.exposedRect = item->boundingRect();
+        item->paint(&painter, &option, nullptr);
+        painter.restore();
+    }
+    painter.restore();
+}
 
-    if (!m_scene->m_rootNode) {
-        m_scene->m_rootNode = m_scene->createRootNode(MindMapScene::tr("Central Topic"));
+void MindMapExporter::drawPdfTileMarks(QPainter& painter, int row, int column, bool lastRow,
+                                       bool lastColumn, const QRectF& target,
+                                       qreal overlap) const {
+    painter.save();
+    QPen pen(QColor(0, 0, 0, 90), 0, Qt::DashLine);
+    painter.setPen(pen);
+
+    // Where the next page starts: trim here and align with the neighbour's edge
+    if (!lastColumn) {
+        const qreal x = target.right() - overlap;
+        painter.drawLine(QPointF(x, target.top()), QPointF(x, target.bottom()));
+    }
+    if (!lastRow) {
+        const qreal y = target.bottom() - overlap;
+        painter.drawLine(QPointF(target.left(), y), QPointF(target.right(), y));
     }
 
-    m_scene->m_batchLoading = false;
-    m_scene->autoLayout();
+    QFont font = painter.font();
+    font.setPointSizeF(7);
+    painter.setFont(font);
+    painter.drawText(target.adjusted(0, 0, -overlap / 4, -overlap / 4),
+                     Qt::AlignRight | Qt::AlignBottom,
+                     MindMapScene::tr("Row %1, column %2").arg(row + 1).arg(column + 1));
+    painter.restore();
+}
+
+bool MindMapExporter::importFromText(const QString& text) {
+    return importTree(NodeTree::fromIndentedText(text));
+}
+
+bool MindMapExporter::importTree(const NodeTree& tree) {
+    if (!m_scene->buildTree(tree))
+        return false;
+
+    m_scene->autoLayout(false);
     m_scene->setModified(false);
     return true;
 }
@@ -1,24 +1,68 @@
 #pragma once
 
+#include <QColor>
+#include <QPageSize>
+#include <QSet>
 #include <QString>
 
 class MindMapScene;
 class NodeItem;
+class QFont;
+class QGraphicsItem;
+class QIODevice;
+class QPainter;
+class QRectF;
+class QXmlStreamWriter;
+struct NodeTree;
 
 class MindMapExporter {
 public:
+    // Images above this many pixels are rendered in tiles and streamed to disk
+    static constexpr qint64 kSinglePassPixelLimit = 16 * 1024 * 1024;
+    // Pixel budget of one tile; peak memory is roughly this times the thread count
+    static constexpr qint64 kTilePixelBudget = 4 * 1024 * 1024;
+    // Paged PDF: margin around each sheet (mm) and overlap between tiles (scene units)
+    static constexpr qreal kPdfPageMargin = 10.0;
+    static constexpr qreal kPdfTileOverlap = 48.0;
+
+    // How exportToPdf splits the map across pages
+    enum class PdfPagination {
+        SinglePage, // one page sized to the content
+        Tiled,      // paper-size tiles at 100% with overlap marks
+        PerBranch   // overview page, then one page per first-level branch
+    };
+
     explicit MindMapExporter(MindMapScene* scene);
 
+    // Text and Markdown are written to |device| as UTF-8 in a single pass; the
+    // QString overloads go through an in-memory buffer
     QString exportToText() const;
+    bool exportToText(QIODevice* device) const;
     QString exportToMarkdown() const;
+    bool exportToMarkdown(QIODevice* device) const;
     bool exportToPng(const QString& filePath, int scaleFactor = 2);
+    bool exportToPngTiled(const QString& filePath, int scaleFactor = 2,
+                          qint64 tilePixels = kTilePixelBudget);
     bool exportToSvg(const QString& filePath);
-    bool exportToPdf(const QString& filePath);
+    bool exportToPdf(const QString& filePath, PdfPagination pagination = PdfPagination::SinglePage,
+                     const QPageSize& paperSize = QPageSize(QPageSize::A4));
+    // Imports replace the scene with the parsed outline and lay it out once,
+    // without animation
     bool importFromText(const QString& text);
+    bool importTree(const NodeTree& tree);
 
 private:
-    void exportNodeToText(NodeItem* node, int indent, QString& output) const;
-    void exportNodeToMarkdown(NodeItem* node, int level, QString& output) const;
+    QColor exportBackground() const;
+    bool exportToPagedPdf(const QString& filePath, PdfPagination pagination,
+                          const QPageSize& paperSize);
+    void drawPdfTileMarks(QPainter& painter, int row, int column, bool lastRow, bool lastColumn,
+                          const QRectF& target, qreal overlap) const;
+    // Paints |source| into |target| like QGraphicsScene::render, but only the
+    // top-level items in |items| and their children; the scene is left as it is
+    void renderItems(QPainter& painter, const QRectF& target, const QRectF& source,
+                     const QSet<QGraphicsItem*>& items) const;
+    void writeSvgLabel(QXmlStreamWriter& xml, NodeItem* node, const QRectF& area,
+                       const QFont& baseFont) const;
 
     MindMapScene* m_scene;
 };
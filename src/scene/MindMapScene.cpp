@@ -1,4 +1,5 @@
 #include "scene/MindMapScene.h"
+#include "core/AppSettings.h"
 #include "core/Commands.h"
 #include "core/TemplateDescriptor.h"
 #include "core/TemplateRegistry.h"
@@ -8,23 +9,65 @@
 #include "scene/MindMapSerializer.h"
 #include "scene/MindMapView.h"
 #include "scene/NodeItem.h"
+#include "scene/NodeTree.h"
 
+#include <QApplication>
 #include <QEasingCurve>
 #include <QGraphicsSceneMouseEvent>
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QKeyEvent>
+#include <QMetaMethod>
 #include <QParallelAnimationGroup>
 #include <QPropertyAnimation>
+#include <QSet>
+#include <QTimer>
 #include <QUndoStack>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
 MindMapScene::MindMapScene(QObject* parent) : QGraphicsScene(parent) {
     m_undoStack = new QUndoStack(this);
+    m_undoStack->setUndoLimit(AppSettings::instance().undoLimit());
     connect(m_undoStack, &QUndoStack::cleanChanged, this,
             [this](bool clean) { setModified(!clean); });
+    connect(&AppSettings::instance(), &AppSettings::undoLimitChanged, this, [this](int limit) {
+        if (m_undoStack->count() == 0)
+            m_undoStack->setUndoLimit(limit);
+    });
 
     m_editController = new InlineEditController(this, this);
 
+    m_sceneRectTimer = new QTimer(this);
+    m_sceneRectTimer->setSingleShot(true);
+    m_sceneRectTimer->setInterval(kSceneRectCheckMs);
+    connect(m_sceneRectTimer, &QTimer::timeout, this, &MindMapScene::fitSceneRect);
+
+    m_chunkLoadTimer = new QTimer(this);
+    m_chunkLoadTimer->setSingleShot(true);
+    m_chunkLoadTimer->setInterval(0);
+    connect(m_chunkLoadTimer, &QTimer::timeout, this, &MindMapScene::loadVisibleChunk);
+
+    m_layoutTimer = new QTimer(this);
+    m_layoutTimer->setSingleShot(true);
+    m_layoutTimer->setInterval(0);
+    connect(m_layoutTimer, &QTimer::timeout, this, [this]() { autoLayout(); });
+
     m_rootNode = createRootNode(tr("Central Topic"));
+    fitSceneRect();
+}
+
+MindMapScene::~MindMapScene() {
+    // Delete items while the node index is still alive; NodeItem unregisters
+    // itself on destruction. Models drop their rows first.
+    delete m_layoutAnimation;
+    emit treeAboutToBeReset();
+    m_rootNode = nullptr;
+    emit treeReset();
+    clear();
 }
 
 NodeItem* MindMapScene::rootNode() const {
@@ -47,20 +90,283 @@ void MindMapScene::unregisterEdge(EdgeItem* edge) {
     m_edges.removeOne(edge);
 }
 
-NodeItem* MindMapScene::addNode(const QString& text, NodeItem* parent) {
-    if (!parent)
-        return nullptr;
-
+NodeItem* MindMapScene::createChildNode(const QString& text, NodeItem* parent, int index) {
     auto* node = new NodeItem(text);
     addItem(node);
-    parent->addChild(node);
+    const int row = index < 0 || index > parent->childCount() ? parent->childCount() : index;
+    if (!m_batchLoading)
+        emit nodeAboutToBeInserted(parent, row);
+    parent->insertChild(row, node);
+    createEdge(parent, node);
+    if (!m_batchLoading)
+        emit nodeInserted(parent, row);
+
+    connect(node, &NodeItem::doubleClicked, this, &MindMapScene::startEditing);
+    return node;
+}
 
-    // Create edge
-    auto* edge = new EdgeItem(parent, node);
+EdgeItem* MindMapScene::createEdge(NodeItem* parent, NodeItem* child) {
+    auto* edge = new EdgeItem(parent, child);
     addItem(edge);
     parent->addEdge(edge);
-    node->addEdge(edge);
+    child->addEdge(edge);
     m_edges.append(edge);
+    return edge;
+}
+
+bool MindMapScene::buildTree(const NodeTree& tree) {
+    if (tree.isEmpty())
+        return false;
+
+    clearScene();
+    emit treeAboutToBeReset();
+    m_batchLoading = true;
+    m_rootNode = createTreeItems(tree, nullptr, -1).first();
+    m_batchLoading = false;
+    emit treeReset();
+    fitSceneRect();
+    return true;
+}
+
+QList<NodeItem*> MindMapScene::createTreeItems(const NodeTree& tree, NodeItem* parent,
+                                               int index) {
+    QList<NodeItem*> nodes;
+    nodes.reserve(tree.size());
+    appendTreeItems(tree, parent, index, nodes, tree.size());
+    return nodes;
+}
+
+void MindMapScene::appendTreeItems(const NodeTree& tree, NodeItem* parent, int index,
+                                   QList<NodeItem*>& nodes, int count) {
+    // Entries are in pre-order, so every parent exists before its children
+    const int end = std::min(tree.size(), int(nodes.size()) + count);
+    for (int i = int(nodes.size()); i < end; ++i) {
+        const NodeTree::Entry& entry = tree.entries.at(i);
+        NodeItem* node;
+        if (nodes.isEmpty()) {
+            node = parent ? createChildNode(entry.text, parent, index)
+                          : createRootNode(entry.text);
+        } else {
+            const int p = entry.parent >= 0 && entry.parent < nodes.size() ? entry.parent : 0;
+            node = createChildNode(entry.text, nodes[p]);
+        }
+        node->setId(entry.id);
+        node->setPos(entry.pos);
+        nodes.append(node);
+    }
+}
+
+NodeTree MindMapScene::captureTree(NodeItem* node) {
+    NodeTree tree;
+    if (!node)
+        return tree;
+    ensureLoaded(node);
+
+    QList<QPair<NodeItem*, int>> stack{{node, -1}};
+    while (!stack.isEmpty()) {
+        const auto [current, parentIndex] = stack.takeLast();
+        const int index = tree.append(current->text(), parentIndex);
+        tree.entries[index].id = current->id();
+        tree.entries[index].pos = current->pos();
+
+        const auto children = current->childNodes();
+        for (auto it = children.crbegin(); it != children.crend(); ++it)
+            stack.append({*it, index});
+    }
+    return tree;
+}
+
+NodeItem* MindMapScene::insertTree(const NodeTree& tree, NodeItem* parent, int index) {
+    if (tree.isEmpty() || !parent)
+        return nullptr;
+    return createTreeItems(tree, parent, index).first();
+}
+
+void MindMapScene::destroySubtree(NodeItem* node) {
+    if (!node || node == m_rootNode)
+        return;
+
+    QList<NodeItem*> nodes{node};
+    for (qsizetype i = 0; i < nodes.size(); ++i)
+        nodes.append(nodes[i]->childNodes());
+    if (m_editController->isEditing() && nodes.contains(m_editController->editingNode()))
+        cancelEditing();
+
+    QSet<EdgeItem*> edges;
+    for (auto* n : nodes) {
+        for (auto* edge : n->m_edges)
+            edges.insert(edge);
+    }
+    if (auto* parent = node->parentNode()) {
+        const int row = parent->indexOfChild(node);
+        emit nodeAboutToBeRemoved(parent, row);
+        parent->removeChild(node);
+        emit nodeRemoved(parent, row);
+        for (auto* edge : edges) {
+            if (edge->sourceNode() == parent)
+                parent->removeEdge(edge);
+        }
+    }
+
+    // One pass over the edge list instead of one lookup per removed edge
+    m_edges.removeIf([&edges](EdgeItem* edge) { return edges.contains(edge); });
+    for (auto* edge : edges) {
+        removeItem(edge);
+        delete edge;
+    }
+    for (auto it = nodes.crbegin(); it != nodes.crend(); ++it) {
+        m_pendingChunks.remove(*it);
+        removeItem(*it);
+        delete *it;
+    }
+    if (!m_sceneRectTimer->isActive())
+        m_sceneRectTimer->start();
+}
+
+void MindMapScene::applyTree(NodeTree& tree) {
+    if (tree.isEmpty() || !m_rootNode)
+        return;
+    ensureAllLoaded();
+
+    // Entries are in pre-order, so each one's parent is already in place when
+    // it is reached. Placing every kept child at the next row of its parent
+    // leaves the nodes the tree lacks after them, in branches of their own.
+    QList<NodeItem*> nodes;
+    nodes.reserve(tree.size());
+    QList<int> placed(tree.size(), 0);
+    QSet<NodeItem*> kept;
+    for (int i = 0; i < tree.size(); ++i) {
+        NodeTree::Entry& entry = tree.entries[i];
+        NodeItem* node = m_rootNode;
+        if (i > 0) {
+            const int p = entry.parent >= 0 && entry.parent < i ? entry.parent : 0;
+            NodeItem* parent = nodes[p];
+            const int row = placed[p]++;
+            node = entry.id ? nodeById(entry.id) : nullptr;
+            if (node && kept.contains(node)) {
+                // The same ID twice: the second copy becomes a new node
+                node = nullptr;
+                entry.id = 0;
+            }
+            if (!node) {
+                node = createChildNode(entry.text, parent, row);
+                node->setId(entry.id);
+                entry.id = node->id();
+            } else if (node->parentNode() != parent || parent->childAt(row) != node) {
+                reparentNode(node, parent, row);
+            }
+        }
+        if (node->text() != entry.text)
+            node->setText(entry.text);
+        if (node->pos() != entry.pos)
+            node->setPos(entry.pos);
+        nodes.append(node);
+        kept.insert(node);
+    }
+
+    for (int i = 0; i < tree.size(); ++i) {
+        NodeItem* node = nodes[i];
+        while (node->childCount() > placed[i])
+            destroySubtree(node->childAt(node->childCount() - 1));
+    }
+}
+
+bool MindMapScene::reparentNode(NodeItem* node, NodeItem* parent, int index) {
+    if (!node || !parent || node == m_rootNode)
+        return false;
+    for (auto* p = parent; p; p = p->parentNode()) {
+        if (p == node)
+            return false;
+    }
+    ensureLoaded(node);
+    ensureLoaded(parent);
+
+    // The row |node| ends up at, once it has left its old place
+    int row = parent->childCount() - (node->parentNode() == parent ? 1 : 0);
+    if (index >= 0 && index < row)
+        row = index;
+    emit nodeAboutToBeMoved(node, parent, row);
+
+    if (NodeItem* oldParent = node->parentNode()) {
+        const auto edges = node->m_edges;
+        for (auto* edge : edges) {
+            if (edge->sourceNode() != oldParent)
+                continue;
+            oldParent->removeEdge(edge);
+            node->removeEdge(edge);
+            m_edges.removeOne(edge);
+            removeItem(edge);
+            delete edge;
+        }
+        oldParent->removeChild(node);
+    }
+    parent->insertChild(row, node);
+    createEdge(parent, node);
+    m_treeOrderDirty = true;
+    emit nodeMoved(node);
+
+    // Node colors follow the depth, and items cache their rendering
+    QList<NodeItem*> nodes{node};
+    for (qsizetype i = 0; i < nodes.size(); ++i) {
+        nodes.append(nodes[i]->childNodes());
+        nodes[i]->update();
+        markContentChanged(nodes[i]->sceneBoundingRect());
+    }
+    return true;
+}
+
+void MindMapScene::reparentNodes(const QList<NodeItem*>& nodes, NodeItem* parent) {
+    if (!parent)
+        return;
+
+    // Skip the root, nodes already under |parent| and nodes that contain it
+    QList<NodeItem*> moving;
+    for (auto* node : subtreeRoots(QSet<NodeItem*>(nodes.cbegin(), nodes.cend()))) {
+        if (node == m_rootNode || node->parentNode() == parent)
+            continue;
+        bool containsParent = false;
+        for (auto* p = parent; p && !containsParent; p = p->parentNode())
+            containsParent = p == node;
+        if (!containsParent)
+            moving.append(node);
+    }
+    if (moving.isEmpty())
+        return;
+    if (m_editController->isEditing())
+        finishEditing();
+
+    if (moving.size() == 1) {
+        m_undoStack->push(new ReparentNodeCommand(this, moving.first(), parent));
+        return;
+    }
+    // Every command schedules a layout; they coalesce into one pass
+    m_undoStack->beginMacro(tr("Reparent %1 Nodes").arg(moving.size()));
+    for (auto* node : moving)
+        m_undoStack->push(new ReparentNodeCommand(this, node, parent));
+    m_undoStack->endMacro();
+}
+
+int MindMapScene::syncToTree(const NodeTree& tree) {
+    if (tree.isEmpty() || !m_rootNode)
+        return 0;
+    if (m_editController->isEditing())
+        finishEditing();
+
+    auto* command = new SyncTreeCommand(this, tree);
+    const int changes = command->changeCount();
+    if (changes == 0) {
+        delete command;
+        return 0;
+    }
+    m_undoStack->push(command);
+    return changes;
+}
+
+NodeItem* MindMapScene::addNode(const QString& text, NodeItem* parent) {
+    if (!parent)
+        return nullptr;
+
+    auto* node = createChildNode(text, parent);
 
     // Position avoiding overlap with existing nodes
     const auto* td = templateDescriptor();
@@ -72,8 +378,6 @@ NodeItem* MindMapScene::addNode(const QString& text, NodeItem* parent) {
         node->setPos(LayoutEngine::initialChildPosition(node, parent, m_rootNode, m_layoutStyle));
     }
 
-    connect(node, &NodeItem::doubleClicked, this, &MindMapScene::startEditing);
-
     // Select the new node
     clearSelection();
     node->setSelected(true);
@@ -86,43 +390,127 @@ void MindMapScene::removeNode(NodeItem* node) {
     if (!node || node == m_rootNode)
         return;
 
-    // Recursively remove children first
-    auto children = node->childNodes();
-    for (auto* child : children) {
-        removeNode(child);
+    destroySubtree(node);
+    markModified();
+}
+
+NodeItem* MindMapScene::selectedNode() const {
+    auto sel = selectedItems();
+    for (auto* item : sel) {
+        auto* node = dynamic_cast<NodeItem*>(item);
+        if (node)
+            return node;
     }
+    return nullptr;
+}
 
-    // Remove edges connected to this node
-    QList<EdgeItem*> edgesToRemove;
-    for (auto* edge : m_edges) {
-        if (edge->sourceNode() == node || edge->targetNode() == node) {
-            edgesToRemove.append(edge);
+QList<NodeItem*> MindMapScene::selectedNodes() const {
+    QList<NodeItem*> nodes;
+    for (auto* item : selectedItems()) {
+        if (auto* node = dynamic_cast<NodeItem*>(item))
+            nodes.append(node);
+    }
+    return nodes;
+}
+
+QList<NodeItem*> MindMapScene::selectedSubtreeRoots() const {
+    const auto nodes = selectedNodes();
+    return subtreeRoots(QSet<NodeItem*>(nodes.cbegin(), nodes.cend()));
+}
+
+QList<NodeItem*> MindMapScene::subtreeRoots(const QSet<NodeItem*>& nodes) const {
+    // Pre-order walk that stops at the first member of |nodes| on each path
+    QList<NodeItem*> roots;
+    if (nodes.isEmpty() || !m_rootNode)
+        return roots;
+    QList<NodeItem*> stack{m_rootNode};
+    while (!stack.isEmpty() && roots.size() < nodes.size()) {
+        NodeItem* node = stack.takeLast();
+        if (nodes.contains(node)) {
+            roots.append(node);
+            continue;
         }
+        const auto& children = node->m_children;
+        for (auto it = children.crbegin(); it != children.crend(); ++it)
+            stack.append(*it);
     }
-    for (auto* edge : edgesToRemove) {
-        edge->sourceNode()->removeEdge(edge);
-        edge->targetNode()->removeEdge(edge);
-        m_edges.removeOne(edge);
-        removeItem(edge);
-        delete edge;
+    return roots;
+}
+
+// --- Group drag ---
+
+void MindMapScene::beginNodeDrag(NodeItem* grabbed, const QPoint& pressScreenPos) {
+    auto nodes = selectedNodes();
+    if (!nodes.contains(grabbed))
+        nodes.append(grabbed);
+
+    m_dragPressScreenPos = pressScreenPos;
+    m_dragOrigins.clear();
+    for (auto* node : subtreeRoots(QSet<NodeItem*>(nodes.cbegin(), nodes.cend())))
+        m_dragOrigins.append({node->id(), node->pos()});
+}
+
+void MindMapScene::dragNodes(const QPointF& delta) {
+    for (const auto& origin : std::as_const(m_dragOrigins)) {
+        if (NodeItem* node = nodeById(origin.first))
+            node->moveSubtree(delta);
     }
+}
 
-    // Remove from parent
-    if (node->parentNode()) {
-        node->parentNode()->removeChild(node);
+void MindMapScene::endNodeDrag(const QPointF& scenePos, const QPoint& screenPos) {
+    const auto origins = std::exchange(m_dragOrigins, {});
+    QList<NodeItem*> roots;
+    QList<QPointF> startPositions;
+    for (const auto& origin : origins) {
+        if (NodeItem* node = nodeById(origin.first)) {
+            roots.append(node);
+            startPositions.append(origin.second);
+        }
     }
 
-    removeItem(node);
-    delete node;
+    // Dropping onto another node reparents the dragged subtrees under it; a
+    // click on a node that overlaps another is not a drop
+    const bool dragged =
+        (screenPos - m_dragPressScreenPos).manhattanLength() >= QApplication::startDragDistance();
+    NodeItem* target = dragged ? dropTargetAt(scenePos, roots) : nullptr;
+    if (target) {
+        const bool reparents = std::any_of(roots.cbegin(), roots.cend(), [target](NodeItem* n) {
+            return n->parentNode() != target;
+        });
+        if (reparents) {
+            reparentNodes(roots, target);
+            return;
+        }
+    }
 
-    markModified();
+    QList<int> moved;
+    for (int i = 0; i < roots.size(); ++i) {
+        if (roots[i]->pos() != startPositions[i])
+            moved.append(i);
+    }
+    if (moved.size() == 1) {
+        const int i = moved.first();
+        m_undoStack->push(new MoveNodeCommand(roots[i], startPositions[i], roots[i]->pos()));
+    } else if (moved.size() > 1) {
+        m_undoStack->beginMacro(tr("Move %1 Nodes").arg(moved.size()));
+        for (int i : moved)
+            m_undoStack->push(new MoveNodeCommand(roots[i], startPositions[i], roots[i]->pos()));
+        m_undoStack->endMacro();
+    }
 }
 
-NodeItem* MindMapScene::selectedNode() const {
-    auto sel = selectedItems();
-    for (auto* item : sel) {
+NodeItem* MindMapScene::dropTargetAt(const QPointF& scenePos,
+                                     const QList<NodeItem*>& dragged) const {
+    const QSet<NodeItem*> draggedSet(dragged.cbegin(), dragged.cend());
+    for (auto* item : items(scenePos)) {
         auto* node = dynamic_cast<NodeItem*>(item);
-        if (node)
+        if (!node)
+            continue;
+        // Nodes inside a dragged subtree are moving with the cursor
+        bool inside = false;
+        for (auto* p = node; p && !inside; p = p->parentNode())
+            inside = draggedSet.contains(p);
+        if (!inside)
             return node;
     }
     return nullptr;
@@ -132,6 +520,18 @@ QUndoStack* MindMapScene::undoStack() const {
     return m_undoStack;
 }
 
+qsizetype MindMapScene::undoRetainedBytes() const {
+    qsizetype bytes = 0;
+    for (int i = 0; i < m_undoStack->count(); ++i)
+        bytes += retainedBytes(m_undoStack->command(i));
+    return bytes;
+}
+
+void MindMapScene::resetUndoStack() {
+    m_undoStack->clear();
+    m_undoStack->setUndoLimit(AppSettings::instance().undoLimit());
+}
+
 bool MindMapScene::isEditing() const {
     return m_editController->isEditing();
 }
@@ -178,6 +578,40 @@ EdgeItem* MindMapScene::findEdge(NodeItem* parent, NodeItem* child) const {
     return nullptr;
 }
 
+NodeItem* MindMapScene::nodeById(quint64 id) const {
+    return m_nodeIndex.value(id, nullptr);
+}
+
+int MindMapScene::nodeCount() const {
+    int count = int(m_nodeIndex.size());
+    for (const auto& chunk : m_pendingChunks)
+        count += chunk.nodeCount;
+    return count;
+}
+
+void MindMapScene::registerNode(NodeItem* node) {
+    // A duplicate ID (e.g. a branch copied within a hand-edited file) gets re-keyed
+    auto existing = m_nodeIndex.constFind(node->id());
+    while (existing != m_nodeIndex.cend() && existing.value() != node) {
+        node->m_id = NodeItem::generateId();
+        existing = m_nodeIndex.constFind(node->id());
+    }
+    m_nodeIndex.insert(node->id(), node);
+    m_treeOrderDirty = true;
+    if (m_searchIndexBuilt)
+        m_searchIndex.addNode(node->id(), node->text());
+}
+
+void MindMapScene::unregisterNode(NodeItem* node) {
+    auto it = m_nodeIndex.find(node->id());
+    if (it != m_nodeIndex.end() && it.value() == node) {
+        m_nodeIndex.erase(it);
+        m_treeOrderDirty = true;
+        if (m_searchIndexBuilt)
+            m_searchIndex.removeNode(node->id());
+    }
+}
+
 void MindMapScene::addChildToSelected() {
     if (m_editController->isEditing())
         finishEditing();
@@ -185,6 +619,9 @@ void MindMapScene::addChildToSelected() {
     if (!node)
         node = m_rootNode;
 
+    // New children go after the stored ones, so the branch must be complete first
+    ensureLoaded(node);
+
     auto* cmd = new AddNodeCommand(this, node, tr("New Topic"));
     m_undoStack->push(cmd);
 
@@ -219,9 +656,17 @@ void MindMapScene::addSiblingToSelected() {
 void MindMapScene::deleteSelected() {
     if (m_editController->isEditing())
         cancelEditing();
-    NodeItem* node = selectedNode();
-    if (node && node != m_rootNode) {
-        m_undoStack->push(new RemoveNodeCommand(this, node));
+    auto nodes = selectedNodes();
+    nodes.removeOne(m_rootNode);
+    const auto roots = subtreeRoots(QSet<NodeItem*>(nodes.cbegin(), nodes.cend()));
+    if (roots.size() == 1) {
+        m_undoStack->push(new RemoveNodeCommand(this, roots.first()));
+    } else if (roots.size() > 1) {
+        // Later subtrees go first, so undo reinserts each at its recorded index
+        m_undoStack->beginMacro(tr("Delete %1 Nodes").arg(roots.size()));
+        for (auto it = roots.crbegin(); it != roots.crend(); ++it)
+            m_undoStack->push(new RemoveNodeCommand(this, *it));
+        m_undoStack->endMacro();
     }
 }
 
@@ -295,6 +740,8 @@ void MindMapScene::markModified() {
 // --- Serialization (delegates to MindMapSerializer) ---
 
 QJsonObject MindMapScene::toJson() const {
+    if (isHibernated())
+        return QJsonDocument::fromJson(qUncompress(m_hibernatedState)).object();
     return MindMapSerializer(const_cast<MindMapScene*>(this)).toJson();
 }
 
@@ -310,11 +757,107 @@ bool MindMapScene::loadFromFile(const QString& filePath) {
     return MindMapSerializer(this).loadFromFile(filePath);
 }
 
+bool MindMapScene::isLoading() const {
+    return m_batchLoading;
+}
+
+// --- Hibernation ---
+
+bool MindMapScene::hibernate() {
+    if (isHibernated() || !m_rootNode)
+        return false;
+    if (m_editController->isEditing())
+        finishEditing();
+    // Scheduled or running layouts would be lost with the items
+    if (m_layoutTimer->isActive())
+        autoLayout(false);
+    if (m_layoutAnimation)
+        m_layoutAnimation->setCurrentTime(m_layoutAnimation->totalDuration());
+
+    const QByteArray json = QJsonDocument(toJson()).toJson(QJsonDocument::Compact);
+    emit treeAboutToBeReset();
+    clearItems();
+    m_hibernatedState = qCompress(json);
+    emit treeReset();
+    return true;
+}
+
+bool MindMapScene::wake() {
+    if (!isHibernated())
+        return true;
+    // The stored copy is dropped only once the items are rebuilt from it
+    const QByteArray stored = m_hibernatedState;
+    if (!MindMapSerializer(this).fromJson(toJson(), MindMapSerializer::History::Keep)) {
+        m_hibernatedState = stored;
+        return false;
+    }
+    m_hibernatedState.clear();
+    return true;
+}
+
+bool MindMapScene::isHibernated() const {
+    return !m_hibernatedState.isEmpty();
+}
+
+qsizetype MindMapScene::itemRetainedBytes() const {
+    // Beyond sizeof: the QGraphicsItem private data and the BSP index entry
+    constexpr qsizetype kItemOverhead = 512;
+    qsizetype bytes = 0;
+    for (const NodeItem* node : m_nodeIndex) {
+        bytes += sizeof(NodeItem) + kItemOverhead;
+        bytes += node->text().capacity() * qsizetype(sizeof(QChar));
+        // DeviceCoordinateCache keeps a 32-bit pixmap of the node, about 1:1
+        const QRectF rect = node->boundingRect();
+        bytes += qsizetype(rect.width() * rect.height()) * 4;
+    }
+    for (const EdgeItem* edge : m_edges) {
+        bytes += sizeof(EdgeItem) + kItemOverhead;
+        bytes += edge->path().elementCount() * qsizetype(sizeof(QPainterPath::Element));
+    }
+    // Unread branches are held as the JSON text they were stored as
+    bytes += m_pendingChunks.size() * qsizetype(sizeof(PendingChunk));
+    for (const auto& chunk : m_chunkTable)
+        bytes += chunk.children.size();
+    return bytes;
+}
+
+qsizetype MindMapScene::hibernatedBytes() const {
+    return m_hibernatedState.size();
+}
+
+// --- Scene management ---
+
 void MindMapScene::clearScene() {
     if (m_editController->isEditing())
         cancelEditing();
 
-    m_undoStack->clear();
+    emit treeAboutToBeReset();
+    resetUndoStack();
+    clearItems();
+    emit treeReset();
+    setModified(false);
+}
+
+void MindMapScene::clearItems() {
+    if (m_editController->isEditing())
+        cancelEditing();
+    m_hibernatedState.clear();
+
+    m_chunkLoadTimer->stop();
+    m_layoutTimer->stop();
+    delete m_layoutAnimation;
+    m_pendingChunks.clear();
+    m_chunkTable.clear();
+    m_contentBounds = QRectF();
+
+    // The index is rebuilt on the next query rather than emptied node by node
+    m_searchIndex.clear();
+    m_searchIndexBuilt = false;
+    m_storedNodeOwners.clear();
+    if (!m_searchMatches.isEmpty()) {
+        m_searchMatches.clear();
+        emit searchMatchesChanged();
+    }
 
     // Remove all edges
     for (auto* edge : m_edges) {
@@ -340,7 +883,247 @@ void MindMapScene::clearScene() {
         m_rootNode = nullptr;
     }
 
-    setModified(false);
+    m_sceneRectTimer->start();
+}
+
+// --- Scene rect and index ---
+
+void MindMapScene::nodeGeometryChanged(NodeItem* node) {
+    // Batch loads fit the rect once at the end
+    if (m_batchLoading)
+        return;
+    const QRectF bounds = node->sceneBoundingRect();
+    markContentChanged(bounds);
+    const QRectF rect = sceneRect();
+    if (!rect.contains(bounds)) {
+        setSceneRect(rect.united(
+            bounds.adjusted(-kSceneMargin, -kSceneMargin, kSceneMargin, kSceneMargin)));
+    }
+    if (!m_sceneRectTimer->isActive())
+        m_sceneRectTimer->start();
+}
+
+void MindMapScene::markContentChanged(const QRectF& sceneRect) {
+    if (!sceneRect.isEmpty())
+        m_contentBounds |= sceneRect;
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&MindMapScene::contentChanged);
+    if (!m_batchLoading && !sceneRect.isEmpty() && isSignalConnected(signal))
+        emit contentChanged(sceneRect);
+}
+
+void MindMapScene::fitSceneRect() {
+    m_sceneRectTimer->stop();
+
+    // Unread branches count through their placeholders, so scrolling reaches them
+    const QRectF content = itemsBoundingRect();
+    m_contentBounds = content;
+    const QRectF wanted =
+        content.adjusted(-kSceneMargin, -kSceneMargin, kSceneMargin, kSceneMargin);
+
+    // Grow whenever content is outside; shrink only when far too large, since
+    // every change rebuilds the BSP index
+    const QRectF current = sceneRect();
+    const qreal currentArea = current.width() * current.height();
+    const qreal wantedArea = wanted.width() * wanted.height();
+    if (!current.contains(content) || currentArea > kShrinkAreaRatio * wantedArea)
+        setSceneRect(wanted);
+
+    const int depth = bspDepthForItemCount(m_nodeIndex.size() + m_edges.size());
+    if (depth != bspTreeDepth())
+        setBspTreeDepth(depth);
+}
+
+QRectF MindMapScene::contentBounds() const {
+    return m_contentBounds;
+}
+
+int MindMapScene::bspDepthForItemCount(int itemCount) {
+    const qreal leaves = qMax(1.0, qreal(itemCount) / kItemsPerBspLeaf);
+    return qBound(kMinBspDepth, qCeil(std::log2(leaves)), kMaxBspDepth);
+}
+
+// --- Search ---
+
+QList<NodeItem*> MindMapScene::findNodes(const QString& query) {
+    if (!m_searchIndexBuilt) {
+        for (auto* node : std::as_const(m_nodeIndex))
+            m_searchIndex.addNode(node->id(), node->text());
+        // Pending chunks are read for their text without building any items
+        const MindMapSerializer serializer(this);
+        for (auto it = m_pendingChunks.cbegin(); it != m_pendingChunks.cend(); ++it) {
+            for (const auto& stored : serializer.storedNodes(it->index, it.key()->id())) {
+                m_searchIndex.addNode(stored.id, stored.text);
+                m_storedNodeOwners.insert(stored.id, stored.owner);
+            }
+        }
+        m_searchIndexBuilt = true;
+    }
+
+    QList<NodeItem*> nodes;
+    const QList<quint64> ids = m_searchIndex.find(query);
+    nodes.reserve(ids.size());
+    for (quint64 id : ids) {
+        NodeItem* node = nodeById(id);
+        if (!node && !m_storedNodeOwners.isEmpty())
+            node = loadStoredNode(id);
+        if (node)
+            nodes.append(node);
+    }
+    sortByTreeOrder(nodes);
+    return nodes;
+}
+
+void MindMapScene::sortByTreeOrder(QList<NodeItem*>& nodes) {
+    if (m_treeOrderDirty) {
+        m_treeOrder.clear();
+        m_treeOrder.reserve(m_nodeIndex.size());
+        QList<NodeItem*> stack;
+        if (m_rootNode)
+            stack.append(m_rootNode);
+        while (!stack.isEmpty()) {
+            NodeItem* node = stack.takeLast();
+            m_treeOrder.insert(node, int(m_treeOrder.size()));
+            for (auto it = node->m_children.crbegin(); it != node->m_children.crend(); ++it)
+                stack.append(*it);
+        }
+        m_treeOrderDirty = false;
+    }
+    std::sort(nodes.begin(), nodes.end(), [this](const NodeItem* a, const NodeItem* b) {
+        return m_treeOrder.value(a) < m_treeOrder.value(b);
+    });
+}
+
+void MindMapScene::setSearchMatches(const QList<NodeItem*>& nodes) {
+    QSet<quint64> matches;
+    matches.reserve(nodes.size());
+    for (auto* node : nodes)
+        matches.insert(node->id());
+    if (matches == m_searchMatches)
+        return;
+
+    // Only nodes that gained or lost the highlight are repainted
+    for (quint64 id : std::as_const(m_searchMatches)) {
+        if (!matches.contains(id)) {
+            if (auto* node = nodeById(id)) {
+                node->update();
+                markContentChanged(node->sceneBoundingRect());
+            }
+        }
+    }
+    for (quint64 id : std::as_const(matches)) {
+        if (!m_searchMatches.contains(id)) {
+            if (auto* node = nodeById(id)) {
+                node->update();
+                markContentChanged(node->sceneBoundingRect());
+            }
+        }
+    }
+    m_searchMatches = std::move(matches);
+    emit searchMatchesChanged();
+}
+
+bool MindMapScene::isSearchMatch(const NodeItem* node) const {
+    return !m_searchMatches.isEmpty() && m_searchMatches.contains(node->id());
+}
+
+QSet<quint64> MindMapScene::searchMatches() const {
+    return m_searchMatches;
+}
+
+void MindMapScene::nodeTextChanged(NodeItem* node) {
+    if (m_nodeIndex.value(node->id()) != node)
+        return;
+    if (m_searchIndexBuilt)
+        m_searchIndex.addNode(node->id(), node->text());
+    if (!m_batchLoading)
+        emit nodeRenamed(node);
+}
+
+// --- Chunked loading ---
+
+bool MindMapScene::hasPendingChunks() const {
+    return !m_pendingChunks.isEmpty();
+}
+
+bool MindMapScene::isChunkPending(NodeItem* node) const {
+    return m_pendingChunks.contains(node);
+}
+
+void MindMapScene::loadChunk(NodeItem* node) {
+    auto it = m_pendingChunks.find(node);
+    if (it == m_pendingChunks.end())
+        return;
+    PendingChunk chunk = it.value();
+    m_pendingChunks.erase(it);
+
+    MindMapSerializer(this).loadChunk(node, chunk.index, node->pos() - chunk.anchor);
+    node->setToolTip(QString());
+    node->clearStoredChildren();
+
+    if (m_pendingChunks.isEmpty())
+        m_chunkTable.clear();
+}
+
+NodeItem* MindMapScene::loadStoredNode(quint64 id) {
+    // Owners from the node outwards, up to one that is built
+    QList<quint64> chain{id};
+    while (!nodeById(chain.last())) {
+        const quint64 owner = m_storedNodeOwners.value(chain.last());
+        if (owner == 0 || chain.size() > m_storedNodeOwners.size())
+            return nullptr;
+        chain.append(owner);
+    }
+    // Then each chunk on the way back in
+    for (qsizetype i = chain.size() - 1; i > 0; --i) {
+        NodeItem* owner = nodeById(chain[i]);
+        if (!owner || !m_pendingChunks.contains(owner))
+            return nullptr;
+        loadChunk(owner);
+    }
+    return nodeById(id);
+}
+
+void MindMapScene::ensureChildrenLoaded(NodeItem* node) {
+    if (node && !m_pendingChunks.isEmpty())
+        loadChunk(node);
+}
+
+void MindMapScene::ensureLoaded(NodeItem* node) {
+    if (!node || m_pendingChunks.isEmpty())
+        return;
+
+    // Loading a chunk can expose nested chunks, so walk the subtree as it grows
+    QList<NodeItem*> stack{node};
+    while (!stack.isEmpty() && !m_pendingChunks.isEmpty()) {
+        NodeItem* current = stack.takeLast();
+        loadChunk(current);
+        stack.append(current->childNodes());
+    }
+}
+
+void MindMapScene::ensureAllLoaded() {
+    while (!m_pendingChunks.isEmpty())
+        loadChunk(m_pendingChunks.begin().key());
+}
+
+void MindMapScene::requestChunksInRect(const QRectF& rect) {
+    if (m_pendingChunks.isEmpty())
+        return;
+    m_chunkLoadRect = rect;
+    m_chunkLoadTimer->start();
+}
+
+void MindMapScene::loadVisibleChunk() {
+    // One chunk per event-loop turn keeps the UI responsive while a large map
+    // fills in around the viewport
+    for (auto it = m_pendingChunks.cbegin(); it != m_pendingChunks.cend(); ++it) {
+        QRectF bounds = it->bounds.translated(it.key()->pos());
+        if (bounds.intersects(m_chunkLoadRect)) {
+            loadChunk(it.key());
+            m_chunkLoadTimer->start();
+            return;
+        }
+    }
 }
 
 // --- Export/Import (delegates to MindMapExporter) ---
@@ -349,10 +1132,18 @@ QString MindMapScene::exportToText() const {
     return MindMapExporter(const_cast<MindMapScene*>(this)).exportToText();
 }
 
+bool MindMapScene::exportToText(QIODevice* device) const {
+    return MindMapExporter(const_cast<MindMapScene*>(this)).exportToText(device);
+}
+
 QString MindMapScene::exportToMarkdown() const {
     return MindMapExporter(const_cast<MindMapScene*>(this)).exportToMarkdown();
 }
 
+bool MindMapScene::exportToMarkdown(QIODevice* device) const {
+    return MindMapExporter(const_cast<MindMapScene*>(this)).exportToMarkdown(device);
+}
+
 bool MindMapScene::exportToPng(const QString& filePath, int scaleFactor) {
     return MindMapExporter(this).exportToPng(filePath, scaleFactor);
 }
@@ -369,21 +1160,66 @@ bool MindMapScene::importFromText(const QString& text) {
     return MindMapExporter(this).importFromText(text);
 }
 
+bool MindMapScene::importTree(const NodeTree& tree) {
+    return MindMapExporter(this).importTree(tree);
+}
+
 // --- Auto-layout ---
 
-void MindMapScene::autoLayout() {
+void MindMapScene::autoLayout(bool animated) {
+    // Running now satisfies any scheduled layout
+    m_layoutTimer->stop();
     if (!m_rootNode)
         return;
     if (m_editController->isEditing())
         finishEditing();
 
-    QMap<NodeItem*, QPointF> positions;
-    const auto* td = templateDescriptor();
-    if (td) {
-        LayoutParams params{td->layout.depthSpacing, td->layout.spreadSpacing};
-        positions = LayoutEngine::computeLayout(m_rootNode, td->layout.algorithm, params);
-    } else {
-        positions = LayoutEngine::computeLayout(m_rootNode, m_layoutStyle);
+    const auto computeLayout = [this]() {
+        const auto* td = templateDescriptor();
+        if (td) {
+            LayoutParams params{td->layout.depthSpacing, td->layout.spreadSpacing};
+            return LayoutEngine::computeLayout(m_rootNode, td->layout.algorithm, params);
+        }
+        return LayoutEngine::computeLayout(m_rootNode, m_layoutStyle);
+    };
+    QMap<NodeItem*, QPointF> positions = computeLayout();
+
+    // Unread branches are placed as blocks that keep the side they were saved
+    // on; one the layout turns to face its parent is read and laid out instead
+    QList<NodeItem*> turned;
+    for (auto it = m_pendingChunks.cbegin(); it != m_pendingChunks.cend(); ++it) {
+        NodeItem* owner = it.key();
+        NodeItem* parent = owner->parentNode();
+        if (!parent || !positions.contains(owner) || !positions.contains(parent))
+            continue;
+        const QPointF outward = positions[owner] - positions[parent];
+        if (QPointF::dotProduct(outward, it->bounds.center()) < 0)
+            turned.append(owner);
+    }
+    if (!turned.isEmpty()) {
+        for (auto* owner : std::as_const(turned))
+            loadChunk(owner);
+        positions = computeLayout();
+    }
+
+    // Stop the previous animation where it is; the new one starts from the
+    // current positions, so nodes are retargeted instead of jumping. A stopped
+    // group does not emit finished(), so only the last layout zooms to fit.
+    delete m_layoutAnimation;
+
+    auto fitViews = [this]() {
+        for (auto* view : views()) {
+            if (auto* mv = qobject_cast<MindMapView*>(view))
+                mv->zoomToFit();
+        }
+        emit layoutFinished();
+    };
+
+    if (!animated) {
+        for (auto it = positions.begin(); it != positions.end(); ++it)
+            it.key()->setPos(it.value());
+        fitViews();
+        return;
     }
 
     // Animate to new positions
@@ -395,12 +1231,19 @@ void MindMapScene::autoLayout() {
         anim->setEasingCurve(QEasingCurve::OutCubic);
         group->addAnimation(anim);
     }
-    connect(group, &QAbstractAnimation::finished, this, [this, group]() {
+    connect(group, &QAbstractAnimation::finished, this, [group, fitViews]() {
         group->deleteLater();
-        for (auto* view : views()) {
-            if (auto* mv = qobject_cast<MindMapView*>(view))
-                mv->zoomToFit();
-        }
+        fitViews();
     });
+    m_layoutAnimation = group;
     group->start();
 }
+
+void MindMapScene::scheduleLayout() {
+    if (!m_layoutTimer->isActive())
+        m_layoutTimer->start();
+}
+
+bool MindMapScene::isLayoutPending() const {
+    return m_layoutTimer->isActive();
+}
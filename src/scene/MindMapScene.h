@@ -1,14 +1,23 @@
 #pragma once
 
 #include "layout/LayoutEngine.h"
+#include "scene/MindMapSerializer.h"
+#include "scene/SearchIndex.h"
 
+#include <QByteArray>
 #include <QGraphicsScene>
+#include <QHash>
 #include <QMap>
+#include <QPointer>
+#include <QSet>
 
 class NodeItem;
 class EdgeItem;
+class QIODevice;
+struct NodeTree;
 class QJsonObject;
-class QJsonArray;
+class QParallelAnimationGroup;
+class QTimer;
 class QUndoStack;
 class TemplateDescriptor;
 class InlineEditController;
@@ -17,16 +26,48 @@ class MindMapScene : public QGraphicsScene {
     Q_OBJECT
 
 public:
+    // Room kept around the content so scrolling past the edge still works
+    static constexpr qreal kSceneMargin = 2000.0;
+    // The scene rect shrinks back once it is this many times the needed area
+    static constexpr qreal kShrinkAreaRatio = 4.0;
+    static constexpr int kSceneRectCheckMs = 1000;
+    // BSP index: QGraphicsScene halves the rect per level; aim for this many
+    // items per leaf
+    static constexpr int kItemsPerBspLeaf = 8;
+    static constexpr int kMinBspDepth = 5;
+    static constexpr int kMaxBspDepth = 16;
+
     explicit MindMapScene(QObject* parent = nullptr);
+    ~MindMapScene() override;
 
     NodeItem* rootNode() const;
     NodeItem* addNode(const QString& text, NodeItem* parent);
     void removeNode(NodeItem* node);
-    void autoLayout();
+    // Animated by default; imports and batch tools apply positions directly.
+    // A new layout retargets any animation still running from the previous one.
+    void autoLayout(bool animated = true);
+    // Marks the layout dirty; bursts of calls collapse into one animated layout
+    // on the next event-loop turn (used by undo/redo and text edits)
+    void scheduleLayout();
+    bool isLayoutPending() const;
 
     NodeItem* selectedNode() const;
+    QList<NodeItem*> selectedNodes() const;
+    // Selected nodes without a selected ancestor, in tree order: the subtrees a
+    // structural operation on the selection acts on
+    QList<NodeItem*> selectedSubtreeRoots() const;
+
+    // Group drag of the selected subtrees, driven by NodeItem's mouse events.
+    // Releasing over another node reparents the subtrees under it once the
+    // cursor has moved QApplication::startDragDistance() from |pressScreenPos|;
+    // otherwise the moves are pushed as one undo step.
+    void beginNodeDrag(NodeItem* grabbed, const QPoint& pressScreenPos);
+    void dragNodes(const QPointF& delta);
+    void endNodeDrag(const QPointF& scenePos, const QPoint& screenPos);
 
     QUndoStack* undoStack() const;
+    // Approximate memory held by the undo history (see retainedBytes in Commands.h)
+    qsizetype undoRetainedBytes() const;
     bool isEditing() const;
 
     LayoutStyle layoutStyle() const;
@@ -39,19 +80,45 @@ public:
 
     EdgeItem* findEdge(NodeItem* parent, NodeItem* child) const;
 
+    // Node identity index (maintained by NodeItem as it enters/leaves the scene)
+    NodeItem* nodeById(quint64 id) const;
+    // Nodes in the map, counting those still held in pending chunks
+    int nodeCount() const;
+    void registerNode(NodeItem* node);
+    void unregisterNode(NodeItem* node);
+
     // Serialization
     QJsonObject toJson() const;
     bool fromJson(const QJsonObject& json);
     bool saveToFile(const QString& filePath);
     bool loadFromFile(const QString& filePath);
+    // True while a staged load (MapLoader) is building the items. The map is
+    // incomplete until then: toJson is empty and saveToFile fails untouched.
+    bool isLoading() const;
+
+    // Hibernation: the map is kept as compressed JSON and every item is deleted.
+    // The undo stack stays as it is (commands hold IDs and snapshots, not items)
+    // and so does the modified flag; toJson and saveToFile read the stored copy.
+    // wake rebuilds the items with the same IDs, so the history still applies;
+    // if it fails, the scene stays hibernated and nothing is lost.
+    bool hibernate();
+    bool wake();
+    bool isHibernated() const;
+    // Approximate memory held by the items (0 while hibernated) and by the
+    // hibernated copy
+    qsizetype itemRetainedBytes() const;
+    qsizetype hibernatedBytes() const;
 
     // Export/Import
     QString exportToText() const;
+    bool exportToText(QIODevice* device) const;
     QString exportToMarkdown() const;
+    bool exportToMarkdown(QIODevice* device) const;
     bool exportToPng(const QString& filePath, int scaleFactor = 2);
     bool exportToSvg(const QString& filePath);
     bool exportToPdf(const QString& filePath);
     bool importFromText(const QString& text);
+    bool importTree(const NodeTree& tree);
 
     // Scene management
     void clearScene();
@@ -61,6 +128,69 @@ public:
     // Root node creation (consolidates 4 duplicated patterns)
     NodeItem* createRootNode(const QString& text);
 
+    // Creates and attaches a child node + edge without positioning, selecting or
+    // marking the scene modified (used by loaders that set positions themselves).
+    // |index| is the position among the parent's children; -1 appends.
+    NodeItem* createChildNode(const QString& text, NodeItem* parent, int index = -1);
+
+    // Replaces the scene with |tree| in one batch; positions are left to the caller
+    bool buildTree(const NodeTree& tree);
+
+    // Subtree snapshots (public API for Commands): captureTree reads any pending
+    // chunks and copies the subtree with IDs and positions; insertTree rebuilds
+    // such a copy under |parent|; destroySubtree deletes the items outright.
+    NodeTree captureTree(NodeItem* node);
+    NodeItem* insertTree(const NodeTree& tree, NodeItem* parent, int index = -1);
+    void destroySubtree(NodeItem* node);
+    // Makes the tree match |tree| by changing only the items that differ:
+    // nodes are matched by ID, then moved, renamed or repositioned in place;
+    // entries without a match are created and nodes the tree lacks are deleted.
+    // Entries with ID 0 get the IDs of the items created for them.
+    void applyTree(NodeTree& tree);
+    // Moves |node| with its subtree under |parent| (public API for Commands);
+    // fails for the root and when |parent| lies inside the subtree
+    bool reparentNode(NodeItem* node, NodeItem* parent, int index = -1);
+    // Pushes one undo step that reparents every node in |nodes| under |parent|
+    void reparentNodes(const QList<NodeItem*>& nodes, NodeItem* parent);
+    // Pushes one undo step that brings the tree in line with |tree|, e.g. the
+    // file after another program changed it. Returns the number of nodes that
+    // differed; nothing is pushed when there are none.
+    int syncToTree(const NodeTree& tree);
+
+    // Scene rect tracking: nodeGeometryChanged grows the rect at once when a
+    // node moves past it; fitSceneRect (run lazily after changes) also shrinks
+    // it with hysteresis and retunes the BSP depth to the item count
+    void nodeGeometryChanged(NodeItem* node);
+    void fitSceneRect();
+    // Reports a node or edge area whose drawing changed through contentChanged;
+    // a no-op while nothing listens
+    void markContentChanged(const QRectF& sceneRect);
+    // The area the items cover without walking them: exact after fitSceneRect
+    // and grown by each change reported since, so it can only be too large
+    QRectF contentBounds() const;
+    static int bspDepthForItemCount(int itemCount);
+
+    // Full-text search: the index is built on the first query and kept current
+    // from then on; results are in tree order. Pending chunks contribute their
+    // text only, and a chunk is built when a query returns one of its nodes.
+    // Matches set with setSearchMatches are highlighted in the scene and outline.
+    QList<NodeItem*> findNodes(const QString& query);
+    void setSearchMatches(const QList<NodeItem*>& nodes);
+    bool isSearchMatch(const NodeItem* node) const;
+    QSet<quint64> searchMatches() const;
+    void nodeTextChanged(NodeItem* node);
+
+    // Chunked loading: large branches read from a file keep their children as an
+    // unparsed chunk until they are needed (scrolled into view at a readable
+    // zoom, edited, found, exported). Layout moves a pending branch as one block.
+    bool hasPendingChunks() const;
+    bool isChunkPending(NodeItem* node) const;
+    // Reads |node|'s own pending chunk; chunks nested in it stay pending
+    void ensureChildrenLoaded(NodeItem* node);
+    void ensureLoaded(NodeItem* node);
+    void ensureAllLoaded();
+    void requestChunksInRect(const QRectF& rect);
+
     // Edge registration (public API for Commands)
     void registerEdge(EdgeItem* edge);
     void unregisterEdge(EdgeItem* edge);
@@ -68,7 +198,29 @@ public:
 signals:
     void modifiedChanged(bool modified);
     void fileLoaded(const QString& filePath);
+    void fileSaved(const QString& filePath);
     void layoutStyleChanged();
+    // Emitted once node positions have settled after a layout
+    void layoutFinished();
+    void searchMatchesChanged();
+    // Scene area where nodes or edges moved, resized, appeared or went away.
+    // For overviews of the map: listening to QGraphicsScene::changed instead
+    // would switch every view off Qt's direct item-to-view update path.
+    void contentChanged(const QRectF& sceneRect);
+
+    // Fine-grained tree changes, for item models over the scene. Each
+    // about-to signal comes before the change and its partner after it; rows
+    // are positions among the parent's children. Batch loads and clearScene
+    // report a reset instead of one signal per node.
+    void nodeAboutToBeInserted(NodeItem* parent, int row);
+    void nodeInserted(NodeItem* parent, int row);
+    void nodeAboutToBeRemoved(NodeItem* parent, int row);
+    void nodeRemoved(NodeItem* parent, int row);
+    void nodeAboutToBeMoved(NodeItem* node, NodeItem* newParent, int newRow);
+    void nodeMoved(NodeItem* node);
+    void nodeRenamed(NodeItem* node);
+    void treeAboutToBeReset();
+    void treeReset();
 
 public slots:
     void addChildToSelected();
@@ -85,18 +237,73 @@ protected:
 private:
     friend class MindMapSerializer;
     friend class MindMapExporter;
+    friend class tst_MindMapSceneSerialization;
+
+    struct PendingChunk {
+        int index = -1;     // position in m_chunkTable
+        QPointF anchor;     // owner position recorded in the file
+        QRectF bounds;      // subtree bounds relative to the anchor
+        int nodeCount = 0;
+    };
 
     void finishEditing();
     void markModified();
+    // Clears the undo history and applies the configured undo limit, which
+    // QUndoStack only accepts while it is empty
+    void resetUndoStack();
+    // Deletes every item and pending chunk; clearScene also resets the history
+    void clearItems();
+    void loadChunk(NodeItem* node);
+    void loadVisibleChunk();
+    // Builds the chunks a node found by search is stored in; null if it is gone
+    NodeItem* loadStoredNode(quint64 id);
+    QList<NodeItem*> createTreeItems(const NodeTree& tree, NodeItem* parent, int index);
+    // Creates up to |count| more entries of |tree|, after those already in |nodes|
+    void appendTreeItems(const NodeTree& tree, NodeItem* parent, int index,
+                         QList<NodeItem*>& nodes, int count);
+    EdgeItem* createEdge(NodeItem* parent, NodeItem* child);
+    QList<NodeItem*> subtreeRoots(const QSet<NodeItem*>& nodes) const;
+    NodeItem* dropTargetAt(const QPointF& scenePos, const QList<NodeItem*>& dragged) const;
+    void sortByTreeOrder(QList<NodeItem*>& nodes);
 
     NodeItem* m_rootNode = nullptr;
     QList<EdgeItem*> m_edges;
+    QHash<quint64, NodeItem*> m_nodeIndex;
     QUndoStack* m_undoStack;
     bool m_modified = false;
     bool m_batchLoading = false;
+    QByteArray m_hibernatedState;
     LayoutStyle m_layoutStyle = LayoutStyle::Bilateral;
     QString m_templateId;
 
+    // Chunked loading
+    QHash<NodeItem*, PendingChunk> m_pendingChunks;
+    QList<MindMapSerializer::StoredChunk> m_chunkTable;
+    QRectF m_chunkLoadRect;
+    QTimer* m_chunkLoadTimer;
+
+    // Layout scheduling
+    QTimer* m_layoutTimer;
+    QPointer<QParallelAnimationGroup> m_layoutAnimation;
+
+    // Scene rect tracking
+    QTimer* m_sceneRectTimer;
+    QRectF m_contentBounds;
+
+    // Full-text search; the pre-order ranks sort results and are rebuilt
+    // lazily after structural changes
+    SearchIndex m_searchIndex;
+    bool m_searchIndexBuilt = false;
+    QSet<quint64> m_searchMatches;
+    // Indexed nodes of pending chunks -> the node holding the chunk
+    QHash<quint64, quint64> m_storedNodeOwners;
+    QHash<const NodeItem*, int> m_treeOrder;
+    bool m_treeOrderDirty = true;
+
+    // Group drag: subtree roots and where they started
+    QList<QPair<quint64, QPointF>> m_dragOrigins;
+    QPoint m_dragPressScreenPos;
+
     // Editing
     InlineEditController* m_editController;
 };
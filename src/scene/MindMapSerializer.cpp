@@ -3,29 +3,272 @@
 #include "scene/MindMapScene.h"
 #include "scene/NodeItem.h"
 
+#include <QByteArrayView>
 #include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QPair>
 #include <QUndoStack>
 
+#include <utility>
+
+// File layout
+// -----------
+// Every node is written as {"id", "text", "x", "y", "children": [...]}, where "id"
+// is the node's 64-bit identifier as a hex string (JSON numbers lose precision
+// above 2^53). A subtree below
+// the root with at least kChunkNodeThreshold nodes is written as a chunk instead:
+// the node keeps its text and position but replaces "children" with "chunk", an
+// index into the top-level "chunks" array. Each chunk carries a summary (owner
+// text, nodeCount, bounds) next to its "children", so a loader can place the
+// branch without reading it. Files without chunks are still written as version 2.
+//
+// Reading cuts the "chunks" array out of the document before parsing it: a
+// scan finds each chunk's byte range and the range of its "children", and only
+// the rest of the chunk (the summary) is parsed. The children stay as text until
+// their branch is built.
+
+static QString idToJson(quint64 id) {
+    return QString::number(id, 16);
+}
+
+static quint64 idFromJson(const QJsonValue& value) {
+    bool ok = false;
+    quint64 id = value.toString().toULongLong(&ok, 16);
+    return ok ? id : 0;
+}
+
+static QJsonArray rectToJson(const QRectF& rect) {
+    return QJsonArray{rect.x(), rect.y(), rect.width(), rect.height()};
+}
+
+static QRectF rectFromJson(const QJsonArray& array) {
+    return QRectF(array.at(0).toDouble(), array.at(1).toDouble(), array.at(2).toDouble(),
+                  array.at(3).toDouble());
+}
+
+// --- Byte ranges ---
+// Just enough of a JSON reader to step over values without building them
+
+using ByteRange = QPair<qsizetype, qsizetype>; // [first, second)
+
+static qsizetype skipSpace(const QByteArray& data, qsizetype i) {
+    while (i < data.size()
+           && (data[i] == ' ' || data[i] == '\n' || data[i] == '\r' || data[i] == '\t'))
+        ++i;
+    return i;
+}
+
+// Index just past the value that starts at |i|; -1 if it does not end
+static qsizetype skipValue(const QByteArray& data, qsizetype i) {
+    if (i >= data.size())
+        return -1;
+    if (data[i] == '"') {
+        for (++i; i < data.size(); ++i) {
+            if (data[i] == '\\')
+                ++i;
+            else if (data[i] == '"')
+                return i + 1;
+        }
+        return -1;
+    }
+    if (data[i] == '{' || data[i] == '[') {
+        int depth = 0;
+        for (; i < data.size(); ++i) {
+            switch (data[i]) {
+            case '"':
+                i = skipValue(data, i);
+                if (i < 0)
+                    return -1;
+                --i;
+                break;
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0)
+                    return i + 1;
+                break;
+            default:
+                break;
+            }
+        }
+        return -1;
+    }
+    // Number, true, false or null
+    while (i < data.size() && data[i] != ',' && data[i] != '}' && data[i] != ']'
+           && data[i] != ' ' && data[i] != '\n' && data[i] != '\r' && data[i] != '\t')
+        ++i;
+    return i;
+}
+
+// The value stored under |key| in the object at |object|; empty if it has none
+static ByteRange memberValue(const QByteArray& data, const ByteRange& object,
+                             QByteArrayView key) {
+    qsizetype i = skipSpace(data, object.first);
+    if (i >= object.second || data[i] != '{')
+        return {};
+    i = skipSpace(data, i + 1);
+    while (i < object.second && data[i] == '"') {
+        const qsizetype keyEnd = skipValue(data, i);
+        if (keyEnd < 0)
+            return {};
+        const bool match = QByteArrayView(data.constData() + i + 1, keyEnd - i - 2) == key;
+        i = skipSpace(data, keyEnd);
+        if (i >= object.second || data[i] != ':')
+            return {};
+        const qsizetype begin = skipSpace(data, i + 1);
+        const qsizetype end = skipValue(data, begin);
+        if (end < 0)
+            return {};
+        if (match)
+            return {begin, end};
+        i = skipSpace(data, end);
+        if (i < object.second && data[i] == ',')
+            i = skipSpace(data, i + 1);
+    }
+    return {};
+}
+
+// The elements of the array at |array|; false if it is malformed
+static bool arrayElements(const QByteArray& data, const ByteRange& array,
+                          QList<ByteRange>& elements) {
+    qsizetype i = skipSpace(data, array.first);
+    if (i >= array.second || data[i] != '[')
+        return false;
+    i = skipSpace(data, i + 1);
+    while (i < array.second && data[i] != ']') {
+        const qsizetype end = skipValue(data, i);
+        if (end < 0)
+            return false;
+        elements.append({i, end});
+        i = skipSpace(data, end);
+        if (i < array.second && data[i] == ',')
+            i = skipSpace(data, i + 1);
+    }
+    return i < array.second;
+}
+
+// The text of |outer| with the value at |inner| replaced by an empty array
+static QByteArray withoutRange(const QByteArray& data, const ByteRange& outer,
+                               const ByteRange& inner) {
+    QByteArray result;
+    result.reserve(outer.second - outer.first - (inner.second - inner.first) + 2);
+    result.append(data.constData() + outer.first, inner.first - outer.first);
+    result.append("[]");
+    result.append(data.constData() + inner.second, outer.second - inner.second);
+    return result;
+}
+
 MindMapSerializer::MindMapSerializer(MindMapScene* scene) : m_scene(scene) {}
 
-QJsonObject MindMapSerializer::nodeToJson(NodeItem* node) const {
+QJsonObject MindMapSerializer::nodeToJson(NodeItem* node, QJsonArray& chunks, int& nodeCount,
+                                          QRectF& bounds) const {
     QJsonObject obj;
+    obj["id"] = idToJson(node->id());
     obj["text"] = node->text();
     obj["x"] = node->pos().x();
     obj["y"] = node->pos().y();
 
+    nodeCount = 1;
+    bounds = node->nodeRect().translated(node->pos());
+
+    // Branch not read since loading: copy its stored chunk straight through
+    auto pending = m_scene->m_pendingChunks.constFind(node);
+    if (pending != m_scene->m_pendingChunks.cend()) {
+        obj["chunk"] = copyStoredChunk(pending->index, node->pos() - pending->anchor, chunks);
+        nodeCount += pending->nodeCount;
+        bounds = bounds.united(pending->bounds.translated(node->pos()));
+        return obj;
+    }
+
     QJsonArray children;
+    int descendants = 0;
+    QRectF childBounds;
     for (auto* child : node->childNodes()) {
-        children.append(nodeToJson(child));
+        int childCount = 0;
+        QRectF childRect;
+        children.append(nodeToJson(child, chunks, childCount, childRect));
+        descendants += childCount;
+        childBounds = childBounds.united(childRect);
+    }
+    nodeCount += descendants;
+    bounds = bounds.united(childBounds);
+
+    if (node != m_scene->m_rootNode && nodeCount >= kChunkNodeThreshold) {
+        QJsonObject chunk;
+        chunk["text"] = node->text();
+        chunk["nodeCount"] = descendants;
+        chunk["bounds"] = rectToJson(childBounds);
+        chunk["children"] = children;
+        obj["chunk"] = chunks.size();
+        chunks.append(chunk);
+    } else {
+        obj["children"] = children;
     }
-    obj["children"] = children;
     return obj;
 }
 
+int MindMapSerializer::copyStoredChunk(int index, const QPointF& offset,
+                                       QJsonArray& chunks) const {
+    const StoredChunk& stored = m_scene->m_chunkTable.at(index);
+    QJsonObject chunk;
+    chunk["text"] = stored.text;
+    chunk["nodeCount"] = stored.nodeCount;
+    chunk["bounds"] = rectToJson(stored.bounds.translated(offset));
+    chunk["children"] = copyStoredNodes(storedChildren(index), offset, chunks);
+    chunks.append(chunk);
+    return chunks.size() - 1;
+}
+
+QJsonArray MindMapSerializer::storedChildren(int index) const {
+    return QJsonDocument::fromJson(m_scene->m_chunkTable.at(index).children).array();
+}
+
+QList<MindMapSerializer::StoredChunk> MindMapSerializer::storedChunks(const QJsonArray& chunks) {
+    // Chunks that arrive already parsed are stored as text like those from a file
+    QList<StoredChunk> result;
+    result.reserve(chunks.size());
+    for (const auto& value : chunks) {
+        const QJsonObject obj = value.toObject();
+        StoredChunk chunk;
+        chunk.text = obj["text"].toString();
+        chunk.nodeCount = obj["nodeCount"].toInt();
+        chunk.bounds = rectFromJson(obj["bounds"].toArray());
+        chunk.children =
+            QJsonDocument(obj["children"].toArray()).toJson(QJsonDocument::Compact);
+        result.append(chunk);
+    }
+    return result;
+}
+
+QJsonArray MindMapSerializer::copyStoredNodes(const QJsonArray& nodes, const QPointF& offset,
+                                              QJsonArray& chunks) const {
+    // Chunk indices are renumbered for the new file, and positions follow the
+    // owner if it was moved while the branch stayed unread
+    QJsonArray out;
+    for (const auto& value : nodes) {
+        QJsonObject obj = value.toObject();
+        if (!offset.isNull()) {
+            obj["x"] = obj["x"].toDouble() + offset.x();
+            obj["y"] = obj["y"].toDouble() + offset.y();
+        }
+        if (obj.contains("chunk"))
+            obj["chunk"] = copyStoredChunk(obj["chunk"].toInt(), offset, chunks);
+        else
+            obj["children"] = copyStoredNodes(obj["children"].toArray(), offset, chunks);
+        out.append(obj);
+    }
+    return out;
+}
+
 QJsonObject MindMapSerializer::toJson() const {
+    // Half-built: a document without its root would replace the map
+    if (m_scene->m_batchLoading)
+        return {};
     QJsonObject root;
     root["format"] = QStringLiteral("ymind");
     root["version"] = 2;
@@ -33,42 +276,112 @@ QJsonObject MindMapSerializer::toJson() const {
     if (!m_scene->m_templateId.isEmpty())
         root["templateId"] = m_scene->m_templateId;
     if (m_scene->m_rootNode) {
-        root["root"] = nodeToJson(m_scene->m_rootNode);
+        QJsonArray chunks;
+        int nodeCount = 0;
+        QRectF bounds;
+        root["root"] = nodeToJson(m_scene->m_rootNode, chunks, nodeCount, bounds);
+        if (!chunks.isEmpty()) {
+            root["version"] = 3;
+            root["chunks"] = chunks;
+        }
     }
     return root;
 }
 
-NodeItem* MindMapSerializer::nodeFromJson(const QJsonObject& json, NodeItem* parent) {
+NodeItem* MindMapSerializer::nodeFromJson(const QJsonObject& json, NodeItem* parent,
+                                          const QPointF& offset) {
     QString text = json["text"].toString("Topic");
-    qreal x = json["x"].toDouble(0);
-    qreal y = json["y"].toDouble(0);
+    QPointF filePos(json["x"].toDouble(0), json["y"].toDouble(0));
 
     NodeItem* node;
     if (!parent) {
         // This is the root node
         node = m_scene->createRootNode(text);
-        node->setPos(x, y);
     } else {
-        node = m_scene->addNode(text, parent);
-        if (node)
-            node->setPos(x, y);
+        node = m_scene->createChildNode(text, parent);
     }
+    node->setPos(filePos + offset);
+
+    // Files written before IDs existed keep the freshly generated ones
+    if (quint64 id = idFromJson(json["id"]))
+        node->setId(id);
 
-    if (!node)
-        return nullptr;
+    if (json.contains("chunk")) {
+        // Only the summary is read now; the children follow on demand
+        addPendingChunk(node, json["chunk"].toInt(-1), filePos);
+        return node;
+    }
 
     QJsonArray children = json["children"].toArray();
     for (const auto& childVal : children) {
-        nodeFromJson(childVal.toObject(), node);
+        nodeFromJson(childVal.toObject(), node, offset);
     }
     return node;
 }
 
-bool MindMapSerializer::fromJson(const QJsonObject& json) {
+void MindMapSerializer::addPendingChunk(NodeItem* node, int index, const QPointF& filePos) {
+    if (index < 0 || index >= m_scene->m_chunkTable.size())
+        return;
+    const StoredChunk& chunk = m_scene->m_chunkTable.at(index);
+    MindMapScene::PendingChunk pending;
+    pending.index = index;
+    pending.anchor = filePos;
+    pending.bounds = chunk.bounds.translated(-filePos);
+    pending.nodeCount = chunk.nodeCount;
+    m_scene->m_pendingChunks.insert(node, pending);
+    node->setStoredChildren(pending.bounds, pending.nodeCount);
+    node->setToolTip(
+        MindMapScene::tr("%n more topic(s) in this branch", nullptr, pending.nodeCount));
+}
+
+void MindMapSerializer::loadChunk(NodeItem* owner, int index, const QPointF& offset) {
+    if (index < 0 || index >= m_scene->m_chunkTable.size())
+        return;
+
+    const QJsonArray children = storedChildren(index);
+    for (const auto& childVal : children) {
+        nodeFromJson(childVal.toObject(), owner, offset);
+    }
+}
+
+QList<MindMapSerializer::StoredNode> MindMapSerializer::storedNodes(int index,
+                                                                     quint64 ownerId) const {
+    QList<StoredNode> nodes;
+    QList<QPair<int, quint64>> chunks{{index, ownerId}};
+    while (!chunks.isEmpty()) {
+        const auto [chunk, owner] = chunks.takeLast();
+        if (chunk < 0 || chunk >= m_scene->m_chunkTable.size())
+            continue;
+        QList<QJsonObject> stack;
+        for (const auto& value : storedChildren(chunk))
+            stack.append(value.toObject());
+        while (!stack.isEmpty()) {
+            const QJsonObject obj = stack.takeLast();
+            // Nodes from files without IDs could not be found again once built
+            const quint64 id = idFromJson(obj["id"]);
+            if (id == 0)
+                continue;
+            nodes.append({id, obj["text"].toString("Topic"), owner});
+            if (obj.contains("chunk")) {
+                chunks.append({obj["chunk"].toInt(-1), id});
+                continue;
+            }
+            for (const auto& value : obj["children"].toArray())
+                stack.append(value.toObject());
+        }
+    }
+    return nodes;
+}
+
+bool MindMapSerializer::fromJson(const QJsonObject& json, History history) {
     if (json["format"].toString() != "ymind")
         return false;
 
-    m_scene->clearScene();
+    if (history == History::Reset)
+        m_scene->clearScene();
+    else
+        m_scene->clearItems();
+    emit m_scene->treeAboutToBeReset();
     m_scene->m_batchLoading = true;
 
     // Restore layout style (default to Bilateral for old files)
@@ -82,49 +395,194 @@ bool MindMapSerializer::fromJson(const QJsonObject& json) {
             TemplateRegistry::builtinIdForLayoutStyle(json["layoutStyle"].toInt(0));
     }
 
+    // Chunks stay unbuilt until their branch is materialized
+    m_scene->m_chunkTable = storedChunks(json["chunks"].toArray());
+
     QJsonObject rootObj = json["root"].toObject();
-    m_scene->m_rootNode = nodeFromJson(rootObj, nullptr);
+    m_scene->m_rootNode = nodeFromJson(rootObj, nullptr, QPointF());
     if (!m_scene->m_rootNode) {
         // Fallback: create default root
         m_scene->m_rootNode = m_scene->createRootNode(MindMapScene::tr("Central Topic"));
     }
+    if (m_scene->m_pendingChunks.isEmpty())
+        m_scene->m_chunkTable.clear();
 
-    m_scene->m_undoStack->clear();
+    if (history == History::Reset)
+        m_scene->resetUndoStack();
     m_scene->m_batchLoading = false;
-    m_scene->setModified(false);
+    emit m_scene->treeReset();
+    m_scene->fitSceneRect();
+    if (history == History::Reset)
+        m_scene->setModified(false);
     return true;
 }
 
 bool MindMapSerializer::saveToFile(const QString& filePath) {
+    // Checked before opening, which would truncate the file being read
+    if (m_scene->m_batchLoading)
+        return false;
     QFile file(filePath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
         return false;
 
-    QJsonDocument doc(toJson());
+    // Through the scene, which answers from its stored copy while hibernated
+    QJsonDocument doc(m_scene->toJson());
     file.write(doc.toJson(QJsonDocument::Indented));
     file.close();
 
     m_scene->m_undoStack->setClean();
     m_scene->setModified(false);
+    emit m_scene->fileSaved(filePath);
     return true;
 }
 
 bool MindMapSerializer::loadFromFile(const QString& filePath) {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    const ParsedMap map = parseFile(filePath);
+    if (!map.ok)
         return false;
 
-    QByteArray data = file.readAll();
+    QList<NodeItem*> nodes;
+    beginBuild(map);
+    buildNext(map, nodes, map.tree.size());
+    finishBuild(map, nodes);
+    emit m_scene->fileLoaded(filePath);
+    return true;
+}
+
+// --- Staged loading ---
+
+MindMapSerializer::ParsedMap MindMapSerializer::parseFile(const QString& filePath,
+                                                          const std::atomic<bool>* cancelled,
+                                                          Chunks chunks) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return {};
+    const QByteArray data = file.readAll();
     file.close();
+    if (cancelled && cancelled->load())
+        return {};
+    return parseData(data, cancelled, chunks);
+}
+
+MindMapSerializer::ParsedMap MindMapSerializer::parseData(const QByteArray& data,
+                                                          const std::atomic<bool>* cancelled,
+                                                          Chunks chunks) {
+    auto isCancelled = [cancelled]() { return cancelled && cancelled->load(); };
+    ParsedMap map;
+
+    // Each chunk without its children is a summary small enough to parse
+    QByteArray document = data;
+    const ByteRange whole{0, data.size()};
+    const ByteRange chunkArray = memberValue(data, whole, "chunks");
+    QList<ByteRange> elements;
+    if (chunkArray.second > chunkArray.first && arrayElements(data, chunkArray, elements)) {
+        map.chunks.reserve(elements.size());
+        for (const ByteRange& element : std::as_const(elements)) {
+            if (isCancelled())
+                return {};
+            const ByteRange children = memberValue(data, element, "children");
+            const bool hasChildren = children.second > children.first;
+            const QJsonObject summary =
+                QJsonDocument::fromJson(hasChildren ? withoutRange(data, element, children)
+                                                    : data.mid(element.first,
+                                                               element.second - element.first))
+                    .object();
+            StoredChunk chunk;
+            chunk.text = summary["text"].toString();
+            chunk.nodeCount = summary["nodeCount"].toInt();
+            chunk.bounds = rectFromJson(summary["bounds"].toArray());
+            if (hasChildren)
+                chunk.children = data.mid(children.first, children.second - children.first);
+            map.chunks.append(chunk);
+        }
+        document = withoutRange(data, whole, chunkArray);
+    }
+    if (isCancelled())
+        return {};
 
     QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
-    if (parseError.error != QJsonParseError::NoError)
-        return false;
+    const QJsonDocument doc = QJsonDocument::fromJson(document, &parseError);
+    if (parseError.error != QJsonParseError::NoError || isCancelled())
+        return {};
+    const QJsonObject json = doc.object();
+    if (json["format"].toString() != "ymind")
+        return {};
 
-    if (!fromJson(doc.object()))
-        return false;
+    // Same defaults as fromJson, for files without a template or layout style
+    map.layoutStyle = json["layoutStyle"].toInt(0);
+    map.templateId = json.contains("templateId")
+                         ? json["templateId"].toString()
+                         : TemplateRegistry::builtinIdForLayoutStyle(map.layoutStyle);
+    // A document the scan could not split is parsed whole instead
+    if (map.chunks.isEmpty())
+        map.chunks = storedChunks(json["chunks"].toArray());
 
-    emit m_scene->fileLoaded(filePath);
-    return true;
+    // Children are pushed in reverse so entries come out in pre-order
+    QList<QPair<QJsonObject, int>> stack{{json["root"].toObject(), -1}};
+    while (!stack.isEmpty()) {
+        if (map.tree.size() % 4096 == 0 && isCancelled())
+            return ParsedMap();
+        const auto [obj, parent] = stack.takeLast();
+        const int index = map.tree.append(obj["text"].toString("Topic"), parent);
+        NodeTree::Entry& entry = map.tree.entries[index];
+        entry.id = idFromJson(obj["id"]);
+        entry.pos = QPointF(obj["x"].toDouble(0), obj["y"].toDouble(0));
+
+        QJsonArray children;
+        if (obj.contains("chunk")) {
+            const int chunk = obj["chunk"].toInt(-1);
+            if (chunk < 0 || chunk >= map.chunks.size())
+                continue;
+            if (chunks == Chunks::Keep) {
+                map.pendingChunks.append({index, chunk});
+                continue;
+            }
+            // Stored positions are already in file coordinates
+            children = QJsonDocument::fromJson(map.chunks.at(chunk).children).array();
+        } else {
+            children = obj["children"].toArray();
+        }
+        for (qsizetype i = children.size() - 1; i >= 0; --i)
+            stack.append({children.at(i).toObject(), index});
+    }
+    if (chunks == Chunks::Expand)
+        map.chunks.clear();
+    map.ok = true;
+    return map;
+}
+
+void MindMapSerializer::beginBuild(const ParsedMap& map) {
+    m_scene->clearScene();
+    m_scene->m_batchLoading = true;
+    m_scene->m_layoutStyle = static_cast<LayoutStyle>(map.layoutStyle);
+    m_scene->m_templateId = map.templateId;
+    m_scene->m_chunkTable = map.chunks;
+}
+
+void MindMapSerializer::buildNext(const ParsedMap& map, QList<NodeItem*>& nodes, int count) {
+    m_scene->appendTreeItems(map.tree, nullptr, -1, nodes, count);
+}
+
+void MindMapSerializer::finishBuild(const ParsedMap& map, const QList<NodeItem*>& nodes) {
+    emit m_scene->treeAboutToBeReset();
+    for (const auto& ref : map.pendingChunks)
+        addPendingChunk(nodes.at(ref.entry), ref.index, map.tree.entries.at(ref.entry).pos);
+    if (m_scene->m_pendingChunks.isEmpty())
+        m_scene->m_chunkTable.clear();
+
+    m_scene->m_rootNode = nodes.isEmpty()
+                              ? m_scene->createRootNode(MindMapScene::tr("Central Topic"))
+                              : nodes.first();
+    m_scene->resetUndoStack();
+    m_scene->m_batchLoading = false;
+    emit m_scene->treeReset();
+    m_scene->fitSceneRect();
+    m_scene->setModified(false);
+}
+
+void MindMapSerializer::abortBuild(const QList<NodeItem*>& nodes) {
+    // Every built node hangs off the first, so clearing from it removes them all
+    m_scene->m_rootNode = nodes.value(0);
+    m_scene->m_batchLoading = false;
+    m_scene->clearScene();
 }
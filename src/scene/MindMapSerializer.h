@@ -1,7 +1,16 @@
 #pragma once
 
+#include "scene/NodeTree.h"
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QList>
+#include <QPointF>
+#include <QRectF>
 #include <QString>
 
+#include <atomic>
+
 class MindMapScene;
 class NodeItem;
 class QJsonObject;
@@ -10,14 +19,94 @@ class MindMapSerializer {
 public:
     explicit MindMapSerializer(MindMapScene* scene);
 
+    // Subtrees with at least this many nodes (below the root) are written as
+    // separate chunks that are only materialized when needed
+    static constexpr int kChunkNodeThreshold = 256;
+
+    // Whether fromJson starts a fresh history (loading a file) or keeps the undo
+    // stack and modified flag (waking a hibernated scene)
+    enum class History { Reset, Keep };
+
+    // A chunk as held until its branch is needed: the summary is read with the
+    // file, the children stay as the JSON text they were stored as
+    struct StoredChunk {
+        QString text; // the owner's
+        int nodeCount = 0;
+        QRectF bounds;       // of the children, in the file's coordinates
+        QByteArray children; // JSON array of node objects
+    };
+
+    // A node stored in a chunk, as search reads it without building the branch:
+    // |owner| is the node holding the chunk it is stored in
+    struct StoredNode {
+        quint64 id = 0;
+        QString text;
+        quint64 owner = 0;
+    };
+
+    // A file read and parsed without touching any scene: the nodes flattened
+    // into a NodeTree down to the first chunk on each branch, and everything
+    // else fromJson would take from the JSON
+    struct ParsedMap {
+        struct ChunkRef {
+            int entry = 0; // owner's index in |tree|
+            int index = 0; // into |chunks|
+        };
+
+        bool ok = false;
+        NodeTree tree;
+        int layoutStyle = 0;
+        QString templateId;
+        QList<StoredChunk> chunks;
+        QList<ChunkRef> pendingChunks;
+    };
+
     QJsonObject toJson() const;
-    bool fromJson(const QJsonObject& json);
+    bool fromJson(const QJsonObject& json, History history = History::Reset);
     bool saveToFile(const QString& filePath);
     bool loadFromFile(const QString& filePath);
 
+    // Whether parseFile leaves chunked branches for later (opening a file) or
+    // reads them into the tree as well (comparing a file with a live scene)
+    enum class Chunks { Keep, Expand };
+
+    // Safe on a worker thread. Returns early, not ok, once |cancelled| is set.
+    // The chunks are cut out of the document by a scan for their byte ranges
+    // and only their summaries are parsed.
+    static ParsedMap parseFile(const QString& filePath,
+                               const std::atomic<bool>* cancelled = nullptr,
+                               Chunks chunks = Chunks::Keep);
+    static ParsedMap parseData(const QByteArray& data,
+                               const std::atomic<bool>* cancelled = nullptr,
+                               Chunks chunks = Chunks::Keep);
+
+    // Builds a parsed map into the scene in steps, so the GUI thread can return
+    // to the event loop in between. beginBuild empties the scene; buildNext
+    // creates up to |count| more entries after those already in |nodes|; the
+    // model sees nothing until finishBuild publishes the tree with one reset.
+    // abortBuild deletes a partial build instead.
+    void beginBuild(const ParsedMap& map);
+    void buildNext(const ParsedMap& map, QList<NodeItem*>& nodes, int count);
+    void finishBuild(const ParsedMap& map, const QList<NodeItem*>& nodes);
+    void abortBuild(const QList<NodeItem*>& nodes);
+
+    // Materializes the children stored in chunk |index| under |owner|, shifting
+    // them by |offset| when the owner has moved since the summary was read
+    void loadChunk(NodeItem* owner, int index, const QPointF& offset);
+    // The nodes stored in chunk |index| of the scene and in the chunks nested
+    // in it, read as text only; |ownerId| holds chunk |index|
+    QList<StoredNode> storedNodes(int index, quint64 ownerId) const;
+
 private:
-    QJsonObject nodeToJson(NodeItem* node) const;
-    NodeItem* nodeFromJson(const QJsonObject& json, NodeItem* parent);
+    QJsonObject nodeToJson(NodeItem* node, QJsonArray& chunks, int& nodeCount,
+                           QRectF& bounds) const;
+    NodeItem* nodeFromJson(const QJsonObject& json, NodeItem* parent, const QPointF& offset);
+    void addPendingChunk(NodeItem* node, int index, const QPointF& filePos);
+    int copyStoredChunk(int index, const QPointF& offset, QJsonArray& chunks) const;
+    QJsonArray storedChildren(int index) const;
+    static QList<StoredChunk> storedChunks(const QJsonArray& chunks);
+    QJsonArray copyStoredNodes(const QJsonArray& nodes, const QPointF& offset,
+                               QJsonArray& chunks) const;
 
     MindMapScene* m_scene;
 };
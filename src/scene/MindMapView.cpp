@@ -1,28 +1,51 @@
 #include "scene/MindMapView.h"
 #include "core/TemplateDescriptor.h"
 #include "scene/MindMapScene.h"
+#include "scene/NodeItem.h"
 #include "ui/ThemeManager.h"
 
+#include <QElapsedTimer>
 #include <QMouseEvent>
+#include <QPaintEvent>
 #include <QPainter>
 #include <QParallelAnimationGroup>
 #include <QPropertyAnimation>
 #include <QScrollBar>
 #include <QVariantAnimation>
 #include <QWheelEvent>
-#include <QtMath>
+
+#include <cmath>
 
 MindMapView::MindMapView(QWidget* parent) : QGraphicsView(parent) {
     setRenderHint(QPainter::Antialiasing);
     setRenderHint(QPainter::SmoothPixmapTransform);
-    setViewportUpdateMode(FullViewportUpdate);
-    setDragMode(NoDrag);
+    setDragMode(RubberBandDrag);
     setTransformationAnchor(AnchorUnderMouse);
     setResizeAnchor(AnchorViewCenter);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    setSceneRect(-5000, -5000, 10000, 10000);
     setAttribute(Qt::WA_InputMethodEnabled, true);
+
+    applyUpdateMode(AppSettings::instance().viewportUpdateMode());
+    connect(&AppSettings::instance(), &AppSettings::viewportUpdateModeChanged, this,
+            &MindMapView::applyUpdateMode);
+}
+
+void MindMapView::applyUpdateMode(ViewportUpdateMode mode) {
+    m_updateMode = mode;
+    m_fullRepaintMs = -1.0;
+    switch (mode) {
+    case ViewportUpdateMode::Automatic:
+    case ViewportUpdateMode::Full:
+        setViewportUpdateMode(FullViewportUpdate);
+        break;
+    case ViewportUpdateMode::BoundingRect:
+        setViewportUpdateMode(BoundingRectViewportUpdate);
+        break;
+    case ViewportUpdateMode::Minimal:
+        setViewportUpdateMode(MinimalViewportUpdate);
+        break;
+    }
 }
 
 void MindMapView::wheelEvent(QWheelEvent* event) {
@@ -33,6 +56,7 @@ void MindMapView::wheelEvent(QWheelEvent* event) {
         if (canZoomOut())
             scale(1.0 / 1.15, 1.0 / 1.15);
     }
+    requestVisibleChunks();
     event->accept();
 }
 
@@ -73,11 +97,13 @@ void MindMapView::mouseReleaseEvent(QMouseEvent* event) {
 void MindMapView::zoomIn() {
     if (canZoomIn())
         scale(1.2, 1.2);
+    requestVisibleChunks();
 }
 
 void MindMapView::zoomOut() {
     if (canZoomOut())
         scale(1.0 / 1.2, 1.0 / 1.2);
+    requestVisibleChunks();
 }
 
 bool MindMapView::canZoomIn() const {
@@ -111,6 +137,7 @@ void MindMapView::zoomToFit() {
     // Already at target — nothing to animate
     if (qFuzzyCompare(oldScale, newScale) &&
         (oldCenter - newCenter).manhattanLength() < 0.5) {
+        requestVisibleChunks();
         return;
     }
 
@@ -136,6 +163,7 @@ void MindMapView::zoomToFit() {
     connect(m_zoomAnimation, &QAbstractAnimation::finished, this, [this]() {
         m_zoomAnimation->deleteLater();
         m_zoomAnimation = nullptr;
+        requestVisibleChunks();
     });
 
     m_zoomAnimation->start();
@@ -203,7 +231,78 @@ void MindMapView::stopAnimations() {
     }
 }
 
+void MindMapView::scrollContentsBy(int dx, int dy) {
+    QGraphicsView::scrollContentsBy(dx, dy);
+    requestVisibleChunks();
+}
+
+void MindMapView::resizeEvent(QResizeEvent* event) {
+    QGraphicsView::resizeEvent(event);
+    requestVisibleChunks();
+}
+
+void MindMapView::requestVisibleChunks() {
+    // Branches stored as chunks are materialized once they scroll into view at
+    // a zoom where their text can be read; below it their blocks stand in
+    auto* mindMapScene = dynamic_cast<MindMapScene*>(scene());
+    if (mindMapScene && mindMapScene->hasPendingChunks()
+        && transform().m11() >= kMinChunkLoadScale)
+        mindMapScene->requestChunksInRect(mapToScene(viewport()->rect()).boundingRect());
+}
+
+void MindMapView::paintEvent(QPaintEvent* event) {
+    const bool profiling = RenderStats::isEnabled();
+    if (m_updateMode != ViewportUpdateMode::Automatic && !profiling) {
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+    if (profiling)
+        RenderStats::beginFrame();
+    QElapsedTimer timer;
+    timer.start();
+    QGraphicsView::paintEvent(event);
+    const qint64 nsecs = timer.nsecsElapsed();
+
+    if (m_updateMode == ViewportUpdateMode::Automatic)
+        recordPaintCost(nsecs, event->region());
+    if (profiling)
+        emit frameRendered(RenderStats::endFrame(nsecs, visibleNodeCount(event->region())));
+}
+
+int MindMapView::visibleNodeCount(const QRegion& region) const {
+    if (!scene())
+        return 0;
+    const QRectF area = mapToScene(region.boundingRect()).boundingRect();
+    int count = 0;
+    for (auto* item : scene()->items(area, Qt::IntersectsItemBoundingRect)) {
+        if (dynamic_cast<NodeItem*>(item))
+            ++count;
+    }
+    return count;
+}
+
+void MindMapView::recordPaintCost(qint64 nsecs, const QRegion& region) {
+    // Scale large partial repaints up to the whole viewport so both modes
+    // compare. Zooming and resizing repaint everything in either mode, so
+    // BoundingRect keeps getting samples that can switch it back.
+    const QRect bounds = region.boundingRect();
+    const qreal viewportArea = qreal(viewport()->width()) * viewport()->height();
+    const qreal paintedArea = qreal(bounds.width()) * bounds.height();
+    if (viewportArea <= 0 || paintedArea < viewportArea * kMinSampledAreaRatio)
+        return;
+    const qreal fullMs = nsecs / 1e6 * qMax(1.0, viewportArea / paintedArea);
+    m_fullRepaintMs = m_fullRepaintMs < 0 ? fullMs : m_fullRepaintMs * 0.9 + fullMs * 0.1;
+
+    // Hysteresis keeps the mode from flapping around the budget
+    if (viewportUpdateMode() == FullViewportUpdate && m_fullRepaintMs > kFullUpdateBudgetMs)
+        setViewportUpdateMode(BoundingRectViewportUpdate);
+    else if (viewportUpdateMode() == BoundingRectViewportUpdate
+             && m_fullRepaintMs < kFullUpdateBudgetMs / 2)
+        setViewportUpdateMode(FullViewportUpdate);
+}
+
 void MindMapView::drawBackground(QPainter* painter, const QRectF& rect) {
+    RenderStats::Scope profile(RenderStats::Background);
     QColor bgColor = ThemeManager::colors().canvasBackground;
     QColor dotColor = ThemeManager::colors().canvasGridDot;
 
@@ -216,19 +315,41 @@ void MindMapView::drawBackground(QPainter* painter, const QRectF& rect) {
         }
     }
 
-    painter->fillRect(rect, bgColor);
-
-    QPen dotPen(dotColor, 2);
-    dotPen.setCapStyle(Qt::RoundCap);
-    painter->setPen(dotPen);
-
-    const qreal gridSize = 40.0;
-    qreal left = qFloor(rect.left() / gridSize) * gridSize;
-    qreal top = qFloor(rect.top() / gridSize) * gridSize;
+    // Background and dots come from one cached tile instead of a point per cell
+    painter->fillRect(rect, gridBrush(bgColor, dotColor));
+}
 
-    for (qreal x = left; x <= rect.right(); x += gridSize) {
-        for (qreal y = top; y <= rect.bottom(); y += gridSize) {
-            painter->drawPoint(QPointF(x, y));
-        }
+QBrush MindMapView::gridBrush(const QColor& background, const QColor& dot) {
+    const int bucket = qRound(std::log2(transform().m11()) * kGridZoomSteps);
+    const qreal pixelRatio = devicePixelRatioF();
+    if (m_gridPixelRatio == pixelRatio && m_gridZoomBucket == bucket
+        && m_gridBackground == background.rgba() && m_gridDot == dot.rgba())
+        return m_gridBrush;
+
+    // Render one grid cell at the bucket's device resolution, dot in the center
+    const qreal tileScale = std::exp2(qreal(bucket) / kGridZoomSteps) * pixelRatio;
+    const int tileSize = qMax(1, qRound(kGridSize * tileScale));
+    QPixmap tile(tileSize, tileSize);
+    tile.fill(background);
+    {
+        QPainter painter(&tile);
+        painter.setRenderHint(QPainter::Antialiasing);
+        QPen dotPen(dot, 2 * tileScale);
+        dotPen.setCapStyle(Qt::RoundCap);
+        painter.setPen(dotPen);
+        painter.drawPoint(QPointF(tileSize / 2.0, tileSize / 2.0));
     }
+
+    // Map the tile back to kGridSize scene units with a dot on every multiple
+    QBrush brush(tile);
+    const qreal unit = kGridSize / tileSize;
+    brush.setTransform(
+        QTransform::fromTranslate(-kGridSize / 2, -kGridSize / 2).scale(unit, unit));
+
+    m_gridBrush = brush;
+    m_gridBackground = background.rgba();
+    m_gridDot = dot.rgba();
+    m_gridZoomBucket = bucket;
+    m_gridPixelRatio = pixelRatio;
+    return m_gridBrush;
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "core/AppSettings.h"
+#include "scene/RenderStats.h"
+
+#include <QBrush>
 #include <QGraphicsView>
 
 class QParallelAnimationGroup;
@@ -17,23 +21,58 @@ public slots:
     void zoomToFit();
     void ensureNodeVisible(QGraphicsItem* item);
 
+signals:
+    // Emitted after each paint event while RenderStats profiling is enabled
+    void frameRendered(const RenderStats::Frame& frame);
+
 protected:
     void wheelEvent(QWheelEvent* event) override;
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
     void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void resizeEvent(QResizeEvent* event) override;
 
 private:
     void stopAnimations();
+    void applyUpdateMode(ViewportUpdateMode mode);
+    void recordPaintCost(qint64 nsecs, const QRegion& region);
+    int visibleNodeCount(const QRegion& region) const;
+    QBrush gridBrush(const QColor& background, const QColor& dot);
+    void requestVisibleChunks();
     bool canZoomIn() const;
     bool canZoomOut() const;
 
     static constexpr qreal kMinScale = 0.1;
     static constexpr qreal kMaxScale = 10.0;
+    // Below this zoom node text is too small to read, so unread branches stay
+    // unread when they scroll into view
+    static constexpr qreal kMinChunkLoadScale = 0.5;
+    static constexpr qreal kGridSize = 40.0;
+    // The grid tile is re-rendered when the zoom crosses a quarter octave
+    static constexpr int kGridZoomSteps = 4;
+    // Automatic update mode: estimated full-viewport repaint cost above which
+    // only the changed area is repainted (switches back below half of it)
+    static constexpr qreal kFullUpdateBudgetMs = 8.0;
+    // Paints covering less of the viewport than this are not sampled: scaled up,
+    // the fixed cost of a hover or caret repaint would look like a slow frame
+    static constexpr qreal kMinSampledAreaRatio = 0.25;
 
     bool m_panning = false;
     QPoint m_lastPanPoint;
     QParallelAnimationGroup* m_scrollAnimation = nullptr;
     QVariantAnimation* m_zoomAnimation = nullptr;
+
+    // Repaint cost tracking for ViewportUpdateMode::Automatic
+    ViewportUpdateMode m_updateMode = ViewportUpdateMode::Automatic;
+    qreal m_fullRepaintMs = -1.0; // moving average; negative until measured
+
+    // Background tile cache, keyed by colors, zoom bucket and pixel ratio
+    QBrush m_gridBrush;
+    QRgb m_gridBackground = 0;
+    QRgb m_gridDot = 0;
+    int m_gridZoomBucket = 0;
+    qreal m_gridPixelRatio = 0.0;
 };
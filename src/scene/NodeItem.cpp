@@ -1,10 +1,10 @@
 #include "scene/NodeItem.h"
 #include "core/AppSettings.h"
-#include "core/Commands.h"
 #include "core/TemplateDescriptor.h"
 #include "layout/LayoutStyle.h"
 #include "scene/EdgeItem.h"
 #include "scene/MindMapScene.h"
+#include "scene/RenderStats.h"
 #include "ui/ThemeManager.h"
 
 #include <QFontMetricsF>
@@ -12,6 +12,7 @@
 #include <QGraphicsSceneMouseEvent>
 #include <QMetaObject>
 #include <QPainter>
+#include <QRandomGenerator>
 #include <QStyleOptionGraphicsItem>
 #include <QTimer>
 #include <QVariantAnimation>
@@ -179,12 +180,56 @@ private:
     bool m_hovered = false;
 };
 
+// ===========================================================================
+// StoredBranchOverlay — stands in for children still stored as a chunk: one
+//                       block with their count, behind the node that holds them
+// ===========================================================================
+
+class StoredBranchOverlay : public QGraphicsItem {
+public:
+    StoredBranchOverlay(NodeItem* parentNode, const QRectF& bounds, int nodeCount)
+        : QGraphicsItem(parentNode), m_node(parentNode), m_bounds(bounds),
+          m_nodeCount(nodeCount) {
+        setFlag(ItemStacksBehindParent);
+        setAcceptedMouseButtons(Qt::NoButton);
+    }
+
+    QRectF boundingRect() const override { return m_bounds; }
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*) override {
+        const QColor color = m_node->nodeColor();
+        QColor fill = color;
+        fill.setAlpha(40);
+        QPen border(color, 1.5, Qt::DashLine);
+        border.setCosmetic(true);
+
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(border);
+        painter->setBrush(fill);
+        painter->drawRoundedRect(m_bounds, NodeItem::kRadius, NodeItem::kRadius);
+
+        // The count is sized to the block, so it reads at the zooms that show it
+        QFont font = m_node->font();
+        font.setPointSizeF(
+            qMax(font.pointSizeF(), qMin(m_bounds.width() / 12, m_bounds.height() / 4)));
+        painter->setFont(font);
+        painter->setPen(color);
+        painter->drawText(m_bounds, Qt::AlignCenter,
+                          NodeItem::tr("%n topic(s)", nullptr, m_nodeCount));
+    }
+
+private:
+    NodeItem* m_node;
+    QRectF m_bounds;
+    int m_nodeCount;
+};
+
 // ===========================================================================
 // NodeItem
 // ===========================================================================
 
 NodeItem::NodeItem(const QString& text, QGraphicsItem* parent)
-    : QGraphicsObject(parent), m_text(text) {
+    : QGraphicsObject(parent), m_id(generateId()), m_text(text) {
     setFlags(ItemIsMovable | ItemIsSelectable | ItemSendsGeometryChanges);
     setAcceptHoverEvents(true);
     setCacheMode(DeviceCoordinateCache);
@@ -193,7 +238,13 @@ NodeItem::NodeItem(const QString& text, QGraphicsItem* parent)
     updateGeometry();
 }
 
-NodeItem::~NodeItem() = default;
+NodeItem::~NodeItem() {
+    // QGraphicsItem's destructor detaches from the scene without itemChange()
+    if (m_mindMapScene) {
+        m_mindMapScene->markContentChanged(sceneBoundingRect());
+        m_mindMapScene->unregisterNode(this);
+    }
+}
 
 QRectF NodeItem::boundingRect() const {
     constexpr qreal kShadowSpread = 10.0;
@@ -211,6 +262,7 @@ QPainterPath NodeItem::shape() const {
 
 void NodeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
                      QWidget* /*widget*/) {
+    RenderStats::Scope profile(RenderStats::NodePaint);
     painter->setRenderHint(QPainter::Antialiasing);
 
     // Resolve colors: template-specific if available, else global
@@ -257,6 +309,13 @@ void NodeItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
     painter->setBrush(bg);
     painter->drawRoundedRect(m_rect, kRadius, kRadius);
 
+    // Search matches get a dashed ring outside the body, clear of the selection border
+    if (mindMapScene && mindMapScene->isSearchMatch(this)) {
+        painter->setPen(QPen(selectionBorder, 2, Qt::DashLine));
+        painter->setBrush(Qt::NoBrush);
+        painter->drawRoundedRect(m_rect.adjusted(-4, -4, 4, 4), kRadius + 4, kRadius + 4);
+    }
+
     // Text (word-wrapped within the padded area)
     painter->setPen(textColor);
     painter->setFont(m_font);
@@ -272,6 +331,30 @@ void NodeItem::setText(const QString& text) {
     m_text = text;
     updateGeometry();
     update();
+    if (m_mindMapScene)
+        m_mindMapScene->nodeTextChanged(this);
+}
+
+quint64 NodeItem::id() const {
+    return m_id;
+}
+
+void NodeItem::setId(quint64 id) {
+    if (id == 0 || id == m_id)
+        return;
+    if (m_mindMapScene)
+        m_mindMapScene->unregisterNode(this);
+    m_id = id;
+    if (m_mindMapScene)
+        m_mindMapScene->registerNode(this);
+}
+
+quint64 NodeItem::generateId() {
+    // 64 random bits: unique across files without a central counter (0 is reserved)
+    quint64 id = 0;
+    while (id == 0)
+        id = QRandomGenerator::global()->generate64();
+    return id;
 }
 
 NodeItem* NodeItem::parentNode() const {
@@ -286,6 +369,18 @@ QList<NodeItem*> NodeItem::childNodes() const {
     return m_children;
 }
 
+int NodeItem::childCount() const {
+    return int(m_children.size());
+}
+
+NodeItem* NodeItem::childAt(int index) const {
+    return m_children.value(index);
+}
+
+int NodeItem::indexOfChild(const NodeItem* child) const {
+    return int(m_children.indexOf(child));
+}
+
 void NodeItem::addChild(NodeItem* child) {
     m_children.append(child);
     child->setParentNode(this);
@@ -349,6 +444,20 @@ MindMapScene* NodeItem::mindMapScene() const {
     return m_mindMapScene;
 }
 
+void NodeItem::setStoredChildren(const QRectF& bounds, int nodeCount) {
+    delete m_storedOverlay;
+    m_storedOverlay = new StoredBranchOverlay(this, bounds, nodeCount);
+}
+
+void NodeItem::clearStoredChildren() {
+    delete m_storedOverlay;
+    m_storedOverlay = nullptr;
+}
+
+QRectF NodeItem::storedChildBounds() const {
+    return m_storedOverlay ? m_storedOverlay->boundingRect() : QRectF();
+}
+
 void NodeItem::showAddButton() {
     if (m_mindMapScene && m_mindMapScene->isEditing())
         return;
@@ -391,12 +500,27 @@ void NodeItem::hideAddButton() {
 }
 
 QVariant NodeItem::itemChange(GraphicsItemChange change, const QVariant& value) {
-    if (change == ItemPositionHasChanged) {
+    if (change == ItemPositionChange) {
+        // Where the node was; nodeGeometryChanged reports where it went
+        if (m_mindMapScene)
+            m_mindMapScene->markContentChanged(sceneBoundingRect());
+    } else if (change == ItemPositionHasChanged) {
         for (auto* edge : m_edges) {
             edge->updatePath();
         }
+        if (m_mindMapScene)
+            m_mindMapScene->nodeGeometryChanged(this);
+    } else if (change == ItemSceneChange) {
+        if (m_mindMapScene) {
+            m_mindMapScene->markContentChanged(sceneBoundingRect());
+            m_mindMapScene->unregisterNode(this);
+        }
     } else if (change == ItemSceneHasChanged) {
         m_mindMapScene = dynamic_cast<MindMapScene*>(scene());
+        if (m_mindMapScene) {
+            m_mindMapScene->registerNode(this);
+            m_mindMapScene->nodeGeometryChanged(this);
+        }
     }
     return QGraphicsObject::itemChange(change, value);
 }
@@ -407,12 +531,12 @@ void NodeItem::mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event) {
 }
 
 void NodeItem::mousePressEvent(QGraphicsSceneMouseEvent* event) {
-    if (event->button() == Qt::LeftButton) {
-        m_dragStartPos = pos();
-        m_dragOrigPos = pos();
+    // Let QGraphicsItem update the selection first (Ctrl-click toggles)
+    QGraphicsObject::mousePressEvent(event);
+    if (event->button() == Qt::LeftButton && m_mindMapScene) {
         m_dragging = true;
+        m_mindMapScene->beginNodeDrag(this, event->screenPos());
     }
-    QGraphicsObject::mousePressEvent(event);
 }
 
 void NodeItem::mouseMoveEvent(QGraphicsSceneMouseEvent* event) {
@@ -424,27 +548,26 @@ void NodeItem::mouseMoveEvent(QGraphicsSceneMouseEvent* event) {
     }
 
     if (m_dragging) {
-        QPointF delta = pos() - m_dragStartPos;
-        m_dragStartPos = pos();
-        // Move children along with this node
-        for (auto* child : m_children) {
-            child->moveSubtree(delta);
-        }
+        // The scene moves each selected subtree once; QGraphicsItem would move
+        // every selected item, including descendants that follow their parent
+        m_mindMapScene->dragNodes(event->scenePos() - event->lastScenePos());
+        event->accept();
+        return;
     }
     QGraphicsObject::mouseMoveEvent(event);
 }
 
 void NodeItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
-    if (m_dragging && pos() != m_dragOrigPos) {
-        if (m_mindMapScene) {
-            m_mindMapScene->undoStack()->push(new MoveNodeCommand(this, m_dragOrigPos, pos()));
-        }
-    }
+    const bool dragging = m_dragging;
     m_dragging = false;
     QGraphicsObject::mouseReleaseEvent(event);
+    if (dragging && m_mindMapScene)
+        m_mindMapScene->endNodeDrag(event->scenePos(), event->screenPos());
 }
 
 void NodeItem::updateGeometry() {
+    if (m_mindMapScene)
+        m_mindMapScene->markContentChanged(sceneBoundingRect());
     prepareGeometryChange();
     QFontMetricsF fm(m_font);
     qreal textW = fm.horizontalAdvance(m_text);
@@ -462,6 +585,8 @@ void NodeItem::updateGeometry() {
     for (auto* edge : m_edges) {
         edge->updatePath();
     }
+    if (m_mindMapScene)
+        m_mindMapScene->nodeGeometryChanged(this);
 }
 
 NodeItem::ButtonDirection NodeItem::addButtonDirection() const {
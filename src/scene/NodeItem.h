@@ -8,6 +8,7 @@
 class AddButtonOverlay;
 class EdgeItem;
 class MindMapScene;
+class StoredBranchOverlay;
 class QTimer;
 class QVariantAnimation;
 
@@ -25,10 +26,19 @@ public:
     QString text() const;
     void setText(const QString& text);
 
+    // Stable identity: generated on creation, persisted in files and kept across
+    // undo/redo. Indexed by the owning MindMapScene for O(1) lookup.
+    quint64 id() const;
+    void setId(quint64 id);
+    static quint64 generateId();
+
     NodeItem* parentNode() const;
     void setParentNode(NodeItem* parent);
 
     QList<NodeItem*> childNodes() const;
+    int childCount() const;
+    NodeItem* childAt(int index) const;
+    int indexOfChild(const NodeItem* child) const;
     void addChild(NodeItem* child);
     void insertChild(int index, NodeItem* child);
     void removeChild(NodeItem* child);
@@ -43,6 +53,12 @@ public:
     QRectF nodeRect() const;
     void moveSubtree(const QPointF& delta);
 
+    // Children still stored as a chunk are drawn as one block behind the node
+    // until they are read; |bounds| is relative to the node's position
+    void setStoredChildren(const QRectF& bounds, int nodeCount);
+    void clearStoredChildren();
+    QRectF storedChildBounds() const;
+
     void showAddButton();
     void hideAddButton();
 
@@ -60,6 +76,9 @@ protected:
 
 private:
     friend class AddButtonOverlay;
+    friend class StoredBranchOverlay;
+    friend class MindMapExporter;
+    friend class MindMapScene;
 
     enum class ButtonDirection { Right, Left, Bottom };
 
@@ -69,14 +88,13 @@ private:
     void startAddButtonAnimation(bool fadeIn);
     MindMapScene* mindMapScene() const;
 
+    quint64 m_id;
     QString m_text;
     QFont m_font;
     QRectF m_rect;
     NodeItem* m_parentNode = nullptr;
     QList<NodeItem*> m_children;
     QList<EdgeItem*> m_edges;
-    QPointF m_dragStartPos;
-    QPointF m_dragOrigPos;
     bool m_dragging = false;
     bool m_hovered = false;
     MindMapScene* m_mindMapScene = nullptr;
@@ -85,6 +103,7 @@ private:
     QVariantAnimation* m_addButtonAnimation = nullptr;
     QTimer* m_hoverLeaveTimer = nullptr;
     AddButtonOverlay* m_addButtonOverlay = nullptr;
+    StoredBranchOverlay* m_storedOverlay = nullptr;
 
     static constexpr qreal kMinWidth = 120.0;
     static constexpr qreal kMaxWidth = 300.0;
@@ -0,0 +1,205 @@
+#include "scene/NodeTree.h"
+
+#include <QCoreApplication>
+#include <QPair>
+#include <QXmlStreamReader>
+
+namespace {
+
+// Calls |f| for each line of |text| without splitting it into a list
+template <typename F>
+void forEachLine(QStringView text, F&& f) {
+    qsizetype start = 0;
+    while (start < text.size()) {
+        qsizetype end = text.indexOf(u'\n', start);
+        if (end < 0)
+            end = text.size();
+        QStringView line = text.mid(start, end - start);
+        if (line.endsWith(u'\r'))
+            line.chop(1);
+        f(line);
+        start = end + 1;
+    }
+}
+
+QString defaultRootText() {
+    return QCoreApplication::translate("MindMapScene", "Central Topic");
+}
+
+// "## Title ##" -> (2, "Title"); level 0 when |line| is not an ATX heading
+QPair<int, QStringView> parseHeading(QStringView line) {
+    int level = 0;
+    while (level < line.size() && line[level] == u'#')
+        ++level;
+    if (level < 1 || level > 6 || level >= line.size() || !line[level].isSpace())
+        return {0, {}};
+
+    QStringView text = line.mid(level).trimmed();
+    // An optional closing run of '#' must be separated by a space
+    qsizetype end = text.size();
+    while (end > 0 && text[end - 1] == u'#')
+        --end;
+    if (end < text.size() && (end == 0 || text[end - 1].isSpace()))
+        text = text.left(end).trimmed();
+    return {level, text};
+}
+
+// "  - [ ] Item" -> (2, "Item"); column -1 when |line| is not a list item
+QPair<int, QStringView> parseListItem(QStringView line) {
+    int column = 0;
+    qsizetype i = 0;
+    while (i < line.size() && (line[i] == u' ' || line[i] == u'\t')) {
+        column += line[i] == u'\t' ? 4 : 1;
+        ++i;
+    }
+    const QStringView rest = line.mid(i);
+
+    qsizetype marker = 0;
+    if (!rest.isEmpty() && (rest[0] == u'-' || rest[0] == u'*' || rest[0] == u'+')) {
+        marker = 1;
+    } else {
+        while (marker < rest.size() && rest[marker].isDigit())
+            ++marker;
+        if (marker > 0 && marker < rest.size() && (rest[marker] == u'.' || rest[marker] == u')'))
+            ++marker;
+        else
+            marker = 0;
+    }
+    if (marker == 0 || marker >= rest.size() || !rest[marker].isSpace())
+        return {-1, {}};
+
+    QStringView text = rest.mid(marker).trimmed();
+    if (text.startsWith(u"[ ] ") || text.startsWith(u"[x] ") || text.startsWith(u"[X] "))
+        text = text.mid(4).trimmed();
+    return {column, text};
+}
+
+} // namespace
+
+int NodeTree::append(const QString& text, int parent) {
+    entries.append({text, parent});
+    return int(entries.size()) - 1;
+}
+
+NodeTree NodeTree::fromIndentedText(QStringView text) {
+    NodeTree tree;
+    // (indent, entry) for the current path from the root
+    QList<QPair<int, int>> stack;
+
+    forEachLine(text, [&](QStringView line) {
+        int indent = 0;
+        while (indent < line.size() && line[indent] == u'\t')
+            ++indent;
+        const QStringView nodeText = line.mid(indent).trimmed();
+        if (nodeText.isEmpty())
+            return;
+
+        if (stack.isEmpty()) {
+            stack.append({indent, tree.append(nodeText.toString(), -1)});
+            return;
+        }
+        while (stack.size() > 1 && stack.last().first >= indent)
+            stack.removeLast();
+        stack.append({indent, tree.append(nodeText.toString(), stack.last().second)});
+    });
+    return tree;
+}
+
+NodeTree NodeTree::fromMarkdown(QStringView text) {
+    NodeTree tree;
+    QList<QPair<int, int>> headings; // (heading level, entry); the root is level 0
+    QList<QPair<int, int>> items;    // (indent column, entry) under the current heading
+    bool inFence = false;
+
+    auto ensureRoot = [&]() {
+        if (tree.isEmpty())
+            headings.append({0, tree.append(defaultRootText(), -1)});
+    };
+
+    forEachLine(text, [&](QStringView line) {
+        const QStringView trimmed = line.trimmed();
+        if (trimmed.startsWith(u"```") || trimmed.startsWith(u"~~~")) {
+            inFence = !inFence;
+            return;
+        }
+        if (inFence || trimmed.isEmpty())
+            return;
+
+        const auto [level, headingText] = parseHeading(trimmed);
+        if (level > 0) {
+            if (headingText.isEmpty())
+                return;
+            items.clear();
+            if (tree.isEmpty() && level == 1) {
+                headings.append({0, tree.append(headingText.toString(), -1)});
+                return;
+            }
+            ensureRoot();
+            while (headings.size() > 1 && headings.last().first >= level)
+                headings.removeLast();
+            headings.append({level, tree.append(headingText.toString(), headings.last().second)});
+            return;
+        }
+
+        const auto [column, itemText] = parseListItem(line);
+        if (column < 0 || itemText.isEmpty())
+            return;
+        ensureRoot();
+        while (!items.isEmpty() && items.last().first >= column)
+            items.removeLast();
+        const int parent = items.isEmpty() ? headings.last().second : items.last().second;
+        items.append({column, tree.append(itemText.toString(), parent)});
+    });
+    return tree;
+}
+
+NodeTree NodeTree::fromOpml(const QByteArray& data) {
+    NodeTree tree;
+    tree.append(QString(), -1); // provisional root, named once the body is read
+
+    QXmlStreamReader xml(data);
+    QString title;
+    QList<int> open; // entries of the <outline> elements currently open
+    int topLevel = 0;
+    bool inBody = false;
+
+    while (!xml.atEnd()) {
+        switch (xml.readNext()) {
+        case QXmlStreamReader::StartElement:
+            if (!inBody && xml.name() == u"title") {
+                title = xml.readElementText().trimmed();
+            } else if (xml.name() == u"body") {
+                inBody = true;
+            } else if (inBody && xml.name() == u"outline") {
+                const auto attributes = xml.attributes();
+                QString text = attributes.value(u"text").toString();
+                if (text.isEmpty())
+                    text = attributes.value(u"title").toString();
+                if (open.isEmpty())
+                    ++topLevel;
+                open.append(tree.append(text, open.isEmpty() ? 0 : open.last()));
+            }
+            break;
+        case QXmlStreamReader::EndElement:
+            if (xml.name() == u"outline" && !open.isEmpty())
+                open.removeLast();
+            else if (xml.name() == u"body")
+                inBody = false;
+            break;
+        default:
+            break;
+        }
+    }
+    if (xml.hasError() || tree.size() == 1)
+        return {};
+
+    if (topLevel == 1) {
+        // The only top-level outline is the root; shift every parent index
+        tree.entries.removeFirst();
+        for (auto& entry : tree.entries)
+            entry.parent -= 1;
+    } else {
+        tree.entries[0].text = title.isEmpty() ? defaultRootText() : title;
+    }
+    return tree;
+}
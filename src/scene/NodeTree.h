@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QList>
+#include <QPointF>
+#include <QString>
+#include <QStringView>
+
+class QByteArray;
+
+// A node tree held as plain data: entries in pre-order, each naming its parent
+// by index (entry 0 is the root, with parent -1). Importers parse into this form
+// so that MindMapScene::buildTree can create every item in a single pass, and
+// undo keeps deleted subtrees in it instead of keeping their items alive.
+struct NodeTree {
+    struct Entry {
+        QString text;
+        int parent = -1;
+        quint64 id = 0; // 0: the node gets a fresh ID
+        QPointF pos;
+    };
+
+    QList<Entry> entries;
+
+    bool isEmpty() const { return entries.isEmpty(); }
+    int size() const { return int(entries.size()); }
+    int append(const QString& text, int parent);
+
+    // Tab-indented lines. The first line is the root; later lines that are not
+    // indented deeper than it become its children.
+    static NodeTree fromIndentedText(QStringView text);
+
+    // ATX headings nest by level and bulleted/numbered list items by indent
+    // under the heading above them. A leading "# Title" becomes the root;
+    // other text is ignored.
+    static NodeTree fromMarkdown(QStringView text);
+
+    // Nested <outline text="..."> elements in the OPML body. A single
+    // top-level outline becomes the root, otherwise the document title does.
+    static NodeTree fromOpml(const QByteArray& data);
+};
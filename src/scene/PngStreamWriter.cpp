@@ -0,0 +1,181 @@
+#include "scene/PngStreamWriter.h"
+
+#include <QIODevice>
+#include <QImage>
+
+#ifdef YMIND_QT_ZLIB
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+namespace {
+
+// zlib output buffer growth step
+constexpr int kDeflateChunk = 64 * 1024;
+
+void appendBigEndian(QByteArray& out, quint32 value) {
+    out.append(char((value >> 24) & 0xFF));
+    out.append(char((value >> 16) & 0xFF));
+    out.append(char((value >> 8) & 0xFF));
+    out.append(char(value & 0xFF));
+}
+
+int filterCost(const QByteArray& row) {
+    int cost = 0;
+    for (qsizetype i = 1; i < row.size(); ++i)
+        cost += qAbs(int(static_cast<signed char>(row[i])));
+    return cost;
+}
+
+} // namespace
+
+struct PngStreamWriter::Deflater {
+    z_stream stream{};
+
+    Deflater() = default;
+    Deflater(const Deflater&) = delete;
+    Deflater& operator=(const Deflater&) = delete;
+    ~Deflater() { deflateEnd(&stream); }
+};
+
+PngStreamWriter::PngStreamWriter(QIODevice* device) : m_device(device) {}
+
+PngStreamWriter::~PngStreamWriter() = default;
+
+bool PngStreamWriter::begin(int width, int height, bool hasAlpha) {
+    if (!m_device || width <= 0 || height <= 0)
+        return false;
+
+    m_width = width;
+    m_height = height;
+    m_bytesPerPixel = hasAlpha ? 4 : 3;
+    m_rowsWritten = 0;
+    m_ok = true;
+    m_previousRow = QByteArray(qsizetype(width) * m_bytesPerPixel, '\0');
+
+    // zlib framing (header and Adler-32 trailer) is what PNG expects in IDAT
+    m_deflater = std::make_unique<Deflater>();
+    if (deflateInit(&m_deflater->stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        m_deflater.reset();
+        return m_ok = false;
+    }
+
+    static const char kSignature[] = {char(0x89), 'P', 'N', 'G', '\r', '\n', char(0x1A), '\n'};
+    if (m_device->write(kSignature, sizeof(kSignature)) != qint64(sizeof(kSignature)))
+        return m_ok = false;
+
+    QByteArray header;
+    appendBigEndian(header, quint32(width));
+    appendBigEndian(header, quint32(height));
+    header.append(char(8)); // bit depth
+    header.append(char(hasAlpha ? 6 : 2)); // colour type: truecolour (with alpha)
+    header.append(char(0)); // compression: deflate
+    header.append(char(0)); // filter method: adaptive
+    header.append(char(0)); // no interlace
+    return writeChunk("IHDR", header);
+}
+
+bool PngStreamWriter::writeRows(const QImage& rows) {
+    const QImage::Format format =
+        m_bytesPerPixel == 4 ? QImage::Format_RGBA8888 : QImage::Format_RGB888;
+    if (!m_ok || !m_deflater || rows.format() != format || rows.width() != m_width
+        || m_rowsWritten + rows.height() > m_height)
+        return m_ok = false;
+
+    const qsizetype rowBytes = qsizetype(m_width) * m_bytesPerPixel;
+    QByteArray filtered;
+    filtered.reserve((rowBytes + 1) * rows.height());
+    for (int y = 0; y < rows.height(); ++y) {
+        const uchar* row = rows.constScanLine(y);
+        filterRow(row, filtered);
+        m_previousRow = QByteArray(reinterpret_cast<const char*>(row), rowBytes);
+    }
+    m_rowsWritten += rows.height();
+    return writeCompressed(filtered, false);
+}
+
+bool PngStreamWriter::finish() {
+    if (!m_ok || !m_deflater || m_rowsWritten != m_height)
+        return m_ok = false;
+
+    const bool ok = writeCompressed(QByteArray(), true) && writeChunk("IEND", QByteArray());
+    m_deflater.reset();
+    return ok;
+}
+
+bool PngStreamWriter::writeCompressed(const QByteArray& data, bool last) {
+    z_stream& stream = m_deflater->stream;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = uInt(data.size());
+
+    // Without a flush zlib may keep everything for later bands, in which case
+    // no chunk is written now
+    QByteArray out;
+    int status = Z_OK;
+    do {
+        const qsizetype used = out.size();
+        out.resize(used + kDeflateChunk);
+        stream.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+        stream.avail_out = uInt(kDeflateChunk);
+        status = deflate(&stream, last ? Z_FINISH : Z_NO_FLUSH);
+        if (status == Z_STREAM_ERROR)
+            return m_ok = false;
+        out.resize(out.size() - stream.avail_out);
+    } while (stream.avail_out == 0 || (last && status != Z_STREAM_END));
+
+    if (out.isEmpty())
+        return true;
+    return writeChunk("IDAT", out);
+}
+
+bool PngStreamWriter::writeChunk(const char* type, const QByteArray& data) {
+    QByteArray chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian(chunk, quint32(data.size()));
+    chunk.append(type, 4);
+    chunk.append(data);
+    // The CRC covers the type and the data, not the length
+    const uLong crc = crc32(crc32(0L, Z_NULL, 0),
+                            reinterpret_cast<const Bytef*>(chunk.constData() + 4),
+                            uInt(chunk.size() - 4));
+    appendBigEndian(chunk, quint32(crc));
+
+    if (m_device->write(chunk) != chunk.size())
+        m_ok = false;
+    return m_ok;
+}
+
+void PngStreamWriter::filterRow(const uchar* row, QByteArray& out) {
+    const qsizetype rowBytes = qsizetype(m_width) * m_bytesPerPixel;
+    const int bpp = m_bytesPerPixel;
+    const auto* up = reinterpret_cast<const uchar*>(m_previousRow.constData());
+
+    // Try None, Sub and Up and keep whichever has the smallest sum of
+    // absolute residuals (the usual heuristic from the PNG spec)
+    for (int f = 0; f < 3; ++f) {
+        QByteArray& candidate = m_filterScratch[f];
+        candidate.resize(rowBytes + 1);
+        candidate[0] = char(f);
+    }
+    char* none = m_filterScratch[0].data() + 1;
+    char* sub = m_filterScratch[1].data() + 1;
+    char* upFiltered = m_filterScratch[2].data() + 1;
+    for (qsizetype i = 0; i < rowBytes; ++i) {
+        const uchar left = i >= bpp ? row[i - bpp] : 0;
+        none[i] = char(row[i]);
+        sub[i] = char(uchar(row[i] - left));
+        upFiltered[i] = char(uchar(row[i] - up[i]));
+    }
+
+    int best = 0;
+    int bestCost = filterCost(m_filterScratch[0]);
+    for (int f = 1; f < 3; ++f) {
+        const int cost = filterCost(m_filterScratch[f]);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = f;
+        }
+    }
+    out.append(m_filterScratch[best]);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QByteArray>
+
+#include <memory>
+
+class QIODevice;
+class QImage;
+
+// Writes an 8-bit RGB or RGBA PNG to a device band by band, so an exporter never holds
+// the whole image in memory. Each row gets the cheapest of the None/Sub/Up
+// filters; the rows are compressed by one zlib stream that stays open across
+// bands, and every band's output goes out as its own IDAT chunk. Bands must be
+// written top to bottom.
+class PngStreamWriter {
+public:
+    explicit PngStreamWriter(QIODevice* device);
+    ~PngStreamWriter();
+
+    bool begin(int width, int height, bool hasAlpha = false);
+    // |rows| must be Format_RGB888 (Format_RGBA8888 with alpha) and exactly as
+    // wide as the image
+    bool writeRows(const QImage& rows);
+    bool finish();
+
+    int rowsWritten() const { return m_rowsWritten; }
+
+private:
+    struct Deflater;
+
+    bool writeChunk(const char* type, const QByteArray& data);
+    void filterRow(const uchar* row, QByteArray& out);
+    // Feeds |data| to the zlib stream and writes what comes out as IDAT
+    bool writeCompressed(const QByteArray& data, bool last);
+
+    QIODevice* m_device;
+    int m_width = 0;
+    int m_height = 0;
+    int m_bytesPerPixel = 3;
+    int m_rowsWritten = 0;
+    bool m_ok = true;
+
+    QByteArray m_previousRow;
+    QByteArray m_filterScratch[3];
+    std::unique_ptr<Deflater> m_deflater;
+};
@@ -0,0 +1,75 @@
+#include "scene/RenderStats.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+namespace {
+bool s_enabled = false;
+QElapsedTimer s_clock;
+RenderStats::Frame s_frame;
+
+bool isProfiledThread() {
+    return QCoreApplication::instance()
+           && QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+} // namespace
+
+qreal RenderStats::Frame::nodeCacheHitRate() const {
+    if (visibleNodes <= 0)
+        return 1.0;
+    return qBound(0.0, 1.0 - qreal(calls[NodePaint]) / visibleNodes, 1.0);
+}
+
+RenderStats::Scope::Scope(Section section) : m_section(section) {
+    if (s_enabled && isProfiledThread())
+        m_start = s_clock.nsecsElapsed();
+}
+
+RenderStats::Scope::~Scope() {
+    if (m_start < 0 || !s_enabled)
+        return;
+    ++s_frame.calls[m_section];
+    s_frame.nsecs[m_section] += s_clock.nsecsElapsed() - m_start;
+}
+
+bool RenderStats::isEnabled() {
+    return s_enabled;
+}
+
+void RenderStats::setEnabled(bool enabled) {
+    if (enabled && !s_enabled)
+        s_clock.start();
+    s_enabled = enabled;
+    s_frame = Frame();
+}
+
+void RenderStats::beginFrame() {
+    // Work done between frames (exports, minimap renders) is not attributed
+    s_frame = Frame();
+}
+
+RenderStats::Frame RenderStats::endFrame(qint64 frameNsecs, int visibleNodes) {
+    Frame frame = s_frame;
+    frame.timestampMs = s_clock.isValid() ? s_clock.elapsed() : 0;
+    frame.frameNsecs = frameNsecs;
+    frame.visibleNodes = visibleNodes;
+    s_frame = Frame();
+    return frame;
+}
+
+QString RenderStats::sectionName(Section section) {
+    switch (section) {
+    case NodePaint:
+        return QStringLiteral("node_paint");
+    case EdgePaint:
+        return QStringLiteral("edge_paint");
+    case Background:
+        return QStringLiteral("background");
+    case EdgeUpdate:
+        return QStringLiteral("update_path");
+    case SectionCount:
+        break;
+    }
+    return QString();
+}
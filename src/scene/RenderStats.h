@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+
+// Paint profiling for the performance overlay. While enabled, NodeItem,
+// EdgeItem and MindMapView time their painting into the current frame, which
+// MindMapView closes after each paint event. Disabled, every hook is a single
+// flag check. Only the GUI thread is counted; exporters painting on worker
+// threads are ignored.
+class RenderStats {
+public:
+    enum Section { NodePaint, EdgePaint, Background, EdgeUpdate, SectionCount };
+
+    struct Frame {
+        qint64 timestampMs = 0; // since profiling was enabled
+        qint64 frameNsecs = 0;  // whole paint event
+        int visibleNodes = 0;   // nodes intersecting the exposed region
+        int calls[SectionCount] = {};
+        qint64 nsecs[SectionCount] = {};
+
+        // Share of visible nodes drawn from their DeviceCoordinateCache pixmap
+        // rather than through NodeItem::paint
+        qreal nodeCacheHitRate() const;
+    };
+
+    // Times the enclosing block into |section| of the current frame
+    class Scope {
+    public:
+        explicit Scope(Section section);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Section m_section;
+        qint64 m_start = -1; // -1 when not profiling
+    };
+
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    static void beginFrame();
+    static Frame endFrame(qint64 frameNsecs, int visibleNodes);
+
+    static QString sectionName(Section section);
+};
+
+Q_DECLARE_METATYPE(RenderStats::Frame)
@@ -0,0 +1,118 @@
+#include "scene/SearchIndex.h"
+
+#include <algorithm>
+
+namespace {
+
+// Scripts written without spaces between words
+bool isIdeographic(QChar c) {
+    switch (c.script()) {
+    case QChar::Script_Han:
+    case QChar::Script_Hiragana:
+    case QChar::Script_Katakana:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+QString SearchIndex::fold(QStringView text) {
+    // Compatibility decomposition splits "é" into "e" plus a combining accent
+    // (and "ﬁ" into "fi"); dropping the marks leaves the base letters
+    const QString decomposed = text.toString().normalized(QString::NormalizationForm_KD);
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (QChar c : decomposed) {
+        if (c.category() != QChar::Mark_NonSpacing)
+            folded.append(c);
+    }
+    return folded.toCaseFolded();
+}
+
+QStringList SearchIndex::tokenize(QStringView text) {
+    const QString folded = fold(text);
+    QStringList tokens;
+    qsizetype start = -1;
+    auto flush = [&](qsizetype end) {
+        if (start >= 0)
+            tokens.append(folded.mid(start, end - start));
+        start = -1;
+    };
+    for (qsizetype i = 0; i < folded.size(); ++i) {
+        const QChar c = folded[i];
+        if (isIdeographic(c)) {
+            flush(i);
+            tokens.append(QString(c));
+        } else if (c.isLetterOrNumber() || c.isSurrogate()) {
+            if (start < 0)
+                start = i;
+        } else {
+            flush(i);
+        }
+    }
+    flush(folded.size());
+    tokens.removeDuplicates();
+    return tokens;
+}
+
+void SearchIndex::clear() {
+    m_postings.clear();
+    m_nodeTokens.clear();
+}
+
+void SearchIndex::addNode(quint64 id, QStringView text) {
+    removeNode(id);
+    const QStringList tokens = tokenize(text);
+    for (const auto& token : tokens)
+        m_postings[token].insert(id);
+    m_nodeTokens.insert(id, tokens);
+}
+
+void SearchIndex::removeNode(quint64 id) {
+    const auto it = m_nodeTokens.constFind(id);
+    if (it == m_nodeTokens.cend())
+        return;
+    for (const auto& token : it.value()) {
+        auto posting = m_postings.find(token);
+        if (posting == m_postings.end())
+            continue;
+        posting->remove(id);
+        if (posting->isEmpty())
+            m_postings.erase(posting);
+    }
+    m_nodeTokens.erase(it);
+}
+
+QSet<quint64> SearchIndex::nodesWithPrefix(const QString& prefix) const {
+    QSet<quint64> nodes;
+    for (auto it = m_postings.lowerBound(prefix);
+         it != m_postings.cend() && it.key().startsWith(prefix); ++it) {
+        nodes.unite(it.value());
+    }
+    return nodes;
+}
+
+QList<quint64> SearchIndex::find(QStringView query) const {
+    QStringList tokens = tokenize(query);
+    if (tokens.isEmpty())
+        return {};
+
+    // Longer tokens tend to match fewer nodes; start from those and stop as
+    // soon as the intersection is empty
+    std::sort(tokens.begin(), tokens.end(),
+              [](const QString& a, const QString& b) { return a.size() > b.size(); });
+    QSet<quint64> result = nodesWithPrefix(tokens.first());
+    for (qsizetype i = 1; i < tokens.size() && !result.isEmpty(); ++i)
+        result.intersect(nodesWithPrefix(tokens[i]));
+    return result.values();
+}
+
+int SearchIndex::nodeCount() const {
+    return int(m_nodeTokens.size());
+}
+
+int SearchIndex::tokenCount() const {
+    return int(m_postings.size());
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+// Inverted index of node text for find-as-you-type. Text is folded (case and
+// diacritics: "Café" and "cafe" match) and split into word tokens; Han and kana
+// characters are one token each, since those scripts do not separate words.
+// Postings are kept in a sorted map, so a query token matches every indexed
+// token it is a prefix of. Updates are per node and cheap, so MindMapScene keeps
+// the index current as nodes are added, removed and renamed.
+class SearchIndex {
+public:
+    static QString fold(QStringView text);
+    static QStringList tokenize(QStringView text);
+
+    void clear();
+    // Adding a node that is already indexed replaces its text
+    void addNode(quint64 id, QStringView text);
+    void removeNode(quint64 id);
+
+    // Nodes whose text has, for every token of |query|, a token starting with
+    // it. Unordered; empty for a query without tokens.
+    QList<quint64> find(QStringView query) const;
+
+    int nodeCount() const;
+    int tokenCount() const;
+
+private:
+    QSet<quint64> nodesWithPrefix(const QString& prefix) const;
+
+    QMap<QString, QSet<quint64>> m_postings;
+    QHash<quint64, QStringList> m_nodeTokens;
+};
@@ -109,6 +109,12 @@ QIcon IconFactory::makeToolIcon(const QString& name) {
     } else if (name == "close-panel") {
         p.drawLine(10, 10, 22, 22);
         p.drawLine(22, 10, 10, 22);
+    } else if (name == "find-previous") {
+        p.drawLine(9, 20, 16, 12);
+        p.drawLine(16, 12, 23, 20);
+    } else if (name == "find-next") {
+        p.drawLine(9, 12, 16, 20);
+        p.drawLine(16, 20, 23, 12);
     }
 
     p.end();
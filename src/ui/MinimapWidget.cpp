@@ -0,0 +1,238 @@
+#include "ui/MinimapWidget.h"
+#include "core/AppSettings.h"
+#include "core/TemplateDescriptor.h"
+#include "scene/MindMapScene.h"
+#include "scene/MindMapView.h"
+#include "ui/ThemeManager.h"
+
+#include <QEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTimer>
+
+#include <algorithm>
+#include <utility>
+
+MinimapWidget::MinimapWidget(MindMapView* view) : QWidget(view), m_view(view) {
+    setObjectName("minimap");
+    setFixedSize(kWidth, kHeight);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setCursor(Qt::PointingHandCursor);
+
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(kUpdateIntervalMs);
+    connect(m_updateTimer, &QTimer::timeout, this, &MinimapWidget::flushUpdates);
+
+    m_scene = qobject_cast<MindMapScene*>(view->scene());
+    if (m_scene) {
+        connect(m_scene, &MindMapScene::contentChanged, this, &MinimapWidget::onSceneChanged);
+        connect(m_scene, &MindMapScene::treeReset, this, [this]() {
+            m_needsFullRender = true;
+            m_dirty.clear();
+            if (isVisible())
+                m_updateTimer->start();
+        });
+    }
+
+    // The viewport frame follows scrolling and zooming without touching the image
+    for (auto* bar : {view->horizontalScrollBar(), view->verticalScrollBar()}) {
+        connect(bar, &QScrollBar::valueChanged, this, qOverload<>(&QWidget::update));
+        connect(bar, &QScrollBar::rangeChanged, this, qOverload<>(&QWidget::update));
+    }
+    view->installEventFilter(this);
+    view->viewport()->installEventFilter(this);
+    updatePlacement();
+
+    setVisible(AppSettings::instance().showMinimap());
+    connect(&AppSettings::instance(), &AppSettings::showMinimapChanged, this,
+            &QWidget::setVisible);
+}
+
+QImage MinimapWidget::image() const {
+    return m_image;
+}
+
+QRectF MinimapWidget::mapRect() const {
+    return m_mapRect;
+}
+
+int MinimapWidget::fullRenderCount() const {
+    return m_fullRenders;
+}
+
+int MinimapWidget::partialRenderCount() const {
+    return m_partialRenders;
+}
+
+QPointF MinimapWidget::widgetToScene(const QPointF& pos) const {
+    return m_mapRect.topLeft() + (pos - m_offset) / m_scale;
+}
+
+QPointF MinimapWidget::sceneToWidget(const QPointF& pos) const {
+    return m_offset + (pos - m_mapRect.topLeft()) * m_scale;
+}
+
+// --- Updates ---
+
+void MinimapWidget::onSceneChanged(const QRectF& sceneRect) {
+    m_dirty.append(sceneRect);
+    if (m_dirty.size() > kMaxDirtyRects) {
+        QRectF united;
+        for (const auto& rect : std::as_const(m_dirty))
+            united |= rect;
+        m_dirty = {united};
+    }
+    // While hidden, changes are only collected; showing the map flushes them
+    if (isVisible() && !m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
+void MinimapWidget::flushUpdates() {
+    m_updateTimer->stop();
+    if (!m_scene)
+        return;
+    const QList<QRectF> dirty = std::exchange(m_dirty, {});
+
+    // Start over when a change lands outside the image or the map shrinks to a
+    // corner of it; otherwise only the changed regions are drawn again. The
+    // scene's tracked bounds stand in for a walk over every item on each flush.
+    const bool outgrown = std::any_of(dirty.cbegin(), dirty.cend(), [this](const QRectF& rect) {
+        return !m_mapRect.contains(rect);
+    });
+    const QRectF bounds = m_scene->contentBounds();
+    const qreal mapArea = m_mapRect.width() * m_mapRect.height();
+    if (m_needsFullRender || outgrown || bounds.width() * bounds.height() < mapArea / 4
+        || background() != m_imageBackground
+        || m_image.devicePixelRatio() != devicePixelRatioF()) {
+        renderFull();
+    } else {
+        for (const auto& rect : dirty)
+            renderRegion(rect);
+    }
+    update();
+}
+
+void MinimapWidget::renderFull() {
+    m_needsFullRender = false;
+    const QRectF bounds = m_scene->itemsBoundingRect();
+    // Leave room around the map so nodes added near the edge stay incremental
+    const qreal pad = qMax(bounds.width(), bounds.height()) * 0.1 + 40.0;
+    m_mapRect = bounds.adjusted(-pad, -pad, pad, pad);
+    m_scale = qMin(width() / m_mapRect.width(), height() / m_mapRect.height());
+    m_offset = QPointF((width() - m_mapRect.width() * m_scale) / 2,
+                       (height() - m_mapRect.height() * m_scale) / 2);
+
+    const qreal pixelRatio = devicePixelRatioF();
+    m_image = QImage(size() * pixelRatio, QImage::Format_ARGB32_Premultiplied);
+    m_image.setDevicePixelRatio(pixelRatio);
+    m_imageBackground = background();
+    m_image.fill(m_imageBackground);
+
+    QPainter painter(&m_image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    m_scene->render(&painter, QRectF(m_offset, m_mapRect.size() * m_scale), m_mapRect,
+                    Qt::IgnoreAspectRatio);
+    ++m_fullRenders;
+}
+
+void MinimapWidget::renderRegion(const QRectF& sceneRect) {
+    const QRectF target(sceneToWidget(sceneRect.topLeft()), sceneRect.size() * m_scale);
+
+    // Snap the patch to whole device pixels so it lines up with the rest
+    const qreal pixelRatio = m_image.devicePixelRatio();
+    const QRect pixels = QRectF(target.topLeft() * pixelRatio, target.size() * pixelRatio)
+                             .toAlignedRect()
+                             .adjusted(-1, -1, 1, 1)
+                             .intersected(m_image.rect());
+    if (pixels.isEmpty())
+        return;
+    const QRectF patch(QPointF(pixels.topLeft()) / pixelRatio, QSizeF(pixels.size()) / pixelRatio);
+    const QRectF source(widgetToScene(patch.topLeft()), patch.size() / m_scale);
+
+    QPainter painter(&m_image);
+    painter.setClipRect(patch);
+    painter.fillRect(patch, m_imageBackground);
+    painter.setRenderHint(QPainter::Antialiasing);
+    m_scene->render(&painter, patch, source, Qt::IgnoreAspectRatio);
+    ++m_partialRenders;
+}
+
+QColor MinimapWidget::background() const {
+    if (m_scene) {
+        if (const auto* td = m_scene->templateDescriptor())
+            return td->activeColors().canvasBackground;
+    }
+    return ThemeManager::colors().canvasBackground;
+}
+
+// --- Placement and painting ---
+
+void MinimapWidget::updatePlacement() {
+    if (!m_view)
+        return;
+    const QRect area = m_view->viewport()->geometry();
+    move(area.right() + 1 - kMargin - width(), area.bottom() + 1 - kMargin - height());
+    raise();
+}
+
+bool MinimapWidget::eventFilter(QObject* watched, QEvent* event) {
+    if (m_view && event->type() == QEvent::Resize) {
+        if (watched == m_view || watched == m_view->viewport()) {
+            updatePlacement();
+            update();
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void MinimapWidget::paintEvent(QPaintEvent* /*event*/) {
+    if (m_needsFullRender || !m_dirty.isEmpty() || background() != m_imageBackground) {
+        if (!m_updateTimer->isActive())
+            m_updateTimer->start();
+    }
+
+    QPainter painter(this);
+    painter.fillRect(rect(), m_image.isNull() ? background() : m_imageBackground);
+    painter.drawImage(0, 0, m_image);
+
+    const ThemeColors& colors = ThemeManager::colors();
+    painter.setRenderHint(QPainter::Antialiasing);
+    if (m_view && !m_image.isNull()) {
+        const QRectF visible = m_view->mapToScene(m_view->viewport()->rect()).boundingRect();
+        const QRectF frame(sceneToWidget(visible.topLeft()), visible.size() * m_scale);
+        QColor fill = colors.nodeSelectionBorder;
+        fill.setAlpha(40);
+        painter.setPen(QPen(colors.nodeSelectionBorder, 1.5));
+        painter.setBrush(fill);
+        painter.drawRect(frame.intersected(QRectF(rect()).adjusted(1, 1, -1, -1)));
+    }
+
+    painter.setPen(QPen(colors.previewNodeBorder, 1));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(QRectF(rect()).adjusted(0.5, 0.5, -0.5, -0.5));
+}
+
+void MinimapWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    panTo(event->position());
+    event->accept();
+}
+
+void MinimapWidget::mouseMoveEvent(QMouseEvent* event) {
+    if (!(event->buttons() & Qt::LeftButton)) {
+        QWidget::mouseMoveEvent(event);
+        return;
+    }
+    panTo(event->position());
+    event->accept();
+}
+
+void MinimapWidget::panTo(const QPointF& widgetPos) {
+    if (m_view && !m_image.isNull())
+        m_view->centerOn(widgetToScene(widgetPos));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QImage>
+#include <QList>
+#include <QPointer>
+#include <QRectF>
+#include <QWidget>
+
+class MindMapScene;
+class MindMapView;
+class QTimer;
+
+// Overview of the whole map in the bottom-right corner of a MindMapView. The
+// map is kept as a low-resolution image: scene changes only re-render the
+// regions they touch, batched on a timer, and the image is rebuilt from scratch
+// only when the map outgrows it, the tree is reset or the background changes.
+// Changes come from MindMapScene::contentChanged, not QGraphicsScene::changed,
+// so the views keep their direct item updates. Clicking or dragging centers
+// the view on that point.
+class MinimapWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    static constexpr int kWidth = 200;
+    static constexpr int kHeight = 140;
+    static constexpr int kMargin = 12;
+    // Scene changes are collected for this long before the image is patched
+    static constexpr int kUpdateIntervalMs = 100;
+    // Dirty regions beyond this count are merged into their bounding rect
+    static constexpr int kMaxDirtyRects = 32;
+
+    explicit MinimapWidget(MindMapView* view);
+
+    // Rendered overview in widget coordinates (exposed for tests)
+    QImage image() const;
+    QRectF mapRect() const;
+    int fullRenderCount() const;
+    int partialRenderCount() const;
+
+    QPointF widgetToScene(const QPointF& pos) const;
+    QPointF sceneToWidget(const QPointF& pos) const;
+
+public slots:
+    void flushUpdates();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+private:
+    void onSceneChanged(const QRectF& sceneRect);
+    void updatePlacement();
+    void renderFull();
+    void renderRegion(const QRectF& sceneRect);
+    void panTo(const QPointF& widgetPos);
+    QColor background() const;
+
+    QPointer<MindMapView> m_view;
+    QPointer<MindMapScene> m_scene;
+    QTimer* m_updateTimer;
+
+    QImage m_image;
+    QRectF m_mapRect; // scene area covered by m_image
+    QColor m_imageBackground;
+    qreal m_scale = 1.0;
+    QPointF m_offset; // widget position of m_mapRect.topLeft()
+    QList<QRectF> m_dirty;
+    bool m_needsFullRender = true;
+    int m_fullRenders = 0;
+    int m_partialRenders = 0;
+};
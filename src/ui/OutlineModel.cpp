@@ -0,0 +1,332 @@
+#include "ui/OutlineModel.h"
+#include "scene/MindMapScene.h"
+#include "scene/NodeItem.h"
+#include "ui/ThemeManager.h"
+
+#include <QBrush>
+
+#include <utility>
+
+OutlineModel::OutlineModel(QObject* parent) : QAbstractItemModel(parent) {}
+
+MindMapScene* OutlineModel::scene() const {
+    return m_scene;
+}
+
+void OutlineModel::setScene(MindMapScene* scene) {
+    if (m_scene == scene)
+        return;
+
+    beginResetModel();
+    if (m_scene)
+        disconnect(m_scene, nullptr, this, nullptr);
+    m_scene = scene;
+    m_searchMatches.clear();
+    clearCaches();
+    if (m_scene) {
+        m_searchMatches = m_scene->searchMatches();
+        connect(m_scene, &MindMapScene::treeAboutToBeReset, this, [this]() {
+            beginResetModel();
+            clearCaches();
+        });
+        connect(m_scene, &MindMapScene::treeReset, this, &OutlineModel::endResetModel);
+        connect(m_scene, &MindMapScene::nodeAboutToBeInserted, this,
+                &OutlineModel::onAboutToBeInserted);
+        connect(m_scene, &MindMapScene::nodeInserted, this, &OutlineModel::onChangeDone);
+        connect(m_scene, &MindMapScene::nodeAboutToBeRemoved, this,
+                &OutlineModel::onAboutToBeRemoved);
+        connect(m_scene, &MindMapScene::nodeRemoved, this, &OutlineModel::onChangeDone);
+        connect(m_scene, &MindMapScene::nodeAboutToBeMoved, this,
+                &OutlineModel::onAboutToBeMoved);
+        connect(m_scene, &MindMapScene::nodeMoved, this, &OutlineModel::onChangeDone);
+        connect(m_scene, &MindMapScene::nodeRenamed, this, &OutlineModel::onRenamed);
+        connect(m_scene, &MindMapScene::searchMatchesChanged, this,
+                &OutlineModel::onSearchMatchesChanged);
+        connect(m_scene, &QObject::destroyed, this, [this]() {
+            beginResetModel();
+            m_searchMatches.clear();
+            clearCaches();
+            endResetModel();
+        });
+    }
+    endResetModel();
+}
+
+NodeItem* OutlineModel::nodeForIndex(const QModelIndex& index) const {
+    // An ID that no longer resolves (the node was removed) yields nullptr rather
+    // than a dangling pointer
+    if (!index.isValid() || !m_scene || index.model() != this)
+        return nullptr;
+    return m_scene->nodeById(quint64(index.internalId()));
+}
+
+QModelIndex OutlineModel::indexForNode(const NodeItem* node) const {
+    if (!node || !m_scene)
+        return {};
+    NodeItem* parent = node->parentNode();
+    if (!parent) {
+        return node == m_scene->rootNode() ? createIndex(0, 0, quintptr(node->id()))
+                                           : QModelIndex();
+    }
+    // Rows under a branch the view has not fetched do not exist yet
+    if (!m_fetched.contains(parent->id()))
+        return {};
+    const int row = rowOf(node, parent);
+    return row < 0 ? QModelIndex() : createIndex(row, 0, quintptr(node->id()));
+}
+
+QModelIndex OutlineModel::revealNode(const NodeItem* node) {
+    if (!node || !m_scene)
+        return {};
+    QList<NodeItem*> ancestors;
+    for (NodeItem* parent = node->parentNode(); parent; parent = parent->parentNode())
+        ancestors.prepend(parent);
+    for (NodeItem* ancestor : std::as_const(ancestors)) {
+        const QModelIndex index = indexForNode(ancestor);
+        if (canFetchMore(index))
+            fetchMore(index);
+    }
+    return indexForNode(node);
+}
+
+bool OutlineModel::isFetched(const NodeItem* node) const {
+    return node && m_fetched.contains(node->id());
+}
+
+int OutlineModel::rowOf(const NodeItem* node, const NodeItem* parent) const {
+    const auto cached = m_rows.constFind(node->id());
+    if (cached != m_rows.cend() && parent->childAt(cached.value()) == node)
+        return cached.value();
+
+    // Inserts, removals and moves shift every later sibling, so refill the whole
+    // list once instead of searching it per lookup
+    int found = -1;
+    for (int row = 0, count = parent->childCount(); row < count; ++row) {
+        const NodeItem* child = parent->childAt(row);
+        m_rows.insert(child->id(), row);
+        if (child == node)
+            found = row;
+    }
+    if (found < 0)
+        m_rows.remove(node->id());
+    return found;
+}
+
+void OutlineModel::clearCaches() {
+    m_rows.clear();
+    m_fetched.clear();
+}
+
+// --- QAbstractItemModel ---
+
+QModelIndex OutlineModel::index(int row, int column, const QModelIndex& parent) const {
+    if (!m_scene || column != 0 || row < 0)
+        return {};
+    if (!parent.isValid()) {
+        NodeItem* root = m_scene->rootNode();
+        return row == 0 && root ? createIndex(0, 0, quintptr(root->id())) : QModelIndex();
+    }
+    NodeItem* node = nodeForIndex(parent);
+    NodeItem* child = node ? node->childAt(row) : nullptr;
+    if (!child)
+        return {};
+    m_rows.insert(child->id(), row);
+    return createIndex(row, 0, quintptr(child->id()));
+}
+
+QModelIndex OutlineModel::parent(const QModelIndex& child) const {
+    NodeItem* node = nodeForIndex(child);
+    return node ? indexForNode(node->parentNode()) : QModelIndex();
+}
+
+int OutlineModel::rowCount(const QModelIndex& parent) const {
+    if (!m_scene || parent.column() > 0)
+        return 0;
+    if (!parent.isValid())
+        return m_scene->rootNode() ? 1 : 0;
+    NodeItem* node = nodeForIndex(parent);
+    return isFetched(node) ? node->childCount() : 0;
+}
+
+int OutlineModel::columnCount(const QModelIndex& /*parent*/) const {
+    return 1;
+}
+
+bool OutlineModel::hasChildren(const QModelIndex& parent) const {
+    if (!m_scene || parent.column() > 0)
+        return false;
+    if (!parent.isValid())
+        return m_scene->rootNode() != nullptr;
+    // Unfetched branches still show an expand arrow
+    NodeItem* node = nodeForIndex(parent);
+    return node && (node->childCount() > 0 || m_scene->isChunkPending(node));
+}
+
+bool OutlineModel::canFetchMore(const QModelIndex& parent) const {
+    NodeItem* node = nodeForIndex(parent);
+    return node && !isFetched(node) && hasChildren(parent);
+}
+
+void OutlineModel::fetchMore(const QModelIndex& parent) {
+    NodeItem* node = nodeForIndex(parent);
+    if (!node || isFetched(node))
+        return;
+    // Reading a file chunk inserts its children one by one; the first of them
+    // marks an empty branch fetched (see onAboutToBeInserted), so this may
+    // already be done when it returns
+    m_scene->ensureChildrenLoaded(node);
+    if (isFetched(node))
+        return;
+    const int count = node->childCount();
+    if (count == 0) {
+        m_fetched.insert(node->id());
+        return;
+    }
+    beginInsertRows(parent, 0, count - 1);
+    m_fetched.insert(node->id());
+    endInsertRows();
+}
+
+QVariant OutlineModel::data(const QModelIndex& index, int role) const {
+    NodeItem* node = nodeForIndex(index);
+    if (!node)
+        return {};
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        return node->text();
+    case NodeIdRole:
+        return QVariant::fromValue(node->id());
+    case Qt::BackgroundRole:
+        if (m_searchMatches.contains(node->id())) {
+            QColor tint = ThemeManager::colors().nodeSelectionBorder;
+            tint.setAlpha(60);
+            return QBrush(tint);
+        }
+        return {};
+    default:
+        return {};
+    }
+}
+
+Qt::ItemFlags OutlineModel::flags(const QModelIndex& index) const {
+    return index.isValid() ? Qt::ItemIsEnabled | Qt::ItemIsSelectable : Qt::NoItemFlags;
+}
+
+// --- Scene changes ---
+
+bool OutlineModel::acceptsRows(NodeItem* parent) {
+    if (isFetched(parent))
+        return true;
+    // A visible branch without children has nothing to defer, so it is fetched
+    // as soon as it gains one and the view learns it can be expanded
+    const bool visible = !parent->parentNode() || isFetched(parent->parentNode());
+    if (!visible || parent->childCount() > 0)
+        return false;
+    m_fetched.insert(parent->id());
+    return true;
+}
+
+void OutlineModel::forgetFetched(const NodeItem* node) {
+    if (!isFetched(node))
+        return;
+    QList<const NodeItem*> pending{node};
+    while (!pending.isEmpty()) {
+        const NodeItem* current = pending.takeLast();
+        if (!m_fetched.remove(current->id()))
+            continue;
+        for (int row = 0, count = current->childCount(); row < count; ++row)
+            pending.append(current->childAt(row));
+    }
+}
+
+void OutlineModel::onAboutToBeInserted(NodeItem* parent, int row) {
+    if (!acceptsRows(parent))
+        return;
+    m_pending = PendingChange::Insert;
+    beginInsertRows(indexForNode(parent), row, row);
+}
+
+void OutlineModel::onAboutToBeRemoved(NodeItem* parent, int row) {
+    if (!isFetched(parent))
+        return;
+    m_pending = PendingChange::Remove;
+    m_pendingNode = parent->childAt(row);
+    beginRemoveRows(indexForNode(parent), row, row);
+}
+
+void OutlineModel::onAboutToBeMoved(NodeItem* node, NodeItem* newParent, int newRow) {
+    const QModelIndex source = indexForNode(node);
+    const bool toVisible = newParent != node->parentNode() ? acceptsRows(newParent)
+                                                           : source.isValid();
+
+    if (!source.isValid()) {
+        // From an unfetched branch: nothing to move, maybe a row to add
+        if (toVisible) {
+            m_pending = PendingChange::Insert;
+            beginInsertRows(indexForNode(newParent), newRow, newRow);
+        }
+        return;
+    }
+    if (!toVisible) {
+        // Into an unfetched branch: the row goes, and its subtree is forgotten
+        m_pending = PendingChange::Remove;
+        m_pendingNode = node;
+        beginRemoveRows(source.parent(), source.row(), source.row());
+        return;
+    }
+
+    // beginMoveRows counts the destination row before the node leaves its place
+    int destRow = newRow;
+    if (node->parentNode() == newParent && newRow >= source.row())
+        ++destRow;
+    if (beginMoveRows(source.parent(), source.row(), source.row(), indexForNode(newParent),
+                      destRow)) {
+        m_pending = PendingChange::Move;
+    } else {
+        m_pending = PendingChange::Relayout;
+        emit layoutAboutToBeChanged();
+    }
+}
+
+void OutlineModel::onChangeDone() {
+    const PendingChange change = std::exchange(m_pending, PendingChange::None);
+    switch (change) {
+    case PendingChange::None:
+        break;
+    case PendingChange::Insert:
+        endInsertRows();
+        break;
+    case PendingChange::Remove:
+        endRemoveRows();
+        // Only now, so the removal could still resolve indexes inside the subtree
+        forgetFetched(std::exchange(m_pendingNode, nullptr));
+        break;
+    case PendingChange::Move:
+        endMoveRows();
+        break;
+    case PendingChange::Relayout:
+        emit layoutChanged();
+        break;
+    }
+}
+
+void OutlineModel::onRenamed(NodeItem* node) {
+    const QModelIndex index = indexForNode(node);
+    if (index.isValid())
+        emit dataChanged(index, index, {Qt::DisplayRole, Qt::ToolTipRole});
+}
+
+void OutlineModel::onSearchMatchesChanged() {
+    // Only rows that gained or lost the highlight change
+    const QSet<quint64> matches = m_scene->searchMatches();
+    QSet<quint64> changed = matches;
+    changed.unite(m_searchMatches);
+    changed.subtract(QSet<quint64>(matches).intersect(m_searchMatches));
+    m_searchMatches = matches;
+    for (quint64 id : std::as_const(changed)) {
+        const QModelIndex index = indexForNode(m_scene->nodeById(id));
+        if (index.isValid())
+            emit dataChanged(index, index, {Qt::BackgroundRole});
+    }
+}
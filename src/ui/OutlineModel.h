@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+
+class MindMapScene;
+class NodeItem;
+
+// Single-column tree model over a MindMapScene's node tree, for the outline
+// panel. It holds no copy of the tree: rows are read from the nodes, and the
+// scene's fine-grained change signals become row inserts, removals, moves and
+// dataChanged, so an edit touches one row and views keep their expansion state.
+// Children are exposed on demand (canFetchMore/fetchMore), so a loaded map only
+// costs the branches a view has opened; changes under unopened branches are
+// ignored until then.
+class OutlineModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    enum Role {
+        NodeIdRole = Qt::UserRole,
+    };
+
+    explicit OutlineModel(QObject* parent = nullptr);
+
+    MindMapScene* scene() const;
+    void setScene(MindMapScene* scene);
+
+    // Both directions are constant time: an index carries its node's ID, which is
+    // looked up (and so validated) in the scene's node index, and rows come from a
+    // cache that refills a sibling list the first time one of its rows is stale.
+    NodeItem* nodeForIndex(const QModelIndex& index) const;
+    QModelIndex indexForNode(const NodeItem* node) const;
+    // Fetches every ancestor of |node| so it has an index, and returns that index
+    QModelIndex revealNode(const NodeItem* node);
+    bool isFetched(const NodeItem* node) const;
+
+    QModelIndex index(int row, int column,
+                      const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+private:
+    // What the scene's pending about-to signal turned into, for its done signal
+    enum class PendingChange { None, Insert, Remove, Move, Relayout };
+
+    bool acceptsRows(NodeItem* parent);
+    void forgetFetched(const NodeItem* node);
+    void onAboutToBeInserted(NodeItem* parent, int row);
+    void onAboutToBeRemoved(NodeItem* parent, int row);
+    void onAboutToBeMoved(NodeItem* node, NodeItem* newParent, int newRow);
+    void onChangeDone();
+    void onRenamed(NodeItem* node);
+    void onSearchMatchesChanged();
+    int rowOf(const NodeItem* node, const NodeItem* parent) const;
+    void clearCaches();
+
+    QPointer<MindMapScene> m_scene;
+    // Node ID -> row under its parent; checked against the parent on every read
+    mutable QHash<quint64, int> m_rows;
+    QSet<quint64> m_searchMatches;
+    // IDs of nodes whose children have rows; a fetched node's parent is fetched
+    QSet<quint64> m_fetched;
+    PendingChange m_pending = PendingChange::None;
+    // Subtree to forget once a pending removal is done
+    const NodeItem* m_pendingNode = nullptr;
+};
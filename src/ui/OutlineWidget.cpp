@@ -3,12 +3,12 @@
 #include "scene/MindMapScene.h"
 #include "scene/MindMapView.h"
 #include "scene/NodeItem.h"
+#include "ui/OutlineModel.h"
 
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QToolButton>
-#include <QTreeWidget>
-#include <QTreeWidgetItemIterator>
+#include <QTreeView>
 #include <QVBoxLayout>
 
 OutlineWidget::OutlineWidget(QWidget* parent) : QWidget(parent) {
@@ -40,47 +40,44 @@ OutlineWidget::OutlineWidget(QWidget* parent) : QWidget(parent) {
     titleRow->addWidget(closeBtn);
     layout->addLayout(titleRow);
 
-    m_tree = new QTreeWidget();
+    m_model = new OutlineModel(this);
+    m_tree = new QTreeView();
     m_tree->setObjectName("outlineTree");
+    m_tree->setModel(m_model);
     m_tree->setHeaderHidden(true);
     m_tree->setAnimated(true);
     m_tree->setIndentation(20);
     m_tree->setExpandsOnDoubleClick(false);
     m_tree->setRootIsDecorated(true);
+    m_tree->setUniformRowHeights(true);
     m_tree->setFocusPolicy(Qt::NoFocus);
-    connect(m_tree, &QTreeWidget::itemClicked, this, &OutlineWidget::onItemClicked);
+    connect(m_tree, &QTreeView::clicked, this, &OutlineWidget::onItemClicked);
+    connect(m_tree, &QTreeView::expanded, this, [this](const QModelIndex& index) {
+        if (m_model->canFetchMore(index))
+            m_model->fetchMore(index);
+    });
     layout->addWidget(m_tree, 1);
+
+    // Resets (switching tabs, loading a file) keep what the user had expanded
+    connect(m_model, &QAbstractItemModel::modelAboutToBeReset, this,
+            &OutlineWidget::saveExpansion);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &OutlineWidget::restoreExpansion);
 }
 
-void OutlineWidget::refresh(MindMapScene* scene) {
-    // Disconnect old scene
+void OutlineWidget::setScene(MindMapScene* scene) {
+    if (m_scene == scene)
+        return;
     if (m_scene)
         disconnect(m_scene, &QGraphicsScene::selectionChanged, this, &OutlineWidget::syncSelection);
 
     m_scene = scene;
-
-    if (!m_tree)
-        return;
-
-    m_tree->clear();
+    m_model->setScene(scene);
 
     if (!m_scene)
         return;
 
-    // Connect selection changes so outline tracks clicks/edits on the canvas
+    // Selection changes on the canvas move the outline's current row
     connect(m_scene, &QGraphicsScene::selectionChanged, this, &OutlineWidget::syncSelection);
-
-    auto* root = m_scene->rootNode();
-    if (!root)
-        return;
-
-    auto* rootItem = new QTreeWidgetItem(m_tree);
-    rootItem->setText(0, root->text());
-    rootItem->setData(0, Qt::UserRole, QVariant::fromValue(reinterpret_cast<quintptr>(root)));
-    rootItem->setExpanded(true);
-
-    buildSubtree(root, rootItem);
-
     syncSelection();
 }
 
@@ -88,32 +85,89 @@ void OutlineWidget::setView(MindMapView* view) {
     m_view = view;
 }
 
-void OutlineWidget::buildSubtree(NodeItem* node, QTreeWidgetItem* parentItem) {
-    for (auto* child : node->childNodes()) {
-        auto* childItem = new QTreeWidgetItem(parentItem);
-        childItem->setText(0, child->text());
-        childItem->setData(0, Qt::UserRole, QVariant::fromValue(reinterpret_cast<quintptr>(child)));
-        childItem->setExpanded(true);
-        buildSubtree(child, childItem);
+OutlineModel* OutlineWidget::model() const {
+    return m_model;
+}
+
+QTreeView* OutlineWidget::treeView() const {
+    return m_tree;
+}
+
+void OutlineWidget::saveExpansion() {
+    const MindMapScene* scene = m_model->scene();
+    // An empty tree is a load in progress; keep what was saved before it
+    if (!scene || m_model->rowCount() == 0)
+        return;
+
+    QSet<quint64> expanded;
+    QList<QModelIndex> pending{m_model->index(0, 0)};
+    while (!pending.isEmpty()) {
+        const QModelIndex index = pending.takeLast();
+        if (!m_tree->isExpanded(index))
+            continue;
+        expanded.insert(index.data(OutlineModel::NodeIdRole).value<quint64>());
+        for (int row = 0, count = m_model->rowCount(index); row < count; ++row)
+            pending.append(m_model->index(row, 0, index));
     }
+    if (!m_expanded.contains(scene)) {
+        connect(scene, &QObject::destroyed, this,
+                [this](QObject* destroyed) { m_expanded.remove(destroyed); });
+    }
+    m_expanded.insert(scene, expanded);
 }
 
-void OutlineWidget::onItemClicked(QTreeWidgetItem* item, int /*column*/) {
-    quintptr ptr = item->data(0, Qt::UserRole).value<quintptr>();
-    auto* node = reinterpret_cast<NodeItem*>(ptr);
-    if (!node || !m_scene)
+void OutlineWidget::restoreExpansion() {
+    MindMapScene* scene = m_model->scene();
+    if (!scene || m_model->rowCount() == 0)
         return;
 
-    // Validate the pointer against existing scene nodes to avoid dangling references
-    bool found = false;
-    const auto sceneItems = m_scene->items();
-    for (auto* sceneItem : sceneItems) {
-        if (sceneItem == node) {
-            found = true;
-            break;
-        }
+    const auto saved = m_expanded.constFind(scene);
+    if (saved == m_expanded.cend() || saved->isEmpty()) {
+        // A map seen for the first time opens fully unless it is large
+        expandToDepth(scene->nodeCount() <= kExpandAllNodeLimit ? -1 : kDefaultExpandDepth);
+        return;
+    }
+
+    // Top-down, so each branch is fetched before its expanded children are looked up
+    bool restored = false;
+    QList<QModelIndex> pending{m_model->index(0, 0)};
+    while (!pending.isEmpty()) {
+        const QModelIndex index = pending.takeLast();
+        if (!saved->contains(index.data(OutlineModel::NodeIdRole).value<quint64>()))
+            continue;
+        if (m_model->canFetchMore(index))
+            m_model->fetchMore(index);
+        m_tree->setExpanded(index, true);
+        restored = true;
+        for (int row = 0, count = m_model->rowCount(index); row < count; ++row)
+            pending.append(m_model->index(row, 0, index));
+    }
+    // The saved branches are gone (another file was loaded into the tab)
+    if (!restored)
+        expandToDepth(scene->nodeCount() <= kExpandAllNodeLimit ? -1 : kDefaultExpandDepth);
+}
+
+void OutlineWidget::expandToDepth(int depth) {
+    // |depth| levels below the root are opened; -1 opens everything
+    QList<QPair<QModelIndex, int>> pending{{m_model->index(0, 0), 0}};
+    while (!pending.isEmpty()) {
+        const auto [index, level] = pending.takeLast();
+        if (depth >= 0 && level >= depth)
+            continue;
+        if (m_model->canFetchMore(index))
+            m_model->fetchMore(index);
+        const int count = m_model->rowCount(index);
+        if (count == 0)
+            continue;
+        m_tree->setExpanded(index, true);
+        for (int row = 0; row < count; ++row)
+            pending.append({m_model->index(row, 0, index), level + 1});
     }
-    if (!found)
+}
+
+void OutlineWidget::onItemClicked(const QModelIndex& index) {
+    NodeItem* node = m_model->nodeForIndex(index);
+    if (!m_scene || !node)
         return;
 
     m_scene->clearSelection();
@@ -126,26 +180,14 @@ void OutlineWidget::syncSelection() {
     if (!m_scene || !m_tree)
         return;
 
-    NodeItem* selected = m_scene->selectedNode();
-    if (!selected) {
-        m_tree->clearSelection();
-        m_tree->setCurrentItem(nullptr);
+    // A node selected on the canvas may sit in a branch the outline has not
+    // fetched yet; scrollTo then expands its ancestors
+    const QModelIndex index = m_model->revealNode(m_scene->selectedNode());
+    if (!index.isValid()) {
+        m_tree->selectionModel()->clear();
         return;
     }
-
-    // Block signals to avoid feedback loop (setCurrentItem would trigger itemClicked)
-    bool blocked = m_tree->blockSignals(true);
-
-    quintptr target = reinterpret_cast<quintptr>(selected);
-    QTreeWidgetItemIterator it(m_tree);
-    while (*it) {
-        if ((*it)->data(0, Qt::UserRole).value<quintptr>() == target) {
-            m_tree->setCurrentItem(*it);
-            m_tree->scrollToItem(*it);
-            break;
-        }
-        ++it;
-    }
-
-    m_tree->blockSignals(blocked);
+    // setCurrentIndex does not emit clicked, so this cannot loop back to the scene
+    m_tree->setCurrentIndex(index);
+    m_tree->scrollTo(index);
 }
@@ -1,30 +1,46 @@
 #pragma once
 
+#include <QHash>
+#include <QPointer>
+#include <QSet>
 #include <QWidget>
 
 class MindMapScene;
 class MindMapView;
-class NodeItem;
-class QTreeWidget;
-class QTreeWidgetItem;
+class OutlineModel;
+class QModelIndex;
+class QTreeView;
 
 class OutlineWidget : public QWidget {
     Q_OBJECT
 public:
+    // Maps up to this many nodes open fully the first time they are shown;
+    // larger ones open this many levels deep and fetch the rest on demand
+    static constexpr int kExpandAllNodeLimit = 2000;
+    static constexpr int kDefaultExpandDepth = 2;
+
     explicit OutlineWidget(QWidget* parent = nullptr);
 
-    void refresh(MindMapScene* scene);
+    void setScene(MindMapScene* scene);
     void setView(MindMapView* view);
     void syncSelection();
 
+    OutlineModel* model() const;
+    QTreeView* treeView() const;
+
 signals:
     void closeRequested();
 
 private:
-    void buildSubtree(NodeItem* node, QTreeWidgetItem* parentItem);
-    void onItemClicked(QTreeWidgetItem* item, int column);
+    void onItemClicked(const QModelIndex& index);
+    void saveExpansion();
+    void restoreExpansion();
+    void expandToDepth(int depth);
 
-    QTreeWidget* m_tree = nullptr;
-    MindMapScene* m_scene = nullptr;
+    QTreeView* m_tree = nullptr;
+    OutlineModel* m_model = nullptr;
+    QPointer<MindMapScene> m_scene;
     MindMapView* m_view = nullptr;
+    // Expanded node IDs per scene, kept across tab switches and reloads
+    QHash<const QObject*, QSet<quint64>> m_expanded;
 };
@@ -0,0 +1,184 @@
+#include "ui/PerformanceHud.h"
+#include "core/AppSettings.h"
+#include "scene/MindMapScene.h"
+#include "scene/MindMapView.h"
+
+#include <QAction>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QPainter>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QTimer>
+
+static double toMs(qint64 nsecs) {
+    return nsecs / 1e6;
+}
+
+PerformanceHud::PerformanceHud(MindMapView* view) : QWidget(view), m_view(view) {
+    setObjectName("performanceHud");
+    setFixedSize(kWidth, kHeight);
+    move(kMargin, kMargin);
+    // Opaque, so repainting the overlay never repaints (and profiles) the view
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    m_history.setCapacity(kHistorySize);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(kRefreshIntervalMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, qOverload<>(&QWidget::update));
+    connect(view, &MindMapView::frameRendered, this, &PerformanceHud::recordFrame);
+
+    auto* saveAct = new QAction(tr("Save Frame Statistics as CSV..."), this);
+    connect(saveAct, &QAction::triggered, this, &PerformanceHud::saveCsv);
+    auto* clearAct = new QAction(tr("Clear History"), this);
+    connect(clearAct, &QAction::triggered, this, &PerformanceHud::clearHistory);
+    addAction(saveAct);
+    addAction(clearAct);
+    setContextMenuPolicy(Qt::ActionsContextMenu);
+
+    applyVisibility(AppSettings::instance().showPerformanceHud());
+    connect(&AppSettings::instance(), &AppSettings::showPerformanceHudChanged, this,
+            &PerformanceHud::applyVisibility);
+}
+
+void PerformanceHud::applyVisibility(bool show) {
+    RenderStats::setEnabled(show);
+    setVisible(show);
+    if (show) {
+        raise();
+        m_refreshTimer->start();
+    } else {
+        m_refreshTimer->stop();
+        m_history.clear();
+    }
+}
+
+int PerformanceHud::frameCount() const {
+    return m_history.count();
+}
+
+void PerformanceHud::recordFrame(const RenderStats::Frame& frame) {
+    m_history.append(frame);
+}
+
+void PerformanceHud::clearHistory() {
+    m_history.clear();
+    update();
+}
+
+// --- CSV ---
+
+bool PerformanceHud::writeCsv(QIODevice* device) const {
+    QTextStream out(device);
+    out << "timestamp_ms,frame_ms,visible_nodes,node_cache_hit_rate";
+    for (int s = 0; s < RenderStats::SectionCount; ++s) {
+        const QString name = RenderStats::sectionName(RenderStats::Section(s));
+        out << ',' << name << "_calls," << name << "_ms";
+    }
+    out << '\n';
+
+    for (int i = m_history.firstIndex(); i <= m_history.lastIndex(); ++i) {
+        const auto& frame = m_history.at(i);
+        out << frame.timestampMs << ',' << toMs(frame.frameNsecs) << ',' << frame.visibleNodes
+            << ',' << frame.nodeCacheHitRate();
+        for (int s = 0; s < RenderStats::SectionCount; ++s)
+            out << ',' << frame.calls[s] << ',' << toMs(frame.nsecs[s]);
+        out << '\n';
+    }
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+void PerformanceHud::saveCsv() {
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Save Frame Statistics"), QString(),
+                                                    tr("CSV Files (*.csv)"));
+    if (filePath.isEmpty())
+        return;
+    if (!filePath.endsWith(".csv", Qt::CaseInsensitive))
+        filePath += ".csv";
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text) || !writeCsv(&file) || !file.commit())
+        QMessageBox::warning(this, "YMind", tr("Could not save file:\n%1").arg(filePath));
+}
+
+// --- Painting ---
+
+void PerformanceHud::paintEvent(QPaintEvent* /*event*/) {
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(20, 22, 28));
+    painter.setPen(QColor(70, 74, 84));
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+
+    // Frames of the last second give the rate; the newest gives the counts
+    int framesLastSecond = 0;
+    qint64 worstNsecs = 0;
+    qint64 totalNsecs = 0;
+    if (!m_history.isEmpty()) {
+        const qint64 now = m_history.last().timestampMs;
+        for (int i = m_history.lastIndex(); i >= m_history.firstIndex(); --i) {
+            const auto& frame = m_history.at(i);
+            if (now - frame.timestampMs > 1000)
+                break;
+            ++framesLastSecond;
+            worstNsecs = qMax(worstNsecs, frame.frameNsecs);
+            totalNsecs += frame.frameNsecs;
+        }
+    }
+    const RenderStats::Frame last = m_history.isEmpty() ? RenderStats::Frame() : m_history.last();
+
+    QStringList lines;
+    lines << tr("FPS %1   frame %2 ms avg, %3 ms max")
+                 .arg(framesLastSecond)
+                 .arg(framesLastSecond ? toMs(totalNsecs) / framesLastSecond : 0.0, 0, 'f', 2)
+                 .arg(toMs(worstNsecs), 0, 'f', 2);
+    lines << tr("Nodes %1 painted / %2 visible (%3% cached)   Edges %4 painted")
+                 .arg(last.calls[RenderStats::NodePaint])
+                 .arg(last.visibleNodes)
+                 .arg(qRound(last.nodeCacheHitRate() * 100))
+                 .arg(last.calls[RenderStats::EdgePaint]);
+    lines << tr("paint: nodes %1 ms  edges %2 ms  background %3 ms")
+                 .arg(toMs(last.nsecs[RenderStats::NodePaint]), 0, 'f', 2)
+                 .arg(toMs(last.nsecs[RenderStats::EdgePaint]), 0, 'f', 2)
+                 .arg(toMs(last.nsecs[RenderStats::Background]), 0, 'f', 2);
+    lines << tr("updatePath: %1 calls, %2 ms")
+                 .arg(last.calls[RenderStats::EdgeUpdate])
+                 .arg(toMs(last.nsecs[RenderStats::EdgeUpdate]), 0, 'f', 2);
+    if (auto* scene = m_view ? qobject_cast<MindMapScene*>(m_view->scene()) : nullptr)
+        lines << tr("Undo history: %1 KB").arg((scene->undoRetainedBytes() + 1023) / 1024);
+
+    QFont font = painter.font();
+    font.setStyleHint(QFont::Monospace);
+    font.setFamily("monospace");
+    font.setPointSizeF(8.5);
+    painter.setFont(font);
+    painter.setPen(QColor(220, 224, 232));
+    const int lineHeight = painter.fontMetrics().height();
+    int y = 8;
+    for (const auto& line : lines) {
+        painter.drawText(QRect(8, y, width() - 16, lineHeight), Qt::AlignLeft, line);
+        y += lineHeight;
+    }
+
+    // Frame time graph, newest on the right, with the 60 Hz budget marked
+    const QRect graph(8, y + 6, width() - 16, height() - y - 14);
+    if (graph.height() <= 0)
+        return;
+    painter.fillRect(graph, QColor(32, 35, 44));
+    constexpr double kGraphRangeMs = 33.3;
+    constexpr double kBudgetMs = 1000.0 / 60.0;
+    auto yFor = [&graph](double ms) {
+        return graph.bottom() - qMin(ms / kGraphRangeMs, 1.0) * graph.height();
+    };
+    const int bars = qMin(m_history.count(), graph.width());
+    for (int b = 0; b < bars; ++b) {
+        const auto& frame = m_history.at(m_history.lastIndex() - b);
+        const double ms = toMs(frame.frameNsecs);
+        const int x = graph.right() - b;
+        painter.setPen(ms > kBudgetMs ? QColor(230, 90, 80) : QColor(90, 190, 120));
+        painter.drawLine(QPointF(x, graph.bottom()), QPointF(x, yFor(ms)));
+    }
+    painter.setPen(QPen(QColor(240, 200, 80), 1, Qt::DashLine));
+    const double budgetY = yFor(kBudgetMs);
+    painter.drawLine(QPointF(graph.left(), budgetY), QPointF(graph.right(), budgetY));
+}
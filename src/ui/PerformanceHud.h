@@ -0,0 +1,49 @@
+#pragma once
+
+#include "scene/RenderStats.h"
+
+#include <QContiguousCache>
+#include <QPointer>
+#include <QWidget>
+
+class MindMapView;
+class QIODevice;
+class QTimer;
+
+// Debug overlay in the top-left corner of a MindMapView: frame rate, frame
+// time, paints per frame, node cache hit rate and time per paint section, over
+// a rolling graph of recent frame times. Shown with View > Performance Overlay
+// (the "debug/performanceHud" setting), which also turns RenderStats on. The
+// history can be saved as CSV from the context menu.
+class PerformanceHud : public QWidget {
+    Q_OBJECT
+
+public:
+    static constexpr int kWidth = 340;
+    static constexpr int kHeight = 196;
+    static constexpr int kMargin = 12;
+    // Frames kept for the graph and the CSV dump
+    static constexpr int kHistorySize = 600;
+    // The text is refreshed at this rate rather than on every frame
+    static constexpr int kRefreshIntervalMs = 250;
+
+    explicit PerformanceHud(MindMapView* view);
+
+    int frameCount() const;
+    bool writeCsv(QIODevice* device) const;
+
+public slots:
+    void saveCsv();
+    void clearHistory();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    void recordFrame(const RenderStats::Frame& frame);
+    void applyVisibility(bool show);
+
+    QPointer<MindMapView> m_view;
+    QTimer* m_refreshTimer;
+    QContiguousCache<RenderStats::Frame> m_history;
+};
@@ -0,0 +1,216 @@
+#include "ui/SearchBar.h"
+#include "scene/MindMapScene.h"
+#include "scene/MindMapView.h"
+#include "scene/NodeItem.h"
+#include "ui/IconFactory.h"
+
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTimer>
+#include <QToolButton>
+#include <QUndoStack>
+
+#include <utility>
+
+SearchBar::SearchBar(QWidget* parent) : QWidget(parent) {
+    setObjectName("searchBar");
+    setAttribute(Qt::WA_StyledBackground, true);
+
+    auto* layout = new QHBoxLayout(this);
+    layout->setContentsMargins(8, 4, 4, 4);
+    layout->setSpacing(4);
+
+    m_queryEdit = new QLineEdit(this);
+    m_queryEdit->setObjectName("searchQuery");
+    m_queryEdit->setPlaceholderText(tr("Find topics"));
+    m_queryEdit->setClearButtonEnabled(true);
+    m_queryEdit->setMaximumWidth(320);
+    layout->addWidget(m_queryEdit, 1);
+
+    m_countLabel = new QLabel(this);
+    m_countLabel->setObjectName("searchCount");
+    m_countLabel->setMinimumWidth(80);
+    layout->addWidget(m_countLabel);
+
+    auto addButton = [&](const QString& iconName, const QString& tooltip) {
+        auto* btn = new QToolButton(this);
+        btn->setIcon(IconFactory::makeToolIcon(iconName));
+        btn->setProperty("iconName", iconName);
+        btn->setToolTip(tooltip);
+        btn->setAutoRaise(true);
+        btn->setFixedSize(24, 24);
+        btn->setIconSize(QSize(16, 16));
+        layout->addWidget(btn);
+        return btn;
+    };
+    auto* prevBtn = addButton("find-previous", tr("Previous match (Shift+Enter)"));
+    connect(prevBtn, &QToolButton::clicked, this, &SearchBar::findPrevious);
+    auto* nextBtn = addButton("find-next", tr("Next match (Enter)"));
+    connect(nextBtn, &QToolButton::clicked, this, &SearchBar::findNext);
+    layout->addStretch();
+    auto* closeBtn = addButton("close-panel", tr("Close (Esc)"));
+    closeBtn->setObjectName("closePanelBtn");
+    connect(closeBtn, &QToolButton::clicked, this, &SearchBar::dismiss);
+
+    m_queryTimer = new QTimer(this);
+    m_queryTimer->setSingleShot(true);
+    m_queryTimer->setInterval(kQueryDelayMs);
+    connect(m_queryTimer, &QTimer::timeout, this, &SearchBar::runQuery);
+    connect(m_queryEdit, &QLineEdit::textChanged, m_queryTimer, qOverload<>(&QTimer::start));
+
+    setVisible(false);
+}
+
+void SearchBar::setScene(MindMapScene* scene) {
+    if (m_scene == scene)
+        return;
+    if (m_scene) {
+        disconnect(m_scene->undoStack(), nullptr, this, nullptr);
+        m_scene->setSearchMatches({});
+    }
+    m_scene = scene;
+    m_matches.clear();
+    m_current = -1;
+    m_lastQuery.clear();
+    if (m_scene) {
+        // Edits, undo and redo can add, drop or rename matches
+        connect(m_scene->undoStack(), &QUndoStack::indexChanged, this, [this]() {
+            if (isVisible() && !m_queryEdit->text().isEmpty())
+                m_queryTimer->start();
+        });
+    }
+    if (isVisible())
+        runQuery();
+    else
+        updateCountLabel();
+}
+
+void SearchBar::setView(MindMapView* view) {
+    m_view = view;
+}
+
+QString SearchBar::query() const {
+    return m_queryEdit->text();
+}
+
+void SearchBar::setQuery(const QString& query) {
+    m_queryEdit->setText(query);
+    runQuery();
+}
+
+int SearchBar::matchCount() const {
+    return int(m_matches.size());
+}
+
+int SearchBar::currentMatch() const {
+    return m_current;
+}
+
+// --- Navigation ---
+
+void SearchBar::activate() {
+    setVisible(true);
+    m_queryEdit->setFocus(Qt::ShortcutFocusReason);
+    m_queryEdit->selectAll();
+    if (!m_queryEdit->text().isEmpty())
+        runQuery();
+}
+
+void SearchBar::dismiss() {
+    m_queryTimer->stop();
+    if (m_scene)
+        m_scene->setSearchMatches({});
+    m_matches.clear();
+    m_current = -1;
+    m_lastQuery.clear();
+    setVisible(false);
+    if (m_view)
+        m_view->setFocus();
+}
+
+void SearchBar::findNext() {
+    // A query still pending lands on its first match, which is the step
+    if (m_queryTimer->isActive() && runQuery())
+        return;
+    if (!m_matches.isEmpty())
+        goToMatch((m_current + 1) % int(m_matches.size()));
+}
+
+void SearchBar::findPrevious() {
+    if (m_queryTimer->isActive() && runQuery())
+        return;
+    if (!m_matches.isEmpty()) {
+        const int count = int(m_matches.size());
+        goToMatch(m_current <= 0 ? count - 1 : m_current - 1);
+    }
+}
+
+bool SearchBar::runQuery() {
+    m_queryTimer->stop();
+    if (!m_scene)
+        return false;
+
+    const quint64 currentId = m_current >= 0 ? m_matches.value(m_current) : 0;
+    const QString text = m_queryEdit->text();
+    const QList<NodeItem*> nodes =
+        text.trimmed().isEmpty() ? QList<NodeItem*>() : m_scene->findNodes(text);
+    m_scene->setSearchMatches(nodes);
+
+    m_matches.clear();
+    m_matches.reserve(nodes.size());
+    for (auto* node : nodes)
+        m_matches.append(node->id());
+
+    // A refresh keeps the node the user is on; a new query starts at the first match
+    const bool newQuery = text != std::exchange(m_lastQuery, text);
+    m_current = newQuery ? -1 : int(m_matches.indexOf(currentId));
+    if (newQuery && !m_matches.isEmpty()) {
+        goToMatch(0);
+        return true;
+    }
+    updateCountLabel();
+    return false;
+}
+
+void SearchBar::goToMatch(int index) {
+    NodeItem* node = m_scene ? m_scene->nodeById(m_matches.value(index)) : nullptr;
+    if (!node)
+        return;
+    m_current = index;
+    m_scene->clearSelection();
+    node->setSelected(true);
+    if (m_view)
+        m_view->centerOn(node);
+    updateCountLabel();
+}
+
+void SearchBar::updateCountLabel() {
+    if (m_queryEdit->text().trimmed().isEmpty())
+        m_countLabel->clear();
+    else if (m_matches.isEmpty())
+        m_countLabel->setText(tr("No results"));
+    else if (m_current < 0)
+        m_countLabel->setText(tr("%n match(es)", nullptr, int(m_matches.size())));
+    else
+        m_countLabel->setText(tr("%1 of %2").arg(m_current + 1).arg(m_matches.size()));
+}
+
+void SearchBar::keyPressEvent(QKeyEvent* event) {
+    // The line edit passes Enter and Escape on to its parent
+    switch (event->key()) {
+    case Qt::Key_Escape:
+        dismiss();
+        return;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        if (event->modifiers() & Qt::ShiftModifier)
+            findPrevious();
+        else
+            findNext();
+        return;
+    default:
+        QWidget::keyPressEvent(event);
+    }
+}
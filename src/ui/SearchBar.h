@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QList>
+#include <QPointer>
+#include <QWidget>
+
+class MindMapScene;
+class MindMapView;
+class QLabel;
+class QLineEdit;
+class QTimer;
+
+// Find bar above the canvas (Edit > Find, Ctrl+F). Queries the scene's search
+// index as the user types, highlights every match and steps through them in tree
+// order, selecting and centring each one. Results are refreshed after every
+// undo stack change while the bar is open, so they follow edits.
+class SearchBar : public QWidget {
+    Q_OBJECT
+
+public:
+    // Typing pauses shorter than this are coalesced into one query
+    static constexpr int kQueryDelayMs = 80;
+
+    explicit SearchBar(QWidget* parent = nullptr);
+
+    void setScene(MindMapScene* scene);
+    void setView(MindMapView* view);
+
+    QString query() const;
+    void setQuery(const QString& query);
+    int matchCount() const;
+    // Index into the matches of the node last navigated to, or -1
+    int currentMatch() const;
+
+public slots:
+    // Shows the bar and focuses the query with its text selected
+    void activate();
+    void dismiss();
+    void findNext();
+    void findPrevious();
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+
+private:
+    // True when a new query moved to its first match
+    bool runQuery();
+    void goToMatch(int index);
+    void updateCountLabel();
+
+    QLineEdit* m_queryEdit;
+    QLabel* m_countLabel;
+    QTimer* m_queryTimer;
+    QPointer<MindMapScene> m_scene;
+    QPointer<MindMapView> m_view;
+    QString m_lastQuery;
+    QList<quint64> m_matches;
+    int m_current = -1;
+};
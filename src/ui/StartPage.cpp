@@ -1,23 +1,120 @@
 #include "ui/StartPage.h"
+#include "core/AppSettings.h"
 #include "core/TemplateDescriptor.h"
 #include "core/TemplateRegistry.h"
 #include "ui/IconFactory.h"
+#include "ui/ThumbnailCache.h"
 #include "scene/MindMapScene.h"
 #include "scene/NodeItem.h"
 
+#include <QAction>
 #include <QCoreApplication>
+#include <QDir>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QGridLayout>
 #include <QHBoxLayout>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QLabel>
 #include <QPushButton>
+#include <QScrollArea>
+#include <QToolButton>
 #include <QUndoStack>
 #include <QVBoxLayout>
 
+static constexpr int kRecentColumns = 4;
+static constexpr int kRecentCardWidth = 180;
+static constexpr int kRecentCardHeight = 150;
+static constexpr int kRecentSpacing = 16;
+
+static QIcon recentFileIcon(const QImage& thumbnail) {
+    if (thumbnail.isNull())
+        return QIcon();
+    QPixmap pix = QPixmap::fromImage(thumbnail);
+    pix.setDevicePixelRatio(2.0);
+    return QIcon(pix);
+}
+
+// Recent maps grid. Thumbnails are requested, never rendered here: cards
+// start blank and pick up their image when ThumbnailCache reports it.
+static void buildRecentFiles(QWidget* page, QVBoxLayout* outer,
+                             std::function<void(const QString&)> onOpenFile) {
+    auto* title = new QLabel(QCoreApplication::translate("StartPage", "Recent Maps"));
+    title->setObjectName("recentFilesTitle");
+    title->setAlignment(Qt::AlignCenter);
+    outer->addWidget(title);
+
+    auto* area = new QScrollArea();
+    area->setObjectName("recentFilesArea");
+    area->setWidgetResizable(true);
+    area->setFrameShape(QFrame::NoFrame);
+    area->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    area->setFixedWidth(kRecentColumns * (kRecentCardWidth + kRecentSpacing) + 24);
+    area->setMaximumHeight(2 * (kRecentCardHeight + kRecentSpacing) + kRecentCardHeight / 2);
+
+    auto* grid = new QWidget();
+    grid->setObjectName("recentFilesGrid");
+    auto* gridLayout = new QGridLayout(grid);
+    gridLayout->setAlignment(Qt::AlignTop | Qt::AlignHCenter);
+    gridLayout->setSpacing(kRecentSpacing);
+    area->setWidget(grid);
+    outer->addWidget(area, 0, Qt::AlignHCenter);
+
+    auto rebuild = [title, area, grid, gridLayout, onOpenFile]() {
+        while (auto* item = gridLayout->takeAt(0)) {
+            delete item->widget();
+            delete item;
+        }
+
+        const QStringList files = AppSettings::instance().recentFiles();
+        title->setVisible(!files.isEmpty());
+        area->setVisible(!files.isEmpty());
+
+        for (int i = 0; i < files.size(); ++i) {
+            const QString path = files[i];
+            auto* card = new QToolButton(grid);
+            card->setObjectName("recentFileCard");
+            card->setToolButtonStyle(Qt::ToolButtonTextUnderIcon);
+            card->setFixedSize(kRecentCardWidth, kRecentCardHeight);
+            card->setIconSize(QSize(ThumbnailCache::kWidth / 2, ThumbnailCache::kHeight / 2));
+            card->setText(card->fontMetrics().elidedText(QFileInfo(path).completeBaseName(),
+                                                         Qt::ElideMiddle, kRecentCardWidth - 16));
+            card->setToolTip(QDir::toNativeSeparators(path));
+            card->setProperty("filePath", path);
+            card->setIcon(recentFileIcon(ThumbnailCache::instance().thumbnail(path)));
+            QObject::connect(card, &QToolButton::clicked, card,
+                             [onOpenFile, path]() { onOpenFile(path); });
+
+            auto* removeAct = new QAction(
+                QCoreApplication::translate("StartPage", "Remove from Recent Maps"), card);
+            QObject::connect(removeAct, &QAction::triggered, card,
+                             [path]() { AppSettings::instance().removeRecentFile(path); });
+            card->addAction(removeAct);
+            card->setContextMenuPolicy(Qt::ActionsContextMenu);
+
+            gridLayout->addWidget(card, i / kRecentColumns, i % kRecentColumns);
+        }
+    };
+    rebuild();
+
+    // Queued: the list can change from a card's own context menu
+    QObject::connect(&AppSettings::instance(), &AppSettings::recentFilesChanged, page, rebuild,
+                     Qt::QueuedConnection);
+    QObject::connect(&ThumbnailCache::instance(), &ThumbnailCache::thumbnailReady, page,
+                     [grid](const QString& filePath, const QImage& image) {
+                         const auto cards = grid->findChildren<QToolButton*>("recentFileCard");
+                         for (auto* card : cards) {
+                             if (card->property("filePath").toString() == filePath)
+                                 card->setIcon(recentFileIcon(image));
+                         }
+                     });
+}
+
 QWidget* StartPage::create(QObject* /*receiver*/, std::function<void(const QString&)> onTemplate,
-                           std::function<void()> onBlankCanvas) {
+                           std::function<void()> onBlankCanvas,
+                           std::function<void(const QString&)> onOpenFile) {
     auto* page = new QWidget();
     page->setObjectName("startPage");
 
@@ -121,6 +218,9 @@ QWidget* StartPage::create(QObject* /*receiver*/, std::function<void(const QStri
     linkRow->addWidget(loadLink);
     outer->addLayout(linkRow);
 
+    outer->addSpacing(32);
+    buildRecentFiles(page, outer, std::move(onOpenFile));
+
     return page;
 }
 
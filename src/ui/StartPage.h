@@ -7,7 +7,8 @@ class MindMapScene;
 
 namespace StartPage {
 QWidget* create(QObject* receiver, std::function<void(const QString&)> onTemplate,
-                std::function<void()> onBlankCanvas);
+                std::function<void()> onBlankCanvas,
+                std::function<void(const QString&)> onOpenFile);
 void loadTemplate(const QString& templateId, MindMapScene* scene);
 bool loadTemplateFromFile(const QString& filePath, MindMapScene* scene);
 } // namespace StartPage
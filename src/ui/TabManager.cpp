@@ -1,23 +1,64 @@
 #include "ui/TabManager.h"
 #include "ui/IconFactory.h"
+#include "core/AppSettings.h"
 #include "layout/LayoutStyle.h"
+#include "scene/MapLoader.h"
 #include "scene/MindMapScene.h"
 #include "scene/MindMapView.h"
+#include "ui/MinimapWidget.h"
+#include "ui/PerformanceHud.h"
 #include "ui/StartPage.h"
 #include "ui/ThemeManager.h"
 
 #include <QAction>
+#include <QDir>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QLabel>
 #include <QMenu>
 #include <QMessageBox>
+#include <QPointer>
+#include <QProgressBar>
+#include <QPushButton>
 #include <QSignalBlocker>
 #include <QStackedWidget>
 #include <QTabBar>
 #include <QTimer>
 #include <QToolButton>
 #include <QUndoStack>
+#include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrentRun>
 
-TabManager::TabManager(QWidget* parent) : QObject(parent), m_parentWidget(parent) {}
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Positions |view| as |saved| recorded it, after the pending resize
+void restoreViewPosition(MindMapView* view, const SessionTab& saved) {
+    QTimer::singleShot(0, view, [view, saved]() {
+        if (saved.zoom <= 0.0) {
+            view->zoomToFit();
+            return;
+        }
+        view->setTransform(QTransform::fromScale(saved.zoom, saved.zoom));
+        view->centerOn(saved.center);
+    });
+}
+
+SessionTab viewPosition(const MindMapView* view) {
+    SessionTab position;
+    position.zoom = view->transform().m11();
+    position.center = view->mapToScene(view->viewport()->rect().center());
+    return position;
+}
+
+} // namespace
+
+TabManager::TabManager(QWidget* parent) : QObject(parent), m_parentWidget(parent) {
+    m_clock.start();
+}
 
 void TabManager::init(QAction* undoAct, QAction* redoAct) {
     m_undoAct = undoAct;
@@ -53,6 +94,29 @@ void TabManager::init(QAction* undoAct, QAction* redoAct) {
 
     // Connect "+" button
     connect(m_newTabBtn, &QToolButton::clicked, this, &TabManager::addNewTab);
+
+    m_hibernateTimer = new QTimer(this);
+    m_hibernateTimer->setInterval(kHibernateCheckMs);
+    connect(m_hibernateTimer, &QTimer::timeout, this, &TabManager::applyHibernationPolicy);
+    m_hibernateTimer->start();
+
+    m_fileWatcher = new QFileSystemWatcher(this);
+    m_reloadTimer = new QTimer(this);
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(kReloadDelayMs);
+    connect(m_fileWatcher, &QFileSystemWatcher::fileChanged, this, [this](const QString& path) {
+        m_changedFiles.insert(path);
+        m_reloadTimer->start();
+    });
+    connect(m_reloadTimer, &QTimer::timeout, this, [this]() {
+        const QSet<QString> changed = std::exchange(m_changedFiles, {});
+        // Files replaced by a rename drop out of the watcher; add them back
+        watchTabFiles();
+        for (int i = 0; i < m_tabs.size(); ++i) {
+            if (changed.contains(m_tabs[i].filePath))
+                checkDiskChanges(i);
+        }
+    });
 }
 
 void TabManager::onTabMoved(int from, int to) {
@@ -68,6 +132,8 @@ void TabManager::addNewTab() {
     auto* scene = new MindMapScene(m_parentWidget);
     auto* view = new MindMapView(m_parentWidget);
     view->setScene(scene);
+    new MinimapWidget(view);
+    new PerformanceHud(view);
 
     auto* stack = new QStackedWidget(m_parentWidget);
     auto* startPage = StartPage::create(
@@ -111,7 +177,8 @@ void TabManager::addNewTab() {
             updateTabText(tabIdx);
             updateTabIcon(tabIdx);
             emit currentTabChanged(tabIdx);
-        });
+        },
+        [this](const QString& filePath) { emit openFileRequested(filePath); });
     stack->addWidget(startPage); // index 0 — start page
     stack->addWidget(view);      // index 1 — mind map view
     stack->setCurrentIndex(0);   // show start page
@@ -121,6 +188,13 @@ void TabManager::addNewTab() {
 
 void TabManager::addTab(MindMapScene* scene, MindMapView* view, QStackedWidget* stack,
                         const QString& filePath) {
+    const int index = appendTab(scene, view, stack, filePath);
+    m_tabBar->setCurrentIndex(index);
+    switchToTab(index);
+}
+
+int TabManager::appendTab(MindMapScene* scene, MindMapView* view, QStackedWidget* stack,
+                          const QString& filePath) {
     TabState tab;
     tab.scene = scene;
     tab.view = view;
@@ -137,9 +211,411 @@ void TabManager::addTab(MindMapScene* scene, MindMapView* view, QStackedWidget*
         m_contentStack->addWidget(stack);
         updateTabIcon(m_tabs.size() - 1);
     }
+    watchTabFiles();
+    return int(m_tabs.size()) - 1;
+}
+
+int TabManager::appendMapTab(const QString& filePath, QWidget* placeholder) {
+    auto* scene = new MindMapScene(m_parentWidget);
+    auto* view = new MindMapView(m_parentWidget);
+    view->setScene(scene);
+    new MinimapWidget(view);
+    new PerformanceHud(view);
+
+    auto* stack = new QStackedWidget(m_parentWidget);
+    if (placeholder)
+        stack->addWidget(placeholder); // index 0 — until the file is read
+    stack->addWidget(view);
+    stack->setCurrentIndex(0);
+    return appendTab(scene, view, stack, filePath);
+}
+
+// --- Background loading ---
+
+int TabManager::openTab(const QString& filePath) {
+    const int index = appendMapTab(filePath, nullptr);
+    loadTab(index, filePath);
+    m_tabBar->setCurrentIndex(index);
+    switchToTab(index);
+    return index;
+}
+
+void TabManager::loadTab(int index, const QString& filePath, const SessionTab& position) {
+    if (index < 0 || index >= m_tabs.size() || m_tabs[index].loader)
+        return;
+    TabState& tab = m_tabs[index];
+    tab.filePath = filePath;
+    tab.session = position;
+    updateTabText(index);
+    // Taken before reading, so a write during the load is caught afterwards
+    recordDiskState(index);
+    watchTabFiles();
+
+    auto* page = new QWidget;
+    page->setObjectName("tabLoadingPage");
+    auto* label = new QLabel(tr("Opening %1...").arg(QFileInfo(filePath).fileName()), page);
+    label->setObjectName("tabPlaceholder");
+    label->setAlignment(Qt::AlignCenter);
+    auto* bar = new QProgressBar(page);
+    bar->setFixedWidth(240);
+    bar->setTextVisible(false);
+    auto* layout = new QVBoxLayout(page);
+    layout->addStretch();
+    layout->addWidget(label, 0, Qt::AlignHCenter);
+    layout->addWidget(bar, 0, Qt::AlignHCenter);
+    layout->addStretch();
+    tab.stack->addWidget(page);
+    tab.stack->setCurrentWidget(page);
+
+    tab.loader = new MapLoader(tab.scene, filePath, this);
+    connect(tab.loader, &MapLoader::progress, bar, [bar](int done, int total) {
+        // Busy indicator while the worker parses
+        bar->setRange(0, std::max(total, 0));
+        if (total > 0)
+            bar->setValue(done);
+    });
+    connect(tab.loader, &MapLoader::finished, this,
+            [this, loader = tab.loader](bool ok) { finishLoad(loader, ok); });
+    tab.loader->start();
+    if (index == currentIndex())
+        emit currentTabChanged(index);
+}
+
+bool TabManager::isTabLoading(int index) const {
+    return index >= 0 && index < m_tabs.size() && m_tabs[index].loader;
+}
+
+void TabManager::finishLoad(MapLoader* loader, bool ok) {
+    loader->deleteLater();
+    int index = 0;
+    while (index < m_tabs.size() && m_tabs[index].loader != loader)
+        ++index;
+    if (index == m_tabs.size())
+        return;
+
+    TabState& tab = m_tabs[index];
+    tab.loader = nullptr;
+    const QString path = loader->filePath();
+    QWidget* page = tab.stack->findChild<QWidget*>("tabLoadingPage", Qt::FindDirectChildrenOnly);
+    tab.stack->removeWidget(page);
+    delete page;
+
+    if (!ok) {
+        QMessageBox::warning(m_parentWidget, "YMind", tr("Could not open file:\n%1").arg(path));
+        if (!QFileInfo::exists(path))
+            AppSettings::instance().removeRecentFile(path);
+        tab.filePath.clear();
+        updateTabText(index);
+        if (tab.stack->widget(0) != tab.view) {
+            // Back to the start page the file was opened from
+            tab.stack->setCurrentIndex(0);
+            if (index == currentIndex())
+                emit currentTabChanged(index);
+            return;
+        }
+        // Nothing to show; drop the tab once the loader's signal has returned
+        QTimer::singleShot(0, this, [this, stack = QPointer<QStackedWidget>(tab.stack)]() {
+            for (int i = 0; stack && i < m_tabs.size(); ++i) {
+                if (m_tabs[i].stack == stack) {
+                    closeTab(i);
+                    break;
+                }
+            }
+        });
+        return;
+    }
+
+    tab.stack->setCurrentWidget(tab.view);
+    updateTabIcon(index);
+    // Positioned after the pending resize, as for a freshly opened file
+    restoreViewPosition(tab.view, tab.session);
+    AppSettings::instance().addRecentFile(path);
+    if (index == currentIndex())
+        emit currentTabChanged(index);
+    checkDiskChanges(index);
+}
+
+// --- External changes ---
+
+void TabManager::watchTabFiles() {
+    QSet<QString> wanted;
+    for (const TabState& tab : m_tabs) {
+        if (!tab.filePath.isEmpty() && QFileInfo::exists(tab.filePath))
+            wanted.insert(tab.filePath);
+    }
+    const QStringList watched = m_fileWatcher->files();
+    for (const QString& path : watched) {
+        if (!wanted.remove(path))
+            m_fileWatcher->removePath(path);
+    }
+    if (!wanted.isEmpty())
+        m_fileWatcher->addPaths(QStringList(wanted.cbegin(), wanted.cend()));
+}
 
-    m_tabBar->setCurrentIndex(m_tabs.size() - 1);
-    switchToTab(m_tabs.size() - 1);
+void TabManager::recordDiskState(int index) {
+    TabState& tab = m_tabs[index];
+    const QFileInfo info(tab.filePath);
+    tab.diskModified = info.lastModified();
+    tab.diskSize = info.exists() ? info.size() : -1;
+}
+
+void TabManager::checkDiskChanges(int index) {
+    if (index < 0 || index >= m_tabs.size())
+        return;
+    // Tabs that are not built yet are checked again once they are
+    const TabState& tab = m_tabs[index];
+    if (tab.filePath.isEmpty() || tab.pendingLoad || tab.loader || tab.scene->isHibernated())
+        return;
+    const QFileInfo info(tab.filePath);
+    if (!info.exists() || (info.lastModified() == tab.diskModified && info.size() == tab.diskSize))
+        return;
+    recordDiskState(index);
+
+    const QString path = tab.filePath;
+    auto* watcher = new QFutureWatcher<MindMapSerializer::ParsedMap>(this);
+    connect(watcher, &QFutureWatcher<MindMapSerializer::ParsedMap>::finished, this,
+            [this, watcher, path]() {
+                watcher->deleteLater();
+                applyDiskChanges(path, watcher->result());
+            });
+    watcher->setFuture(QtConcurrent::run([path]() {
+        return MindMapSerializer::parseFile(path, nullptr, MindMapSerializer::Chunks::Expand);
+    }));
+}
+
+void TabManager::applyDiskChanges(const QString& filePath,
+                                  const MindMapSerializer::ParsedMap& map) {
+    // A half-written file fails to parse; the writer's last step triggers again
+    int index = findTabByFilePath(filePath);
+    if (index < 0 || !map.ok)
+        return;
+    if (m_tabs[index].loader || m_tabs[index].scene->isHibernated()) {
+        m_tabs[index].diskModified = QDateTime();
+        return;
+    }
+
+    // Unsaved edits are only replaced if the user agrees; keeping them leaves
+    // the tab modified, and the next save overwrites the other program's version
+    QPointer<MindMapScene> scene = m_tabs[index].scene;
+    bool changedAgain = false;
+    if (scene->isModified()) {
+        if (m_reloadPrompts.contains(filePath)) {
+            // Written again while asking; checked once the answer is in
+            m_tabs[index].diskModified = QDateTime();
+            return;
+        }
+        m_reloadPrompts.insert(filePath);
+        const bool reload = confirmReload(index);
+        m_reloadPrompts.remove(filePath);
+
+        // The tab may have closed, moved or gone to sleep while the prompt was up
+        index = findTabByFilePath(filePath);
+        if (!scene || index < 0 || m_tabs[index].scene != scene || scene->isHibernated())
+            return;
+        changedAgain = !m_tabs[index].diskModified.isValid();
+        if (!reload) {
+            if (changedAgain)
+                checkDiskChanges(index);
+            return;
+        }
+    }
+
+    // The map now matches the file; the previous version stays one undo step away
+    const int changes = scene->syncToTree(map.tree);
+    if (changes > 0) {
+        scene->undoStack()->setClean();
+        emit tabReloaded(index, changes);
+    }
+    if (changedAgain)
+        checkDiskChanges(index);
+}
+
+bool TabManager::confirmReload(int index) {
+    QMessageBox box(m_parentWidget);
+    box.setObjectName("reloadPrompt");
+    box.setWindowTitle("YMind");
+    box.setIcon(QMessageBox::Question);
+    box.setText(tr("\"%1\" was changed by another program.")
+                    .arg(QFileInfo(m_tabs[index].filePath).fileName()));
+    box.setInformativeText(tr("Reload it and replace your unsaved changes? "
+                              "Undo brings your changes back."));
+    QPushButton* reload = box.addButton(tr("Reload"), QMessageBox::AcceptRole);
+    reload->setObjectName("reloadButton");
+    QPushButton* keep = box.addButton(tr("Keep My Changes"), QMessageBox::RejectRole);
+    keep->setObjectName("keepButton");
+    box.setDefaultButton(keep);
+    box.exec();
+    return box.clickedButton() == reload;
+}
+
+// --- Session ---
+
+bool TabManager::restoreSession(const QList<SessionTab>& tabs, int currentTab) {
+    if (tabs.isEmpty())
+        return false;
+
+    for (const SessionTab& saved : tabs) {
+        // An empty scene and a label are all a tab costs until it is shown
+        auto* placeholder =
+            new QLabel(tr("Loading %1...").arg(QFileInfo(saved.filePath).fileName()));
+        placeholder->setObjectName("tabPlaceholder");
+        placeholder->setAlignment(Qt::AlignCenter);
+
+        const int index = appendMapTab(saved.filePath, placeholder);
+        m_tabs[index].pendingLoad = true;
+        m_tabs[index].session = saved;
+    }
+
+    const int first = int(m_tabs.size() - tabs.size());
+    const int index = first + std::clamp(currentTab, 0, int(tabs.size()) - 1);
+    {
+        QSignalBlocker blocker(m_tabBar);
+        m_tabBar->setCurrentIndex(index);
+    }
+    switchToTab(index);
+    return true;
+}
+
+QList<SessionTab> TabManager::sessionTabs(int* currentTab) const {
+    QList<SessionTab> tabs;
+    if (currentTab)
+        *currentTab = 0;
+    for (int i = 0; i < m_tabs.size(); ++i) {
+        const TabState& tab = m_tabs[i];
+        if (tab.filePath.isEmpty())
+            continue;
+        if (i == currentIndex() && currentTab)
+            *currentTab = int(tabs.size());
+        // Never shown this run, still loading or hibernated: keep the position
+        // recorded then
+        SessionTab saved = tab.pendingLoad || tab.loader || tab.scene->isHibernated()
+                               ? tab.session
+                               : viewPosition(tab.view);
+        saved.filePath = tab.filePath;
+        tabs.append(saved);
+    }
+    return tabs;
+}
+
+bool TabManager::isTabLoaded(int index) const {
+    return index >= 0 && index < m_tabs.size() && !m_tabs[index].pendingLoad &&
+           !m_tabs[index].loader;
+}
+
+void TabManager::loadPendingTab(int index) {
+    TabState& tab = m_tabs[index];
+    if (!tab.pendingLoad)
+        return;
+    tab.pendingLoad = false;
+
+    QWidget* placeholder = tab.stack->widget(0);
+    tab.stack->removeWidget(placeholder);
+    delete placeholder;
+    loadTab(index, tab.filePath, tab.session);
+}
+
+// --- Hibernation ---
+
+bool TabManager::hibernateTab(int index) {
+    if (index < 0 || index >= m_tabs.size() || index == currentIndex())
+        return false;
+    TabState& tab = m_tabs[index];
+    if (tab.pendingLoad || tab.scene->isHibernated() || tab.stack->currentWidget() != tab.view)
+        return false;
+
+    const SessionTab position = viewPosition(tab.view);
+    if (!tab.scene->hibernate())
+        return false;
+    tab.session = position;
+    updateTabToolTip(index);
+    return true;
+}
+
+bool TabManager::isTabHibernated(int index) const {
+    return index >= 0 && index < m_tabs.size() && m_tabs[index].scene->isHibernated();
+}
+
+qsizetype TabManager::tabMemoryBytes(int index) const {
+    if (index < 0 || index >= m_tabs.size() || m_tabs[index].pendingLoad)
+        return 0;
+    const MindMapScene* scene = m_tabs[index].scene;
+    return scene->itemRetainedBytes() + scene->hibernatedBytes() + scene->undoRetainedBytes();
+}
+
+void TabManager::applyHibernationPolicy() {
+    const auto& settings = AppSettings::instance();
+    const qint64 now = m_clock.elapsed();
+    const int current = currentIndex();
+
+    const qint64 idleLimitMs = qint64(settings.hibernateAfterMinutes()) * 60 * 1000;
+    if (idleLimitMs > 0) {
+        for (int i = 0; i < m_tabs.size(); ++i) {
+            if (i != current && now - m_tabs[i].inactiveSinceMs >= idleLimitMs)
+                hibernateTab(i);
+        }
+    }
+
+    const qsizetype budget = qsizetype(settings.tabMemoryBudgetMB()) * 1024 * 1024;
+    if (budget > 0) {
+        qsizetype total = 0;
+        QList<int> idle;
+        for (int i = 0; i < m_tabs.size(); ++i) {
+            total += tabMemoryBytes(i);
+            if (i != current)
+                idle.append(i);
+        }
+        std::sort(idle.begin(), idle.end(), [this](int a, int b) {
+            return m_tabs[a].inactiveSinceMs < m_tabs[b].inactiveSinceMs;
+        });
+        for (int i : idle) {
+            if (total <= budget)
+                break;
+            const qsizetype before = tabMemoryBytes(i);
+            if (hibernateTab(i))
+                total -= before - tabMemoryBytes(i);
+        }
+    }
+
+    for (int i = 0; i < m_tabs.size(); ++i)
+        updateTabToolTip(i);
+}
+
+void TabManager::wakeTab(int index) {
+    TabState& tab = m_tabs[index];
+    if (!tab.scene->isHibernated())
+        return;
+    if (!tab.scene->wake()) {
+        // The stored copy is kept: the tab stays hibernated and read-only, and
+        // saving still writes the whole map
+        QMessageBox::warning(m_parentWidget, "YMind",
+                             tr("Could not restore this map for editing:\n%1\n\n"
+                                "It is kept as it was and can still be saved.")
+                                 .arg(tab.filePath.isEmpty()
+                                          ? tr("Untitled")
+                                          : QDir::toNativeSeparators(tab.filePath)));
+        tab.view->setInteractive(false);
+        updateTabToolTip(index);
+        return;
+    }
+    tab.view->setInteractive(true);
+    restoreViewPosition(tab.view, tab.session);
+    updateTabToolTip(index);
+    checkDiskChanges(index);
+}
+
+void TabManager::updateTabToolTip(int index) {
+    if (index < 0 || index >= m_tabs.size())
+        return;
+    const TabState& tab = m_tabs[index];
+    QStringList lines;
+    if (!tab.filePath.isEmpty())
+        lines.append(QDir::toNativeSeparators(tab.filePath));
+    if (!tab.pendingLoad) {
+        const qsizetype kb = tabMemoryBytes(index) / 1024;
+        lines.append(tab.scene->isHibernated() ? tr("Memory: %1 KB (hibernated)").arg(kb)
+                                               : tr("Memory: %1 KB").arg(kb));
+    }
+    m_tabBar->setTabToolTip(index, lines.join('\n'));
 }
 
 void TabManager::connectSceneSignals(MindMapScene* scene) {
@@ -163,6 +639,19 @@ void TabManager::connectSceneSignals(MindMapScene* scene) {
                 if (i == m_tabBar->currentIndex()) {
                     emit currentTabChanged(i);
                 }
+                watchTabFiles();
+                break;
+            }
+        }
+    });
+
+    // Our own writes are not external changes
+    connect(scene, &MindMapScene::fileSaved, this, [this, scene](const QString& path) {
+        for (int i = 0; i < m_tabs.size(); ++i) {
+            if (m_tabs[i].scene == scene) {
+                const QFileInfo info(path);
+                m_tabs[i].diskModified = info.lastModified();
+                m_tabs[i].diskSize = info.size();
                 break;
             }
         }
@@ -182,6 +671,12 @@ void TabManager::switchToTab(int index) {
     if (index < 0 || index >= m_tabs.size())
         return;
 
+    const int previous = m_contentStack->currentIndex();
+    if (previous >= 0 && previous < m_tabs.size() && previous != index)
+        m_tabs[previous].inactiveSinceMs = m_clock.elapsed();
+
+    loadPendingTab(index);
+    wakeTab(index);
     disconnectUndoStack();
 
     m_contentStack->setCurrentIndex(index);
@@ -215,8 +710,10 @@ void TabManager::connectUndoStack() {
     connect(stack, &QUndoStack::redoTextChanged, this, [this](const QString& text) {
         m_redoAct->setText(text.isEmpty() ? tr("&Redo") : tr("&Redo %1").arg(text));
     });
-    m_undoAct->setEnabled(stack->canUndo());
-    m_redoAct->setEnabled(stack->canRedo());
+    // The history of a map that could not be woken has no items to apply to
+    const bool editable = !scene->isHibernated();
+    m_undoAct->setEnabled(editable && stack->canUndo());
+    m_redoAct->setEnabled(editable && stack->canRedo());
 }
 
 void TabManager::updateTabText(int index) {
@@ -328,8 +825,11 @@ void TabManager::closeTab(int index) {
     m_tabBar->removeTab(index);
     m_contentStack->removeWidget(tab.stack);
 
+    // Cancels a load in progress before its scene goes
+    delete tab.loader;
     delete tab.scene;
     delete tab.stack;
+    watchTabFiles();
 
     if (m_tabs.isEmpty())
         addNewTab();
@@ -402,6 +902,7 @@ void TabManager::setCurrentFilePath(const QString& path) {
     int cur = currentIndex();
     if (cur >= 0 && cur < m_tabs.size())
         m_tabs[cur].filePath = path;
+    watchTabFiles();
 }
 
 void TabManager::notifyTabChanged(int index) {
@@ -1,21 +1,41 @@
 #pragma once
 
+#include "core/AppSettings.h"
+#include "scene/MindMapSerializer.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QList>
 #include <QObject>
+#include <QSet>
 
 
+class MapLoader;
 class MindMapScene;
 class MindMapView;
 class QTabBar;
 class QStackedWidget;
 class QToolButton;
 class QAction;
+class QFileSystemWatcher;
+class QTimer;
 
 struct TabState {
     MindMapScene* scene = nullptr;
     MindMapView* view = nullptr;
     QStackedWidget* stack = nullptr;
     QString filePath;
+    // Restored from the last session but not read from disk yet; |session| is
+    // the view position to apply once it is, or once a hibernated tab wakes
+    bool pendingLoad = false;
+    SessionTab session;
+    // When the tab was last left, on TabManager's clock
+    qint64 inactiveSinceMs = 0;
+    // Set while the file is read in the background; the tab shows a progress page
+    MapLoader* loader = nullptr;
+    // The file as this tab last read or wrote it, to tell other writers apart
+    QDateTime diskModified;
+    qint64 diskSize = -1;
 };
 
 class TabManager : public QObject {
@@ -23,12 +43,45 @@ class TabManager : public QObject {
 public:
     explicit TabManager(QWidget* parent);
 
+    // How often idle tabs are checked against the hibernation settings
+    static constexpr int kHibernateCheckMs = 30000;
+    // Quiet time after a watched file changes before it is read; writers often
+    // save in several steps
+    static constexpr int kReloadDelayMs = 300;
+
     void init(QAction* undoAct, QAction* redoAct);
 
     void addNewTab();
     void addTab(MindMapScene* scene, MindMapView* view, QStackedWidget* stack,
                 const QString& filePath);
     void closeTab(int index);
+
+    // Opens |filePath| in a new tab that shows progress while it loads
+    int openTab(const QString& filePath);
+    // Reads |filePath| into tab |index| without blocking. The tab shows a
+    // progress page until the map is built, then |position| (a zoom of 0 fits
+    // the map). Closing the tab cancels the load.
+    void loadTab(int index, const QString& filePath, const SessionTab& position = {});
+    bool isTabLoading(int index) const;
+
+    // Adds a tab per entry with a placeholder page. Only |currentTab| starts
+    // loading now; the others load the first time they are shown. Returns false
+    // if |tabs| is empty.
+    bool restoreSession(const QList<SessionTab>& tabs, int currentTab);
+    // The tabs with a file, for the next restoreSession; |currentTab| receives
+    // the position of the current tab among them
+    QList<SessionTab> sessionTabs(int* currentTab) const;
+    bool isTabLoaded(int index) const;
+
+    // A hibernated tab keeps its map compressed and its undo history, but no
+    // items; showing it rebuilds them. The current tab is never hibernated.
+    bool hibernateTab(int index);
+    bool isTabHibernated(int index) const;
+    // Approximate memory the tab's map and history hold
+    qsizetype tabMemoryBytes(int index) const;
+    // Hibernates tabs idle past the configured time, then the longest-idle ones
+    // while all tabs together exceed the memory budget
+    void applyHibernationPolicy();
     void switchToTab(int index);
     void updateTabText(int index);
     void updateTabIcon(int index);
@@ -60,11 +113,33 @@ signals:
     void currentTabChanged(int index);
     void tabTextUpdated(int index);
     void saveRequested();
+    void openFileRequested(const QString& filePath);
+    // Another program changed the tab's file and |changedNodes| were updated
+    void tabReloaded(int index, int changedNodes);
 
 private slots:
     void onTabMoved(int from, int to);
 
 private:
+    int appendTab(MindMapScene* scene, MindMapView* view, QStackedWidget* stack,
+                  const QString& filePath);
+    // A tab with a new scene and view, showing |placeholder| until it is loaded
+    int appendMapTab(const QString& filePath, QWidget* placeholder);
+    void loadPendingTab(int index);
+    void finishLoad(MapLoader* loader, bool ok);
+    void wakeTab(int index);
+    void updateTabToolTip(int index);
+
+    // External changes: every tab's file is watched; a change whose size or
+    // time differs from what the tab last read or wrote is parsed off the GUI
+    // thread and applied as one undo step through MindMapScene::syncToTree,
+    // after asking if the tab has unsaved edits
+    void watchTabFiles();
+    void recordDiskState(int index);
+    void checkDiskChanges(int index);
+    void applyDiskChanges(const QString& filePath, const MindMapSerializer::ParsedMap& map);
+    // Asks whether a change on disk may replace tab |index|'s unsaved edits
+    bool confirmReload(int index);
     void connectSceneSignals(MindMapScene* scene);
     void connectUndoStack();
     void disconnectUndoStack();
@@ -77,4 +152,10 @@ private:
     QAction* m_redoAct = nullptr;
 
     QList<TabState> m_tabs;
+    QElapsedTimer m_clock;
+    QTimer* m_hibernateTimer = nullptr;
+    QFileSystemWatcher* m_fileWatcher = nullptr;
+    QTimer* m_reloadTimer = nullptr;
+    QSet<QString> m_changedFiles;
+    QSet<QString> m_reloadPrompts;
 };
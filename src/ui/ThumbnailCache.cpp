@@ -0,0 +1,254 @@
+#include "ui/ThumbnailCache.h"
+#include "core/TemplateRegistry.h"
+#include "ui/ThemeManager.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QPainterPath>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+namespace {
+
+// Bumped whenever render() changes, so older cached PNGs are not reused
+constexpr int kRenderVersion = 1;
+
+// Node boxes are estimated from the text length rather than measured, which
+// keeps rendering free of fonts. The constants follow NodeItem's defaults.
+constexpr qreal kCharWidth = 7.5;
+constexpr qreal kNodeHeight = 51.0;
+constexpr qreal kNodePadding = 16.0;
+constexpr qreal kNodeMinWidth = 120.0;
+constexpr qreal kNodeMaxWidth = 300.0;
+constexpr qreal kNodeRadius = 10.0;
+
+struct Job {
+    QString filePath;
+    QString knownKey;
+    QString variant;
+    QString cacheDir;
+    ThumbnailCache::Palettes palettes;
+};
+
+struct Result {
+    QString filePath;
+    QString key;
+    QImage image;
+};
+
+// Removes the least recently written thumbnails beyond |keep|
+void pruneCache(const QString& cacheDir, int keep) {
+    QDir dir(cacheDir);
+    const QFileInfoList files = dir.entryInfoList({"*.png"}, QDir::Files, QDir::Time);
+    for (qsizetype i = keep; i < files.size(); ++i)
+        QFile::remove(files[i].absoluteFilePath());
+}
+
+Result loadThumbnail(const Job& job) {
+    Result result{job.filePath, ThumbnailCache::cacheKey(job.filePath, job.variant), QImage()};
+    if (result.key.isEmpty() || result.key == job.knownKey)
+        return result; // gone, or unchanged since the last check
+
+    const QString cachePath = QDir(job.cacheDir).filePath(result.key + ".png");
+    if (result.image.load(cachePath, "PNG"))
+        return result;
+
+    QFile file(job.filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return result;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+    if (!doc.isObject())
+        return result;
+
+    result.image = ThumbnailCache::render(
+        doc.object(), QSize(ThumbnailCache::kWidth, ThumbnailCache::kHeight), job.palettes);
+    if (result.image.isNull())
+        return result;
+
+    QDir().mkpath(job.cacheDir);
+    QSaveFile out(cachePath);
+    if (out.open(QIODevice::WriteOnly) && result.image.save(&out, "PNG") && out.commit())
+        pruneCache(job.cacheDir, ThumbnailCache::kMaxCachedFiles);
+    return result;
+}
+
+} // namespace
+
+ThumbnailCache& ThumbnailCache::instance() {
+    static ThumbnailCache s;
+    return s;
+}
+
+ThumbnailCache::ThumbnailCache() : QObject(nullptr) {
+    // One background thread: thumbnails trickle in without competing with the UI
+    m_pool.setMaxThreadCount(1);
+}
+
+QString ThumbnailCache::cacheDirectory() {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+        .filePath("thumbnails");
+}
+
+QString ThumbnailCache::cacheKey(const QString& filePath, const QString& variant) {
+    const QFileInfo info(filePath);
+    if (!info.isFile())
+        return QString();
+
+    QByteArray identity = info.absoluteFilePath().toUtf8();
+    identity += '\n' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    identity += '\n' + QByteArray::number(info.size());
+    identity += '\n' + variant.toUtf8() + '\n' + QByteArray::number(kRenderVersion);
+    const QByteArray hash = QCryptographicHash::hash(identity, QCryptographicHash::Sha1);
+    return QString::fromLatin1(hash.toHex());
+}
+
+ThumbnailCache::Palettes ThumbnailCache::currentPalettes() const {
+    Palettes palettes;
+    TemplateColorScheme fallback;
+    const auto& c = ThemeManager::colors();
+    std::copy(std::begin(c.nodePalette), std::end(c.nodePalette), fallback.nodePalette);
+    fallback.edgeLightenFactor = c.edgeLightenFactor;
+    palettes.insert(QString(), fallback);
+
+    for (const auto* td : TemplateRegistry::instance().allTemplates())
+        palettes.insert(td->id, td->activeColors());
+    return palettes;
+}
+
+QImage ThumbnailCache::thumbnail(const QString& filePath) {
+    const Entry entry = m_entries.value(filePath);
+    if (m_pending.contains(filePath))
+        return entry.image;
+    m_pending.insert(filePath);
+
+    Job job{filePath, entry.key, ThemeManager::isDark() ? "dark" : "light", cacheDirectory(),
+            currentPalettes()};
+    auto* watcher = new QFutureWatcher<Result>(this);
+    connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher]() {
+        const Result result = watcher->result();
+        watcher->deleteLater();
+        m_pending.remove(result.filePath);
+
+        Entry& cached = m_entries[result.filePath];
+        if (result.key == cached.key)
+            return;
+        cached = {result.key, result.image};
+        emit thumbnailReady(result.filePath, result.image);
+    });
+    watcher->setFuture(QtConcurrent::run(&m_pool, loadThumbnail, job));
+    return entry.image;
+}
+
+QImage ThumbnailCache::render(const QJsonObject& json, const QSize& size,
+                              const Palettes& palettes) {
+    if (json["format"].toString() != "ymind" || !json["root"].isObject())
+        return QImage();
+
+    QString templateId = json["templateId"].toString();
+    if (!palettes.contains(templateId))
+        templateId = TemplateRegistry::builtinIdForLayoutStyle(json["layoutStyle"].toInt(0));
+    const TemplateColorScheme colors = palettes.value(templateId, palettes.value(QString()));
+
+    // Walk the stored tree; unread chunks are drawn from their stored bounds
+    struct Shape {
+        QRectF rect;
+        QPointF parentPos;
+        int depth = 0;
+        bool hasParent = false;
+        bool chunk = false;
+    };
+    struct Frame {
+        QJsonObject node;
+        int depth;
+        QPointF parentPos;
+        bool hasParent;
+    };
+
+    const QJsonArray chunks = json["chunks"].toArray();
+    QList<Shape> shapes;
+    QRectF bounds;
+    QList<Frame> stack{{json["root"].toObject(), 0, QPointF(), false}};
+    while (!stack.isEmpty()) {
+        const Frame frame = stack.takeLast();
+        const QPointF pos(frame.node["x"].toDouble(), frame.node["y"].toDouble());
+        const qreal textWidth = frame.node["text"].toString().size() * kCharWidth;
+        const qreal width = qBound(kNodeMinWidth, textWidth + 2 * kNodePadding, kNodeMaxWidth);
+        const QRectF rect(pos.x() - width / 2, pos.y() - kNodeHeight / 2, width, kNodeHeight);
+        shapes.append({rect, frame.parentPos, frame.depth, frame.hasParent, false});
+        bounds |= rect;
+
+        if (frame.node.contains("chunk")) {
+            const QJsonArray b =
+                chunks.at(frame.node["chunk"].toInt()).toObject()["bounds"].toArray();
+            if (b.size() == 4) {
+                const QRectF area(b[0].toDouble(), b[1].toDouble(), b[2].toDouble(),
+                                  b[3].toDouble());
+                shapes.append({area, pos, frame.depth + 1, true, true});
+                bounds |= area;
+            }
+            continue;
+        }
+        for (const auto& child : frame.node["children"].toArray())
+            stack.append({child.toObject(), frame.depth + 1, pos, true});
+    }
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    if (bounds.isEmpty())
+        return image;
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    constexpr qreal margin = 8.0;
+    // Small maps keep a sensible size instead of filling the card with one node
+    const qreal scale = std::min({(size.width() - 2 * margin) / bounds.width(),
+                                  (size.height() - 2 * margin) / bounds.height(), 0.5});
+    painter.translate(size.width() / 2.0, size.height() / 2.0);
+    painter.scale(scale, scale);
+    painter.translate(-bounds.center());
+
+    auto colorAt = [&colors](int depth) { return colors.nodePalette[depth % 6]; };
+
+    // Edges first so nodes cover their ends
+    painter.setBrush(Qt::NoBrush);
+    for (const auto& shape : shapes) {
+        if (!shape.hasParent || shape.chunk)
+            continue;
+        QPen pen(colorAt(shape.depth).lighter(colors.edgeLightenFactor), 1.2);
+        pen.setCosmetic(true);
+        painter.setPen(pen);
+
+        const QPointF start = shape.parentPos;
+        const QPointF end = shape.rect.center();
+        QPainterPath path(start);
+        if (qAbs(end.x() - start.x()) > 10) {
+            const qreal mx = (start.x() + end.x()) / 2;
+            path.cubicTo(mx, start.y(), mx, end.y(), end.x(), end.y());
+        } else {
+            const qreal my = (start.y() + end.y()) / 2;
+            path.cubicTo(start.x(), my, end.x(), my, end.x(), end.y());
+        }
+        painter.drawPath(path);
+    }
+
+    painter.setPen(Qt::NoPen);
+    for (const auto& shape : shapes) {
+        QColor fill = colorAt(shape.depth);
+        if (shape.chunk)
+            fill.setAlphaF(0.3);
+        painter.setBrush(fill);
+        painter.drawRoundedRect(shape.rect, kNodeRadius, kNodeRadius);
+    }
+    return image;
+}
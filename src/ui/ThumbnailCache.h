@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/TemplateDescriptor.h"
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+
+class QJsonObject;
+
+// Thumbnails for the start page's recent-files grid. A thumbnail is drawn on a
+// worker thread from the node positions stored in the saved file (no scene is
+// built) and written as a PNG under the cache location, keyed by the file's
+// path, modification time and size, so later launches only read it back.
+class ThumbnailCache : public QObject {
+    Q_OBJECT
+
+public:
+    // Rendered at twice the card's icon size for high-DPI screens
+    static constexpr int kWidth = 320;
+    static constexpr int kHeight = 208;
+    // Cached PNGs kept on disk before the oldest are pruned
+    static constexpr int kMaxCachedFiles = 200;
+
+    // Color schemes by template id; the empty id holds the fallback scheme
+    using Palettes = QHash<QString, TemplateColorScheme>;
+
+    static ThumbnailCache& instance();
+
+    // Returns the last thumbnail seen for |filePath| (null if there is none yet)
+    // and schedules a background check. thumbnailReady() follows if the file has
+    // a new or changed thumbnail.
+    QImage thumbnail(const QString& filePath);
+
+    // Draws a saved map into an image of |size|. Safe to call from any thread.
+    static QImage render(const QJsonObject& json, const QSize& size, const Palettes& palettes);
+
+    // Key for |filePath| as it is on disk now; empty if the file does not exist.
+    // |variant| separates renderings of the same file (e.g. light and dark).
+    static QString cacheKey(const QString& filePath, const QString& variant);
+    static QString cacheDirectory();
+
+signals:
+    void thumbnailReady(const QString& filePath, const QImage& image);
+
+private:
+    ThumbnailCache();
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    struct Entry {
+        QString key;
+        QImage image;
+    };
+
+    Palettes currentPalettes() const;
+
+    QHash<QString, Entry> m_entries;
+    QSet<QString> m_pending;
+    QThreadPool m_pool;
+};
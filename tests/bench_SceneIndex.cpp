@@ -0,0 +1,117 @@
+#include "core/TemplateRegistry.h"
+#include "layout/LayoutAlgorithmRegistry.h"
+#include "scene/MindMapScene.h"
+#include "scene/NodeTree.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+#include <QtMath>
+
+#include <cmath>
+
+// Hit-test and viewport query latency on large maps, comparing the old fixed
+// +/-5000 scene rect with Qt's default depth against the tracked rect and tuned
+// BSP depth. Not part of ctest; run by hand:
+//   ./bench_SceneIndex -platform offscreen
+class bench_SceneIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void hitTest_data();
+    void hitTest();
+    void viewportQuery_data();
+    void viewportQuery();
+
+private:
+    static void addRows();
+    static void buildScene(MindMapScene& scene, int nodeCount, bool tracked);
+    static QList<QPointF> samplePoints(const QRectF& bounds, int count);
+};
+
+void bench_SceneIndex::initTestCase() {
+    TemplateRegistry::instance().loadBuiltins();
+    LayoutAlgorithmRegistry::instance().registerBuiltins();
+}
+
+void bench_SceneIndex::addRows() {
+    QTest::addColumn<int>("nodeCount");
+    QTest::addColumn<bool>("tracked");
+    for (int count : {10000, 50000, 100000}) {
+        QTest::addRow("%dk fixed", count / 1000) << count << false;
+        QTest::addRow("%dk tracked", count / 1000) << count << true;
+    }
+}
+
+void bench_SceneIndex::buildScene(MindMapScene& scene, int nodeCount, bool tracked) {
+    // A root with 100 branches, leaves laid out on a grid far wider than 10000
+    NodeTree tree;
+    tree.append("Root", -1);
+    const int columns = qCeil(std::sqrt(qreal(nodeCount)));
+    for (int i = 1; i < nodeCount; ++i) {
+        const int parent = i <= 100 ? 0 : 1 + i % 100;
+        const int index = tree.append(QString("Node %1").arg(i), parent);
+        tree.entries[index].pos = QPointF((i % columns) * 220.0, (i / columns) * 80.0);
+    }
+    scene.buildTree(tree);
+
+    if (!tracked) {
+        scene.setSceneRect(-5000, -5000, 10000, 10000);
+        scene.setBspTreeDepth(0);
+    }
+    // The index is built lazily; do it before timing
+    scene.items(QPointF());
+}
+
+QList<QPointF> bench_SceneIndex::samplePoints(const QRectF& bounds, int count) {
+    QRandomGenerator rng(42);
+    QList<QPointF> points;
+    points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        points.append(QPointF(bounds.left() + rng.generateDouble() * bounds.width(),
+                              bounds.top() + rng.generateDouble() * bounds.height()));
+    }
+    return points;
+}
+
+void bench_SceneIndex::hitTest_data() {
+    addRows();
+}
+
+void bench_SceneIndex::hitTest() {
+    QFETCH(int, nodeCount);
+    QFETCH(bool, tracked);
+    MindMapScene scene;
+    buildScene(scene, nodeCount, tracked);
+    const QList<QPointF> points = samplePoints(scene.itemsBoundingRect(), 1000);
+
+    qsizetype hits = 0;
+    QBENCHMARK {
+        for (const auto& point : points)
+            hits += scene.items(point).size();
+    }
+    QVERIFY(hits > 0);
+}
+
+void bench_SceneIndex::viewportQuery_data() {
+    addRows();
+}
+
+void bench_SceneIndex::viewportQuery() {
+    QFETCH(int, nodeCount);
+    QFETCH(bool, tracked);
+    MindMapScene scene;
+    buildScene(scene, nodeCount, tracked);
+    const QList<QPointF> corners = samplePoints(scene.itemsBoundingRect(), 200);
+
+    // About what a maximised window shows at 100% zoom
+    qsizetype found = 0;
+    QBENCHMARK {
+        for (const auto& corner : corners)
+            found += scene.items(QRectF(corner, QSizeF(1600, 1000))).size();
+    }
+    QVERIFY(found > 0);
+}
+
+QTEST_MAIN(bench_SceneIndex)
+#include "bench_SceneIndex.moc"
@@ -0,0 +1,51 @@
+#include "scene/SearchIndex.h"
+
+#include <QTest>
+
+// Query latency of the full-text index on a large map with a small, repeated
+// vocabulary. Not part of ctest; run by hand:
+//   ./bench_SearchIndex
+class bench_SearchIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void query_data();
+    void query();
+
+private:
+    SearchIndex m_index;
+};
+
+void bench_SearchIndex::initTestCase() {
+    const QStringList words = {"project", "review", "budget", "design", "launch",
+                               "market",  "team",   "risk",   "goal",   "plan"};
+    for (int i = 0; i < 100000; ++i) {
+        m_index.addNode(quint64(i + 1), QString("%1 %2 item%3")
+                                            .arg(words[i % words.size()],
+                                                 words[(i / 10) % words.size()])
+                                            .arg(i));
+    }
+}
+
+void bench_SearchIndex::query_data() {
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<int>("hits");
+    QTest::addRow("narrow") << "item4242" << 11;
+    QTest::addRow("broad") << "budget rev" << 2000;
+    QTest::addRow("one word") << "budget" << 19000;
+}
+
+void bench_SearchIndex::query() {
+    QFETCH(QString, query);
+    QFETCH(int, hits);
+
+    QList<quint64> found;
+    QBENCHMARK {
+        found = m_index.find(query);
+    }
+    QCOMPARE(found.size(), hits);
+}
+
+QTEST_MAIN(bench_SearchIndex)
+#include "bench_SearchIndex.moc"
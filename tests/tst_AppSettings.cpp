@@ -1,6 +1,7 @@
 #include "core/AppSettings.h"
 
 #include <QCoreApplication>
+#include <QFileInfo>
 #include <QSignalSpy>
 #include <QTest>
 
@@ -20,6 +21,9 @@ private slots:
     void fontSizeSignal();
     void fontFamilyRoundTrip();
     void fontFamilySignal();
+    void viewportUpdateModeSignal();
+    void recentFilesOrderAndLimit();
+    void sessionRoundTrip();
 };
 
 void tst_AppSettings::initTestCase() {
@@ -29,6 +33,7 @@ void tst_AppSettings::initTestCase() {
     QCoreApplication::setApplicationName("tst_AppSettings");
 
     qRegisterMetaType<AppTheme>("AppTheme");
+    qRegisterMetaType<ViewportUpdateMode>("ViewportUpdateMode");
 }
 
 void tst_AppSettings::themeRoundTrip() {
@@ -142,5 +147,87 @@ void tst_AppSettings::fontFamilySignal() {
     QCOMPARE(spy.count(), 0);
 }
 
+void tst_AppSettings::viewportUpdateModeSignal() {
+    auto& s = AppSettings::instance();
+    s.setViewportUpdateMode(ViewportUpdateMode::Automatic); // ensure known state
+
+    QSignalSpy spy(&s, &AppSettings::viewportUpdateModeChanged);
+    QVERIFY(spy.isValid());
+
+    s.setViewportUpdateMode(ViewportUpdateMode::Minimal);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(s.viewportUpdateMode(), ViewportUpdateMode::Minimal);
+
+    // Same value should NOT emit
+    spy.clear();
+    s.setViewportUpdateMode(ViewportUpdateMode::Minimal);
+    QCOMPARE(spy.count(), 0);
+
+    s.setViewportUpdateMode(ViewportUpdateMode::Automatic);
+}
+
+void tst_AppSettings::recentFilesOrderAndLimit() {
+    auto& s = AppSettings::instance();
+    for (const QString& path : s.recentFiles())
+        s.removeRecentFile(path);
+    QVERIFY(s.recentFiles().isEmpty());
+
+    QSignalSpy spy(&s, &AppSettings::recentFilesChanged);
+    QVERIFY(spy.isValid());
+
+    // Paths are stored absolute
+    const QString a = QFileInfo("/maps/a.ymind").absoluteFilePath();
+    const QString b = QFileInfo("/maps/b.ymind").absoluteFilePath();
+    s.addRecentFile(a);
+    s.addRecentFile(b);
+    s.addRecentFile(a); // moves back to the front
+    QCOMPARE(s.recentFiles(), QStringList({a, b}));
+    QCOMPARE(spy.count(), 3);
+
+    // Re-adding the most recent file should NOT emit
+    spy.clear();
+    s.addRecentFile(a);
+    QCOMPARE(spy.count(), 0);
+
+    for (int i = 0; i < AppSettings::kMaxRecentFiles + 5; ++i)
+        s.addRecentFile(QString("/maps/%1.ymind").arg(i));
+    QCOMPARE(s.recentFiles().size(), AppSettings::kMaxRecentFiles);
+    QCOMPARE(s.recentFiles().first(),
+             QFileInfo(QString("/maps/%1.ymind").arg(AppSettings::kMaxRecentFiles + 4))
+                 .absoluteFilePath());
+
+    s.removeRecentFile(s.recentFiles().first());
+    QCOMPARE(s.recentFiles().size(), AppSettings::kMaxRecentFiles - 1);
+}
+
+void tst_AppSettings::sessionRoundTrip() {
+    auto& s = AppSettings::instance();
+    QVERIFY(s.restoreSessionEnabled());
+
+    SessionTab a{"/maps/a.ymind", 1.5, QPointF(120, -40)};
+    SessionTab b{"/maps/b.ymind", 0.0, QPointF()};
+    SessionTab c{"/maps/c.ymind", 0.75, QPointF(3, 4)};
+    s.setSession({a, b, c}, 2);
+    QCOMPARE(s.sessionCurrentTab(), 2);
+    QList<SessionTab> tabs = s.sessionTabs();
+    QCOMPARE(tabs.size(), 3);
+    QCOMPARE(tabs[0].filePath, a.filePath);
+    QCOMPARE(tabs[0].zoom, 1.5);
+    QCOMPARE(tabs[0].center, QPointF(120, -40));
+    QCOMPARE(tabs[1].zoom, 0.0);
+
+    // A shorter session replaces the old one entirely
+    s.setSession({b}, 0);
+    tabs = s.sessionTabs();
+    QCOMPARE(tabs.size(), 1);
+    QCOMPARE(tabs[0].filePath, b.filePath);
+
+    s.setRestoreSessionEnabled(false);
+    QVERIFY(!s.restoreSessionEnabled());
+    s.setRestoreSessionEnabled(true);
+    s.setSession({}, 0);
+    QVERIFY(s.sessionTabs().isEmpty());
+}
+
 QTEST_MAIN(tst_AppSettings)
 #include "tst_AppSettings.moc"
@@ -0,0 +1,85 @@
+#include "core/BatchConverter.h"
+#include "core/TemplateRegistry.h"
+#include "layout/LayoutAlgorithmRegistry.h"
+#include "scene/MindMapScene.h"
+#include "scene/NodeItem.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+class tst_BatchConverter : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void convertToEveryFormat_data();
+    void convertToEveryFormat();
+    void convertRejectsUnknownFormat();
+    void convertReportsMissingInput();
+    void batchRejectsBadArguments();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_input;
+};
+
+void tst_BatchConverter::initTestCase() {
+    TemplateRegistry::instance().loadBuiltins();
+    LayoutAlgorithmRegistry::instance().registerBuiltins();
+
+    QVERIFY(m_dir.isValid());
+    m_input = m_dir.filePath("map.ymind");
+    MindMapScene scene;
+    scene.rootNode()->setText("Root");
+    auto* a = scene.addNode("Alpha", scene.rootNode());
+    scene.addNode("Alpha child", a);
+    scene.addNode("Beta", scene.rootNode());
+    QVERIFY(scene.saveToFile(m_input));
+}
+
+void tst_BatchConverter::convertToEveryFormat_data() {
+    QTest::addColumn<QString>("format");
+    for (const QString& format : BatchConverter::supportedFormats())
+        QTest::newRow(qPrintable(format)) << format;
+}
+
+void tst_BatchConverter::convertToEveryFormat() {
+    QFETCH(QString, format);
+    const QString output = m_dir.filePath("out." + format);
+
+    QString error;
+    QVERIFY2(BatchConverter::convertFile(m_input, output, &error), qPrintable(error));
+    QVERIFY(QFileInfo(output).size() > 0);
+
+    if (format == "md" || format == "txt") {
+        QFile file(output);
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        QVERIFY(QString::fromUtf8(file.readAll()).contains("Alpha child"));
+    }
+}
+
+void tst_BatchConverter::convertRejectsUnknownFormat() {
+    QString error;
+    QVERIFY(!BatchConverter::convertFile(m_input, m_dir.filePath("out.docx"), &error));
+    QVERIFY(!error.isEmpty());
+    QVERIFY(!QFileInfo::exists(m_dir.filePath("out.docx")));
+}
+
+void tst_BatchConverter::convertReportsMissingInput() {
+    QString error;
+    QVERIFY(!BatchConverter::convertFile(m_dir.filePath("missing.ymind"),
+                                         m_dir.filePath("missing.png"), &error));
+    QVERIFY(error.contains("missing.ymind"));
+}
+
+void tst_BatchConverter::batchRejectsBadArguments() {
+    BatchConverter converter;
+    QCOMPARE(converter.runBatch(m_dir.filePath("no-such-dir"), "png", QString(), 1), 2);
+    QCOMPARE(converter.runBatch(m_dir.path(), "docx", QString(), 1), 2);
+}
+
+QTEST_MAIN(tst_BatchConverter)
+#include "tst_BatchConverter.moc"
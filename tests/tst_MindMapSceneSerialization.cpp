@@ -1,11 +1,30 @@
+#include "core/AppSettings.h"
+#include "core/Commands.h"
 #include "core/TemplateRegistry.h"
 #include "layout/LayoutAlgorithmRegistry.h"
+#include "scene/EdgeItem.h"
+#include "scene/MapLoader.h"
+#include "scene/MindMapExporter.h"
 #include "scene/MindMapScene.h"
+#include "scene/MindMapSerializer.h"
 #include "scene/NodeItem.h"
 
+#include <QApplication>
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
 #include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
+#include <QPainter>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTemporaryDir>
 #include <QTest>
+#include <QUndoStack>
+#include <QXmlStreamReader>
+#include <QtSvg/QSvgGenerator>
 
 class tst_MindMapSceneSerialization : public QObject {
     Q_OBJECT
@@ -18,10 +37,34 @@ private slots:
     void fromJsonInvalidFormat();
     void fromJsonMissingRoot();
     void fromJsonV1LayoutStyleMigration();
+    void chunkedBranchLoadsOnDemand();
+    void chunkedBranchesStayUnread();
+    void mapLoaderBuildsInSlices();
+    void saveDuringLoadKeepsFile();
+    void nodeIdsRoundTrip();
+    void nodeIdIndexFollowsUndo();
+    void removeUndoRebuildsFromSnapshot();
+    void undoCommandsMerge();
+    void undoLimitAndRetainedBytes();
+    void hibernateKeepsHistory();
+    void failedWakeKeepsMap();
+    void syncAppliesOnlyChanges();
+    void scheduledLayoutCoalesces();
+    void deleteSelectionIsOneStep();
+    void reparentSelectionIsOneStep();
+    void dragSelectionIsOneStep();
+    void clickOnOverlapIsNotADrop();
+    void sceneRectTracksContent();
+    void searchFollowsEdits();
     void exportToText();
     void exportToMarkdown();
+    void exportToDeviceStreamsDeepMaps();
+    void exportToPngTiled();
+    void exportToSvgFromModel();
+    void exportToPdfPaginated();
     void importFromText();
     void importFromTextEmpty();
+    void importTreeLaysOutImmediately();
 };
 
 void tst_MindMapSceneSerialization::initTestCase() {
@@ -114,6 +157,688 @@ void tst_MindMapSceneSerialization::fromJsonV1LayoutStyleMigration() {
     QCOMPARE(scene.layoutStyle(), LayoutStyle::TopDown);
 }
 
+void tst_MindMapSceneSerialization::chunkedBranchLoadsOnDemand() {
+    const int bigCount = MindMapSerializer::kChunkNodeThreshold;
+
+    MindMapScene scene1;
+    scene1.rootNode()->setText("Root");
+    auto* big = scene1.addNode("Big", scene1.rootNode());
+    for (int i = 0; i < bigCount; ++i)
+        scene1.addNode(QString("Item %1").arg(i), big);
+    scene1.addNode("Small", scene1.rootNode());
+
+    QJsonObject json = scene1.toJson();
+    QCOMPARE(json["version"].toInt(), 3);
+    QCOMPARE(json["chunks"].toArray().size(), 1);
+
+    QJsonArray rootChildren = json["root"].toObject()["children"].toArray();
+    QCOMPARE(rootChildren[0].toObject()["text"].toString(), QString("Big"));
+    QVERIFY(rootChildren[0].toObject().contains("chunk"));
+    QVERIFY(!rootChildren[1].toObject().contains("chunk"));
+
+    QJsonObject chunk = json["chunks"].toArray()[0].toObject();
+    QCOMPARE(chunk["nodeCount"].toInt(), bigCount);
+    QCOMPARE(chunk["text"].toString(), QString("Big"));
+
+    // Only the summary is read up front
+    MindMapScene scene2;
+    QVERIFY(scene2.fromJson(json));
+    auto* loadedBig = scene2.rootNode()->childNodes()[0];
+    QVERIFY(scene2.hasPendingChunks());
+    QVERIFY(scene2.isChunkPending(loadedBig));
+    QVERIFY(loadedBig->childNodes().isEmpty());
+
+    // Saving an unread branch passes the stored chunk through unchanged
+    QJsonObject resaved = scene2.toJson();
+    QCOMPARE(resaved["chunks"].toArray().size(), 1);
+    QCOMPARE(resaved["chunks"].toArray()[0].toObject()["nodeCount"].toInt(), bigCount);
+
+    scene2.ensureAllLoaded();
+    QVERIFY(!scene2.hasPendingChunks());
+    QCOMPARE(loadedBig->childNodes().size(), bigCount);
+    QCOMPARE(loadedBig->childNodes()[0]->text(), QString("Item 0"));
+}
+
+void tst_MindMapSceneSerialization::chunkedBranchesStayUnread() {
+    const int bigCount = MindMapSerializer::kChunkNodeThreshold;
+    MindMapScene source;
+    source.rootNode()->setText("Root");
+    auto* alpha = source.addNode("Alpha", source.rootNode());
+    auto* beta = source.addNode("Beta", source.rootNode());
+    for (int i = 0; i < bigCount; ++i) {
+        source.addNode(QString("Alpha %1").arg(i), alpha);
+        source.addNode(QString("Beta %1").arg(i), beta);
+    }
+    const QByteArray data = QJsonDocument(source.toJson()).toJson(QJsonDocument::Compact);
+
+    // The chunks are kept as text; only the tree above them is parsed
+    const auto map = MindMapSerializer::parseData(data);
+    QVERIFY(map.ok);
+    QCOMPARE(map.tree.size(), 3);
+    QCOMPARE(map.chunks.size(), 2);
+    QCOMPARE(map.chunks[0].nodeCount, bigCount);
+    QCOMPARE(QJsonDocument::fromJson(map.chunks[0].children).array().size(), bigCount);
+    const auto expanded =
+        MindMapSerializer::parseData(data, nullptr, MindMapSerializer::Chunks::Expand);
+    QCOMPARE(expanded.tree.size(), 3 + 2 * bigCount);
+
+    MindMapScene scene;
+    QVERIFY(scene.fromJson(source.toJson()));
+    auto* loadedAlpha = scene.rootNode()->childNodes()[0];
+    auto* loadedBeta = scene.rootNode()->childNodes()[1];
+
+    // Layout places unread branches as blocks
+    scene.autoLayout(false);
+    QVERIFY(scene.isChunkPending(loadedAlpha));
+    QVERIFY(scene.isChunkPending(loadedBeta));
+
+    // A search reads the stored text and builds only the branch it found
+    const auto found = scene.findNodes("Beta 7");
+    QVERIFY(!found.isEmpty());
+    QCOMPARE(found.first()->parentNode(), loadedBeta);
+    QVERIFY(!scene.isChunkPending(loadedBeta));
+    QVERIFY(scene.isChunkPending(loadedAlpha));
+    QVERIFY(loadedAlpha->childNodes().isEmpty());
+}
+
+void tst_MindMapSceneSerialization::mapLoaderBuildsInSlices() {
+    const int bigCount = MindMapSerializer::kChunkNodeThreshold;
+    MindMapScene source;
+    source.rootNode()->setText("Root");
+    auto* big = source.addNode("Big", source.rootNode());
+    for (int i = 0; i < bigCount; ++i)
+        source.addNode(QString("Item %1").arg(i), big);
+    for (int i = 0; i < 5000; ++i)
+        source.addNode(QString("Topic %1").arg(i), source.rootNode());
+    QTemporaryDir dir;
+    const QString path = dir.filePath("large.ymind");
+    QVERIFY(source.saveToFile(path));
+
+    // Built a slice at a time, then published with one reset
+    MindMapScene scene;
+    QSignalSpy reset(&scene, &MindMapScene::treeReset);
+    QSignalSpy loaded(&scene, &MindMapScene::fileLoaded);
+    MapLoader loader(&scene, path);
+    QSignalSpy progress(&loader, &MapLoader::progress);
+    QSignalSpy finished(&loader, &MapLoader::finished);
+    loader.start();
+    QTRY_COMPARE(finished.count(), 1);
+    QVERIFY(finished.first().at(0).toBool());
+    QCOMPARE(loaded.count(), 1);
+    QCOMPARE(progress.first().at(1).toInt(), -1);
+
+    // Each slice reports more of the same total: the root, its 5001 children
+    // and nothing from the chunk
+    QVERIFY(progress.count() >= 2);
+    int done = 0;
+    for (qsizetype i = 1; i < progress.count(); ++i) {
+        QVERIFY(progress.at(i).at(0).toInt() > done);
+        done = progress.at(i).at(0).toInt();
+        QCOMPARE(progress.at(i).at(1).toInt(), 5002);
+    }
+    QCOMPARE(done, 5002);
+
+    // Same map, IDs and unread chunk as a blocking load
+    MindMapScene blocking;
+    QVERIFY(blocking.loadFromFile(path));
+    QCOMPARE(scene.nodeCount(), blocking.nodeCount());
+    QCOMPARE(scene.rootNode()->id(), blocking.rootNode()->id());
+    QCOMPARE(scene.rootNode()->childNodes().size(), 5001);
+    QVERIFY(scene.isChunkPending(scene.rootNode()->childAt(0)));
+    QVERIFY(!scene.isModified());
+    QCOMPARE(scene.undoStack()->count(), 0);
+    const int resets = int(reset.count());
+
+    // A failed load leaves the scene alone
+    MapLoader missing(&scene, dir.filePath("missing.ymind"));
+    QSignalSpy failed(&missing, &MapLoader::finished);
+    missing.start();
+    QTRY_COMPARE(failed.count(), 1);
+    QVERIFY(!failed.first().at(0).toBool());
+    QCOMPARE(reset.count(), resets);
+    QCOMPARE(scene.rootNode()->text(), QString("Root"));
+}
+
+void tst_MindMapSceneSerialization::saveDuringLoadKeepsFile() {
+    const int count = 20000;
+    NodeTree tree;
+    const int r = tree.append("Root", -1);
+    for (int i = 0; i < count; ++i)
+        tree.append(QString("Topic %1").arg(i), r);
+    MindMapScene source;
+    QVERIFY(source.buildTree(tree));
+    QTemporaryDir dir;
+    const QString path = dir.filePath("opening.ymind");
+    QVERIFY(source.saveToFile(path));
+    const qint64 size = QFileInfo(path).size();
+
+    // Ctrl+S between two slices must not write the half-built map over the file
+    MindMapScene scene;
+    MapLoader loader(&scene, path);
+    bool midBuild = false;
+    bool saved = true;
+    QJsonObject json;
+    connect(&loader, &MapLoader::progress, this, [&](int done, int total) {
+        if (midBuild || total <= 0 || done >= total)
+            return;
+        midBuild = scene.isLoading();
+        saved = scene.saveToFile(path);
+        json = scene.toJson();
+    });
+    QSignalSpy finished(&loader, &MapLoader::finished);
+    loader.start();
+    QTRY_COMPARE(finished.count(), 1);
+    QVERIFY(midBuild);
+    QVERIFY(!saved);
+    QVERIFY(json.isEmpty());
+    QCOMPARE(QFileInfo(path).size(), size);
+
+    QVERIFY(!scene.isLoading());
+    QCOMPARE(scene.nodeCount(), count + 1);
+    QVERIFY(!scene.isModified());
+    MindMapScene reread;
+    QVERIFY(reread.loadFromFile(path));
+    QCOMPARE(reread.nodeCount(), count + 1);
+}
+
+void tst_MindMapSceneSerialization::nodeIdsRoundTrip() {
+    MindMapScene scene1;
+    auto* a = scene1.addNode("A", scene1.rootNode());
+    auto* a1 = scene1.addNode("A1", a);
+    QVERIFY(a->id() != 0);
+    QVERIFY(a->id() != a1->id());
+    QCOMPARE(scene1.nodeById(a1->id()), a1);
+
+    QJsonObject json = scene1.toJson();
+    QVERIFY(json["root"].toObject().contains("id"));
+
+    MindMapScene scene2;
+    QVERIFY(scene2.fromJson(json));
+    QCOMPARE(scene2.rootNode()->id(), scene1.rootNode()->id());
+    auto* loadedA1 = scene2.nodeById(a1->id());
+    QVERIFY(loadedA1 != nullptr);
+    QCOMPARE(loadedA1->text(), QString("A1"));
+    QCOMPARE(loadedA1->parentNode()->id(), a->id());
+}
+
+void tst_MindMapSceneSerialization::nodeIdIndexFollowsUndo() {
+    MindMapScene scene;
+    auto* a = scene.addNode("A", scene.rootNode());
+    auto* a1 = scene.addNode("A1", a);
+    const quint64 aId = a->id();
+    const quint64 a1Id = a1->id();
+
+    scene.undoStack()->push(new RemoveNodeCommand(&scene, a));
+    QVERIFY(scene.nodeById(aId) == nullptr);
+    QVERIFY(scene.nodeById(a1Id) == nullptr);
+
+    scene.undoStack()->undo();
+    QVERIFY(scene.nodeById(aId) != nullptr);
+    QCOMPARE(scene.nodeById(a1Id)->text(), QString("A1"));
+    QCOMPARE(scene.nodeById(a1Id)->parentNode()->id(), aId);
+}
+
+void tst_MindMapSceneSerialization::removeUndoRebuildsFromSnapshot() {
+    MindMapScene scene;
+    auto* root = scene.rootNode();
+    scene.addNode("A", root);
+    auto* b = scene.addNode("B", root);
+    scene.addNode("C", root);
+    auto* b1 = scene.addNode("B1", b);
+    scene.addNode("B1a", b1);
+    scene.addNode("B2", b);
+    const quint64 bId = b->id();
+    const quint64 b1Id = b1->id();
+    const QPointF b1Pos = b1->pos();
+    auto countEdges = [&scene]() {
+        int count = 0;
+        for (auto* item : scene.items())
+            count += dynamic_cast<EdgeItem*>(item) ? 1 : 0;
+        return count;
+    };
+    const int edgeCount = countEdges();
+
+    auto* stack = scene.undoStack();
+    stack->push(new EditTextCommand(&scene, b1, "B1", "Beta one"));
+    stack->push(new RemoveNodeCommand(&scene, b));
+    QCOMPARE(root->childNodes().size(), 2);
+    QCOMPARE(countEdges(), edgeCount - 4);
+
+    // The branch comes back in place, with its IDs, positions and edges
+    stack->undo();
+    QCOMPARE(root->childNodes().size(), 3);
+    QCOMPARE(root->childNodes()[1]->id(), bId);
+    auto* restored = scene.nodeById(b1Id);
+    QVERIFY(restored);
+    QCOMPARE(restored->text(), QString("Beta one"));
+    QCOMPARE(restored->pos(), b1Pos);
+    QCOMPARE(restored->childNodes().size(), 1);
+    QCOMPARE(countEdges(), edgeCount);
+    QVERIFY(scene.findEdge(restored, restored->childNodes().first()));
+
+    // Older commands still find the rebuilt node through its ID
+    stack->undo();
+    QCOMPARE(scene.nodeById(b1Id)->text(), QString("B1"));
+    stack->redo();
+    stack->redo();
+    QVERIFY(scene.nodeById(bId) == nullptr);
+    stack->undo();
+    QCOMPARE(scene.nodeById(b1Id)->text(), QString("Beta one"));
+}
+
+void tst_MindMapSceneSerialization::undoCommandsMerge() {
+    MindMapScene scene;
+    auto* a = scene.addNode("A", scene.rootNode());
+    auto* b = scene.addNode("B", scene.rootNode());
+    auto* stack = scene.undoStack();
+
+    // Moving back to where the step started leaves nothing to undo
+    const QPointF bOrigin = b->pos();
+    b->moveSubtree(QPointF(0, 10));
+    stack->push(new MoveNodeCommand(b, bOrigin, b->pos()));
+    QCOMPARE(stack->count(), 1);
+    b->moveSubtree(QPointF(0, -10));
+    stack->push(new MoveNodeCommand(b, bOrigin + QPointF(0, 10), b->pos()));
+    QCOMPARE(stack->count(), 0);
+
+    // Thirty nudges of the same node are one undo step
+    const QPointF origin = a->pos();
+    for (int i = 0; i < 30; ++i) {
+        const QPointF oldPos = a->pos();
+        a->moveSubtree(QPointF(5, 0));
+        stack->push(new MoveNodeCommand(a, oldPos, a->pos()));
+    }
+    QCOMPARE(stack->count(), 1);
+    stack->undo();
+    QCOMPARE(a->pos(), origin);
+    stack->redo();
+    QCOMPARE(a->pos(), origin + QPointF(150, 0));
+
+    // Rapid edits of the same text merge; an edit of another node does not
+    stack->push(new EditTextCommand(&scene, a, "A", "Al"));
+    stack->push(new EditTextCommand(&scene, a, "Al", "Alpha"));
+    QCOMPARE(stack->count(), 2);
+    stack->push(new EditTextCommand(&scene, b, "B", "Beta"));
+    QCOMPARE(stack->count(), 3);
+
+    stack->undo();
+    stack->undo();
+    QCOMPARE(a->text(), QString("A"));
+    QCOMPARE(b->text(), QString("B"));
+}
+
+void tst_MindMapSceneSerialization::undoLimitAndRetainedBytes() {
+    auto& settings = AppSettings::instance();
+    const int savedLimit = settings.undoLimit();
+    settings.setUndoLimit(3);
+
+    MindMapScene scene;
+    MindMapScene untouched;
+    QCOMPARE(scene.undoStack()->undoLimit(), 3);
+    QCOMPARE(scene.undoRetainedBytes(), qsizetype(0));
+
+    auto* a = scene.addNode("A", scene.rootNode());
+    for (int i = 0; i < 5; ++i)
+        scene.addNode(QString("A%1").arg(i), a);
+    scene.undoStack()->push(new EditTextCommand(&scene, a, "A", "Alpha"));
+    const qsizetype editBytes = scene.undoRetainedBytes();
+    QVERIFY(editBytes > 0);
+
+    // A removed subtree is held by the stack until the step is dropped
+    scene.undoStack()->push(new RemoveNodeCommand(&scene, a));
+    QVERIFY(scene.undoRetainedBytes() > editBytes);
+
+    for (int i = 0; i < 5; ++i)
+        scene.undoStack()->push(new AddNodeCommand(&scene, scene.rootNode(), "X"));
+    QCOMPARE(scene.undoStack()->count(), 3);
+
+    // A new limit applies at once to a map without history, and to the
+    // others once their history is reset
+    settings.setUndoLimit(0);
+    QCOMPARE(untouched.undoStack()->undoLimit(), 0);
+    QCOMPARE(scene.undoStack()->undoLimit(), 3);
+    scene.clearScene();
+    QCOMPARE(scene.undoStack()->undoLimit(), 0);
+
+    settings.setUndoLimit(savedLimit);
+}
+
+void tst_MindMapSceneSerialization::hibernateKeepsHistory() {
+    MindMapScene scene;
+    auto* root = scene.rootNode();
+    for (int i = 0; i < 200; ++i)
+        scene.addNode(QString("Topic %1").arg(i), root);
+    auto* edited = root->childAt(42);
+    const quint64 editedId = edited->id();
+    scene.undoStack()->push(new EditTextCommand(&scene, edited, edited->text(), "Renamed"));
+    scene.setModified(true);
+    const qsizetype itemBytes = scene.itemRetainedBytes();
+
+    // The items go; a compressed copy smaller than them stays
+    QSignalSpy reset(&scene, &MindMapScene::treeReset);
+    QVERIFY(scene.hibernate());
+    QVERIFY(scene.isHibernated());
+    QVERIFY(!scene.hibernate());
+    QCOMPARE(reset.count(), 1);
+    QCOMPARE(scene.rootNode(), nullptr);
+    QVERIFY(scene.items().isEmpty());
+    QCOMPARE(scene.itemRetainedBytes(), 0);
+    QVERIFY(scene.hibernatedBytes() > 0);
+    QVERIFY(scene.hibernatedBytes() < itemBytes);
+    QVERIFY(scene.isModified());
+    QCOMPARE(scene.undoStack()->count(), 1);
+
+    // Saving reads the stored copy
+    QCOMPARE(scene.toJson()["root"].toObject()["children"].toArray().size(), 200);
+    QTemporaryDir dir;
+    const QString path = dir.filePath("hibernated.ymind");
+    QVERIFY(scene.saveToFile(path));
+    MindMapScene reloaded;
+    QVERIFY(reloaded.loadFromFile(path));
+    QCOMPARE(reloaded.nodeById(editedId)->text(), QString("Renamed"));
+
+    // Waking rebuilds the same IDs, so the history still applies
+    QVERIFY(scene.wake());
+    QVERIFY(!scene.isHibernated());
+    QCOMPARE(scene.rootNode()->childNodes().size(), 200);
+    QCOMPARE(scene.nodeById(editedId)->text(), QString("Renamed"));
+    QCOMPARE(scene.undoStack()->count(), 1);
+    scene.undoStack()->undo();
+    QCOMPARE(scene.nodeById(editedId)->text(), QString("Topic 42"));
+}
+
+void tst_MindMapSceneSerialization::failedWakeKeepsMap() {
+    MindMapScene scene;
+    for (int i = 0; i < 20; ++i)
+        scene.addNode(QString("Topic %1").arg(i), scene.rootNode());
+    QVERIFY(scene.hibernate());
+
+    // A stored copy fromJson rejects
+    QJsonObject damaged = scene.toJson();
+    damaged["format"] = "damaged";
+    scene.m_hibernatedState = qCompress(QJsonDocument(damaged).toJson(QJsonDocument::Compact));
+
+    QVERIFY(!scene.wake());
+    QVERIFY(scene.isHibernated());
+    QCOMPARE(scene.rootNode(), nullptr);
+    QCOMPARE(scene.toJson()["root"].toObject()["children"].toArray().size(), 20);
+}
+
+void tst_MindMapSceneSerialization::syncAppliesOnlyChanges() {
+    MindMapScene scene;
+    auto* root = scene.rootNode();
+    auto* a = scene.addNode("A", root);
+    auto* a1 = scene.addNode("A1", a);
+    auto* b = scene.addNode("B", root);
+    auto* c = scene.addNode("C", root);
+    auto* e = scene.addNode("E", root);
+    auto* stack = scene.undoStack();
+    const int steps = stack->count();
+    const quint64 eId = e->id();
+
+    // A1 moves under C, C moves before B, B is renamed, D is new and E is gone.
+    // A comes without an ID and is matched by its row.
+    NodeTree tree;
+    const auto add = [&](NodeItem* node, const QString& text, int parent) {
+        const int i = tree.append(text, parent);
+        tree.entries[i].id = node ? node->id() : 0;
+        tree.entries[i].pos = node ? node->pos() : QPointF(40, 40);
+        return i;
+    };
+    const int r = add(root, root->text(), -1);
+    add(a, "A", r);
+    tree.entries.last().id = 0;
+    const int tc = add(c, "C", r);
+    add(a1, "A1", tc);
+    const int tb = add(b, "B renamed", r);
+    add(nullptr, "D", tb);
+
+    QSignalSpy reset(&scene, &MindMapScene::treeReset);
+    QCOMPARE(scene.syncToTree(tree), 4);
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(stack->count(), steps + 1);
+    QCOMPARE(root->childNodes(), QList<NodeItem*>({a, c, b}));
+    QVERIFY(a->childNodes().isEmpty());
+    QCOMPARE(c->childNodes(), QList<NodeItem*>{a1});
+    QCOMPARE(b->text(), QString("B renamed"));
+    QCOMPARE(b->childNodes().size(), 1);
+    QCOMPARE(b->childAt(0)->text(), QString("D"));
+    QCOMPARE(scene.nodeById(eId), nullptr);
+    QCOMPARE(scene.nodeCount(), 6);
+
+    // The same tree again changes nothing and pushes nothing
+    QCOMPARE(scene.syncToTree(tree), 0);
+    QCOMPARE(stack->count(), steps + 1);
+
+    stack->undo();
+    QCOMPARE(root->childNodes().size(), 4);
+    QCOMPARE(root->childAt(0), a);
+    QCOMPARE(a->childNodes(), QList<NodeItem*>{a1});
+    QCOMPARE(b->text(), QString("B"));
+    QVERIFY(b->childNodes().isEmpty());
+    QCOMPARE(scene.nodeById(eId)->text(), QString("E"));
+
+    stack->redo();
+    QCOMPARE(root->childNodes(), QList<NodeItem*>({a, c, b}));
+    QCOMPARE(b->childAt(0)->text(), QString("D"));
+    QCOMPARE(reset.count(), 0);
+}
+
+void tst_MindMapSceneSerialization::scheduledLayoutCoalesces() {
+    MindMapScene scene;
+    QList<NodeItem*> nodes;
+    for (int i = 0; i < 20; ++i)
+        nodes.append(scene.addNode(QString("Topic %1").arg(i), scene.rootNode()));
+    auto* stack = scene.undoStack();
+    for (auto* node : nodes)
+        stack->push(new EditTextCommand(&scene, node, node->text(), node->text() + " edited"));
+    QCOMPARE(stack->count(), 20);
+
+    // Undoing the whole burst only marks the layout dirty
+    QSignalSpy finished(&scene, &MindMapScene::layoutFinished);
+    while (stack->canUndo())
+        stack->undo();
+    QVERIFY(scene.isLayoutPending());
+    QCOMPARE(finished.count(), 0);
+
+    // An explicit layout while another is animating retargets it instead of
+    // stacking a second animation
+    QTRY_VERIFY(!scene.isLayoutPending());
+    scene.autoLayout();
+    QTRY_COMPARE(finished.count(), 1);
+    QTest::qWait(500);
+    QCOMPARE(finished.count(), 1);
+
+    // The animation ended exactly on the computed layout
+    QList<QPointF> animated;
+    for (auto* node : nodes)
+        animated.append(node->pos());
+    scene.autoLayout(false);
+    for (int i = 0; i < nodes.size(); ++i)
+        QCOMPARE(nodes[i]->pos(), animated[i]);
+}
+
+void tst_MindMapSceneSerialization::deleteSelectionIsOneStep() {
+    MindMapScene scene;
+    auto* root = scene.rootNode();
+    auto* a = scene.addNode("A", root);
+    auto* a1 = scene.addNode("A1", a);
+    scene.addNode("B", root);
+    auto* c = scene.addNode("C", root);
+    const quint64 a1Id = a1->id();
+
+    // The root and a descendant of a selected node are not deleted on their own
+    scene.clearSelection();
+    for (auto* node : {root, a, a1, c})
+        node->setSelected(true);
+    QCOMPARE(scene.selectedSubtreeRoots(), QList<NodeItem*>{root});
+    scene.deleteSelected();
+
+    auto* stack = scene.undoStack();
+    QCOMPARE(stack->count(), 1);
+    QCOMPARE(root->childNodes().size(), 1);
+    QCOMPARE(root->childNodes().first()->text(), QString("B"));
+
+    // Undo puts every subtree back at its original index
+    stack->undo();
+    QStringList texts;
+    for (auto* child : root->childNodes())
+        texts << child->text();
+    QCOMPARE(texts, QStringList({"A", "B", "C"}));
+    QVERIFY(scene.nodeById(a1Id));
+    QCOMPARE(scene.nodeById(a1Id)->parentNode()->text(), QString("A"));
+
+    stack->redo();
+    QCOMPARE(root->childNodes().size(), 1);
+}
+
+void tst_MindMapSceneSerialization::reparentSelectionIsOneStep() {
+    MindMapScene scene;
+    auto* root = scene.rootNode();
+    auto* a = scene.addNode("A", root);
+    auto* a1 = scene.addNode("A1", a);
+    auto* b = scene.addNode("B", root);
+    auto* c = scene.addNode("C", root);
+
+    // A subtree cannot move under its own descendant
+    QVERIFY(!scene.reparentNode(a, a1));
+
+    QSignalSpy finished(&scene, &MindMapScene::layoutFinished);
+    scene.reparentNodes({c, a, a1}, b);
+    auto* stack = scene.undoStack();
+    QCOMPARE(stack->count(), 1);
+    QCOMPARE(root->childNodes(), QList<NodeItem*>{b});
+    QCOMPARE(b->childNodes(), QList<NodeItem*>({a, c}));
+    QCOMPARE(a1->parentNode(), a);
+    QCOMPARE(a->level(), 2);
+    QVERIFY(scene.findEdge(b, a));
+    QVERIFY(!scene.findEdge(root, a));
+
+    // Both reparents share a single layout
+    QTRY_COMPARE(finished.count(), 1);
+
+    stack->undo();
+    QCOMPARE(root->childNodes(), QList<NodeItem*>({a, b, c}));
+    QVERIFY(b->childNodes().isEmpty());
+    QVERIFY(scene.findEdge(root, c));
+}
+
+void tst_MindMapSceneSerialization::dragSelectionIsOneStep() {
+    MindMapScene scene;
+    auto* root = scene.rootNode();
+    auto* a = scene.addNode("A", root);
+    auto* a1 = scene.addNode("A1", a);
+    auto* b = scene.addNode("B", root);
+    const QPointF aPos = a->pos();
+    const QPointF a1Pos = a1->pos();
+    const QPointF bPos = b->pos();
+
+    // A1 follows A once, not once as A's child and again as a selected node
+    scene.clearSelection();
+    for (auto* node : {a, a1, b})
+        node->setSelected(true);
+    scene.beginNodeDrag(a, QPoint(100, 100));
+    scene.dragNodes(QPointF(30, 0));
+    scene.dragNodes(QPointF(0, 40));
+    scene.endNodeDrag(QPointF(1e6, 1e6), QPoint(130, 140));
+    QCOMPARE(a1->pos(), a1Pos + QPointF(30, 40));
+    QCOMPARE(b->pos(), bPos + QPointF(30, 40));
+
+    auto* stack = scene.undoStack();
+    QCOMPARE(stack->count(), 1);
+    stack->undo();
+    QCOMPARE(a->pos(), aPos);
+    QCOMPARE(a1->pos(), a1Pos);
+    QCOMPARE(b->pos(), bPos);
+}
+
+void tst_MindMapSceneSerialization::clickOnOverlapIsNotADrop() {
+    MindMapScene scene;
+    auto* root = scene.rootNode();
+    auto* a = scene.addNode("A", root);
+    auto* b = scene.addNode("B", root);
+    a->setPos(b->pos());
+
+    // Pressing and releasing in place over B leaves A where it is
+    const QPoint press(100, 100);
+    scene.clearSelection();
+    scene.beginNodeDrag(a, press);
+    scene.endNodeDrag(b->pos(), press);
+    QCOMPARE(a->parentNode(), root);
+    QCOMPARE(scene.undoStack()->count(), 0);
+
+    // Moving past the drag distance first makes it a drop
+    scene.beginNodeDrag(a, press);
+    scene.endNodeDrag(b->pos(), press + QPoint(QApplication::startDragDistance(), 0));
+    QCOMPARE(a->parentNode(), b);
+}
+
+void tst_MindMapSceneSerialization::sceneRectTracksContent() {
+    MindMapScene scene;
+    const QRectF initial = scene.sceneRect();
+    QVERIFY(initial.contains(scene.rootNode()->sceneBoundingRect()));
+
+    // Moving past the edge grows the rect at once
+    auto* far = scene.addNode("Far", scene.rootNode());
+    far->setPos(50000, -30000);
+    QVERIFY(scene.sceneRect().contains(far->sceneBoundingRect()));
+    QVERIFY(scene.contentBounds().contains(far->sceneBoundingRect()));
+
+    // Small moves back inside leave it alone; the lazy pass shrinks it only
+    // once it is much larger than the content
+    far->setPos(45000, -30000);
+    const QRectF grown = scene.sceneRect();
+    scene.fitSceneRect();
+    QCOMPARE(scene.sceneRect(), grown);
+    scene.removeNode(far);
+    scene.fitSceneRect();
+    QVERIFY(scene.sceneRect().width() < grown.width() / 2);
+    QCOMPARE(scene.contentBounds(), scene.itemsBoundingRect());
+    QVERIFY(scene.sceneRect().contains(scene.rootNode()->sceneBoundingRect()));
+
+    // BSP depth follows the item count within Qt's useful range
+    QCOMPARE(MindMapScene::bspDepthForItemCount(0), MindMapScene::kMinBspDepth);
+    QVERIFY(MindMapScene::bspDepthForItemCount(10000)
+            < MindMapScene::bspDepthForItemCount(100000));
+    QCOMPARE(MindMapScene::bspDepthForItemCount(1 << 30), MindMapScene::kMaxBspDepth);
+    QCOMPARE(scene.bspTreeDepth(), MindMapScene::bspDepthForItemCount(1));
+}
+
+void tst_MindMapSceneSerialization::searchFollowsEdits() {
+    MindMapScene scene;
+    auto* root = scene.rootNode();
+    auto* a = scene.addNode("Budget review", root);
+    auto* a1 = scene.addNode("Q1 budget", a);
+    auto* b = scene.addNode("Launch plan", root);
+
+    // Results come back in tree order, not insertion or ID order
+    auto* b1 = scene.addNode("Budget for launch", b);
+    QCOMPARE(scene.findNodes("budg"), QList<NodeItem*>({a, a1, b1}));
+
+    // Text edits, removals and undo update the index in place
+    auto* stack = scene.undoStack();
+    stack->push(new EditTextCommand(&scene, a1, a1->text(), "Q1 forecast"));
+    QCOMPARE(scene.findNodes("budget"), QList<NodeItem*>({a, b1}));
+    QCOMPARE(scene.findNodes("forecast"), QList<NodeItem*>({a1}));
+    stack->push(new RemoveNodeCommand(&scene, b));
+    QCOMPARE(scene.findNodes("budget"), QList<NodeItem*>({a}));
+    stack->undo();
+    const QList<NodeItem*> restored = scene.findNodes("budget");
+    QCOMPARE(restored.size(), 2);
+    QCOMPARE(restored.last()->text(), QString("Budget for launch"));
+
+    // Highlights are tracked by ID and reset with the scene
+    QSignalSpy changed(&scene, &MindMapScene::searchMatchesChanged);
+    scene.setSearchMatches(restored);
+    QVERIFY(scene.isSearchMatch(a));
+    QVERIFY(!scene.isSearchMatch(a1));
+    scene.setSearchMatches(restored);
+    QCOMPARE(changed.count(), 1);
+    scene.clearScene();
+    QVERIFY(scene.searchMatches().isEmpty());
+    QCOMPARE(changed.count(), 2);
+}
+
 void tst_MindMapSceneSerialization::exportToText() {
     MindMapScene scene;
     scene.rootNode()->setText("Root");
@@ -140,6 +865,167 @@ void tst_MindMapSceneSerialization::exportToMarkdown() {
     QVERIFY(md.contains("## Child"));
 }
 
+void tst_MindMapSceneSerialization::exportToDeviceStreamsDeepMaps() {
+    MindMapScene scene;
+    scene.rootNode()->setText("Root");
+    NodeItem* node = scene.rootNode();
+    constexpr int kDepth = 2000;
+    for (int i = 0; i < kDepth; ++i)
+        node = scene.addNode(QString("Level %1 ").arg(i + 1) + QChar(0x00E9), node);
+
+    QBuffer text;
+    QVERIFY(text.open(QIODevice::WriteOnly));
+    QVERIFY(scene.exportToText(&text));
+    QCOMPARE(QString::fromUtf8(text.data()), scene.exportToText());
+    const QList<QByteArray> lines = text.data().split('\n');
+    QCOMPARE(lines.size(), kDepth + 2); // trailing newline leaves an empty last entry
+    QVERIFY(lines[kDepth].startsWith(QByteArray(kDepth, '\t') + "Level"));
+    QVERIFY(lines[kDepth].endsWith("\xc3\xa9"));
+
+    QBuffer markdown;
+    QVERIFY(markdown.open(QIODevice::WriteOnly));
+    QVERIFY(scene.exportToMarkdown(&markdown));
+    QCOMPARE(QString::fromUtf8(markdown.data()), scene.exportToMarkdown());
+    QVERIFY(markdown.data().startsWith("# Root\n\n## Level 1"));
+}
+
+void tst_MindMapSceneSerialization::exportToPngTiled() {
+    MindMapScene scene;
+    scene.rootNode()->setText("Root");
+    auto* a = scene.addNode("A", scene.rootNode());
+    scene.addNode("A1", a);
+    scene.addNode("B", scene.rootNode());
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString singlePath = dir.filePath("single.png");
+    const QString tiledPath = dir.filePath("tiled.png");
+
+    MindMapExporter exporter(&scene);
+    QVERIFY(exporter.exportToPng(singlePath, 1));
+    // A tiny budget forces a strip every few rows
+    QVERIFY(exporter.exportToPngTiled(tiledPath, 1, 4096));
+
+    QImage single(singlePath);
+    QImage tiled(tiledPath);
+    QVERIFY(!tiled.isNull());
+    QCOMPARE(tiled.size(), single.size());
+
+    // Allow for anti-aliasing differences along strip edges
+    single = single.convertToFormat(QImage::Format_RGB32);
+    tiled = tiled.convertToFormat(QImage::Format_RGB32);
+    int differing = 0;
+    for (int y = 0; y < single.height(); ++y) {
+        for (int x = 0; x < single.width(); ++x) {
+            const QRgb p = single.pixel(x, y);
+            const QRgb q = tiled.pixel(x, y);
+            if (qAbs(qRed(p) - qRed(q)) > 32 || qAbs(qGreen(p) - qGreen(q)) > 32
+                || qAbs(qBlue(p) - qBlue(q)) > 32)
+                ++differing;
+        }
+    }
+    QVERIFY(differing < single.width() * single.height() / 100);
+}
+
+void tst_MindMapSceneSerialization::exportToSvgFromModel() {
+    MindMapScene scene;
+    scene.rootNode()->setText("Root");
+    for (int i = 0; i < 8; ++i) {
+        auto* branch = scene.addNode(QString("Branch %1").arg(i), scene.rootNode());
+        for (int j = 0; j < 6; ++j) {
+            const QString text = QString("Topic %1.%2 with text long enough to wrap").arg(i).arg(j);
+            scene.addNode(text, branch);
+        }
+    }
+    scene.autoLayout();
+    const int nodeCount = 1 + 8 + 8 * 6;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("map.svg");
+
+    QVERIFY(scene.exportToSvg(path));
+
+    // The previous implementation: replay the scene through QSvgGenerator
+    QBuffer replay;
+    {
+        const QRectF contentRect = scene.itemsBoundingRect().adjusted(-40, -40, 40, 40);
+        QSvgGenerator generator;
+        generator.setOutputDevice(&replay);
+        generator.setSize(contentRect.size().toSize());
+        generator.setViewBox(QRectF(QPointF(0, 0), contentRect.size()));
+        QPainter painter(&generator);
+        painter.setRenderHint(QPainter::Antialiasing);
+        scene.render(&painter, QRectF(), contentRect);
+    }
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    // Written from the model, the file is smaller than the replayed scene
+    QVERIFY(file.size() < replay.size());
+
+    // One rect per node, one path per edge, every label present
+    int nodeRects = 0;
+    int edgePaths = 0;
+    QString text;
+    QXmlStreamReader xml(&file);
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+        if (xml.name() == QLatin1String("rect")
+            && xml.attributes().value("class").startsWith(QLatin1String("node")))
+            ++nodeRects;
+        else if (xml.name() == QLatin1String("path"))
+            ++edgePaths;
+        else if (xml.name() == QLatin1String("tspan"))
+            text += xml.readElementText() + ' ';
+    }
+    QVERIFY(!xml.hasError());
+    QCOMPARE(nodeRects, nodeCount);
+    QCOMPARE(edgePaths, nodeCount - 1);
+    QVERIFY(text.contains("Branch 7"));
+}
+
+void tst_MindMapSceneSerialization::exportToPdfPaginated() {
+    MindMapScene scene;
+    scene.rootNode()->setText("Root");
+    for (int i = 0; i < 4; ++i) {
+        auto* branch = scene.addNode(QString("Branch %1").arg(i), scene.rootNode());
+        for (int j = 0; j < 5; ++j)
+            scene.addNode(QString("Topic %1.%2").arg(i).arg(j), branch);
+    }
+    scene.autoLayout();
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    auto pageCount = [](const QString& path) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return -1;
+        static const QRegularExpression pageObject("/Type\\s*/Page(?!s)");
+        int pages = 0;
+        auto it = pageObject.globalMatch(QString::fromLatin1(file.readAll()));
+        while (it.hasNext()) {
+            it.next();
+            ++pages;
+        }
+        return pages;
+    };
+
+    MindMapExporter exporter(&scene);
+    const QString branchPath = dir.filePath("branches.pdf");
+    QVERIFY(exporter.exportToPdf(branchPath, MindMapExporter::PdfPagination::PerBranch));
+    QCOMPARE(pageCount(branchPath), 1 + 4);
+
+    const QString tiledPath = dir.filePath("tiled.pdf");
+    QVERIFY(exporter.exportToPdf(tiledPath, MindMapExporter::PdfPagination::Tiled,
+                                 QPageSize(QPageSize::A7)));
+    QVERIFY(pageCount(tiledPath) > 1);
+
+    // Branch pages filter the items they paint; the open map is not touched
+    for (auto* child : scene.rootNode()->childNodes())
+        QCOMPARE(child->opacity(), 1.0);
+}
+
 void tst_MindMapSceneSerialization::importFromText() {
     MindMapScene scene;
     QString input = "Root\n\tA\n\t\tA1\n\tB\n";
@@ -163,5 +1049,28 @@ void tst_MindMapSceneSerialization::importFromTextEmpty() {
     QVERIFY(!scene.importFromText(""));
 }
 
+void tst_MindMapSceneSerialization::importTreeLaysOutImmediately() {
+    // 50 branches x 100 leaves, as tab-indented text
+    QString input = "Root\n";
+    for (int b = 0; b < 50; ++b) {
+        input += QString("\tBranch %1\n").arg(b);
+        for (int l = 0; l < 100; ++l)
+            input += QString("\t\tLeaf %1.%2\n").arg(b).arg(l);
+    }
+
+    MindMapScene scene;
+    QVERIFY(scene.importFromText(input));
+    QVERIFY(!scene.isModified());
+    QVERIFY(scene.selectedItems().isEmpty());
+
+    auto branches = scene.rootNode()->childNodes();
+    QCOMPARE(branches.size(), 50);
+    QCOMPARE(branches.last()->childNodes().size(), 100);
+
+    // Positions are applied without animation, so nothing is left at the origin
+    for (auto* branch : branches)
+        QVERIFY(branch->pos() != scene.rootNode()->pos());
+}
+
 QTEST_MAIN(tst_MindMapSceneSerialization)
 #include "tst_MindMapSceneSerialization.moc"
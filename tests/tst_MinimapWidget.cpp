@@ -0,0 +1,93 @@
+#include "core/AppSettings.h"
+#include "core/TemplateRegistry.h"
+#include "layout/LayoutAlgorithmRegistry.h"
+#include "scene/MindMapScene.h"
+#include "scene/MindMapView.h"
+#include "scene/NodeItem.h"
+#include "ui/MinimapWidget.h"
+
+#include <QLineF>
+#include <QTest>
+
+class tst_MinimapWidget : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void sceneChangesPatchTheImage();
+    void clickCentersTheView();
+};
+
+void tst_MinimapWidget::initTestCase() {
+    QCoreApplication::setOrganizationName("YMindTest");
+    QCoreApplication::setApplicationName("tst_MinimapWidget");
+    AppSettings::instance().setShowMinimap(true);
+    TemplateRegistry::instance().loadBuiltins();
+    LayoutAlgorithmRegistry::instance().registerBuiltins();
+}
+
+void tst_MinimapWidget::sceneChangesPatchTheImage() {
+    MindMapScene scene;
+    QList<NodeItem*> branches;
+    for (int i = 0; i < 6; ++i)
+        branches.append(scene.addNode(QString("Branch %1").arg(i), scene.rootNode()));
+    scene.autoLayout(false);
+
+    MindMapView view;
+    view.setScene(&scene);
+    view.resize(900, 600);
+    auto* minimap = new MinimapWidget(&view);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QTRY_COMPARE(minimap->fullRenderCount(), 1);
+    QVERIFY(!minimap->image().isNull());
+    QVERIFY(minimap->mapRect().contains(scene.itemsBoundingRect()));
+
+    // A text edit inside the map only redraws the region it touched
+    branches[2]->setText("Renamed branch");
+    QTRY_VERIFY(minimap->partialRenderCount() > 0);
+    QCOMPARE(minimap->fullRenderCount(), 1);
+
+    // Moving a node patches where it was and where it went
+    const int partial = minimap->partialRenderCount();
+    branches[4]->setPos(branches[4]->pos() + QPointF(0, 30));
+    QTRY_VERIFY(minimap->partialRenderCount() > partial);
+    QCOMPARE(minimap->fullRenderCount(), 1);
+
+    // A node far outside the covered area rebuilds the image around it
+    auto* far = scene.addNode("Far away", scene.rootNode());
+    far->setPos(minimap->mapRect().right() + 3000, 0);
+    QTRY_COMPARE(minimap->fullRenderCount(), 2);
+    QVERIFY(minimap->mapRect().contains(far->sceneBoundingRect()));
+}
+
+void tst_MinimapWidget::clickCentersTheView() {
+    MindMapScene scene;
+    NodeItem* target = nullptr;
+    for (int i = 0; i < 12; ++i)
+        target = scene.addNode(QString("Branch %1").arg(i), scene.rootNode());
+    scene.autoLayout(false);
+
+    MindMapView view;
+    view.setScene(&scene);
+    view.resize(600, 400);
+    auto* minimap = new MinimapWidget(&view);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+    view.resetTransform();
+    view.scale(2.0, 2.0);
+    QTRY_COMPARE(minimap->fullRenderCount(), 1);
+
+    const QPoint click = minimap->sceneToWidget(target->pos()).toPoint();
+    QTest::mouseClick(minimap, Qt::LeftButton, Qt::NoModifier, click);
+
+    // Within one minimap pixel of the clicked node
+    const QPointF center = view.mapToScene(view.viewport()->rect().center());
+    const qreal tolerance = 2.0 * minimap->mapRect().width() / minimap->width();
+    const qreal distance = QLineF(center, target->pos()).length();
+    QVERIFY2(distance <= tolerance, qPrintable(QString("centered %1 units away").arg(distance)));
+}
+
+QTEST_MAIN(tst_MinimapWidget)
+#include "tst_MinimapWidget.moc"
@@ -0,0 +1,113 @@
+#include "scene/NodeTree.h"
+
+#include <QTest>
+#include <functional>
+
+class tst_NodeTree : public QObject {
+    Q_OBJECT
+
+private slots:
+    void indentedText();
+    void indentedTextSkipsBlankLines();
+    void markdownHeadingsAndLists();
+    void markdownWithoutTitleGetsDefaultRoot();
+    void opmlSingleTopLevelOutline();
+    void opmlSeveralTopLevelOutlines();
+    void opmlInvalid();
+};
+
+namespace {
+
+// "Root(A(A1),B)" style rendering of a parsed tree, for compact comparisons
+QString describe(const NodeTree& tree) {
+    QList<QStringList> children(tree.size());
+    for (int i = 1; i < tree.size(); ++i)
+        children[tree.entries[i].parent].append(QString::number(i));
+
+    std::function<QString(int)> render = [&](int index) {
+        QString out = tree.entries[index].text;
+        if (!children[index].isEmpty()) {
+            QStringList parts;
+            for (const QString& child : children[index])
+                parts.append(render(child.toInt()));
+            out += "(" + parts.join(",") + ")";
+        }
+        return out;
+    };
+    return tree.isEmpty() ? QString() : render(0);
+}
+
+} // namespace
+
+void tst_NodeTree::indentedText() {
+    const auto tree =
+        NodeTree::fromIndentedText(u"Root\n\tA\n\t\tA1\n\tB\r\n\t\tB1\n\t\t\tB1a\n\tC\n");
+    QCOMPARE(describe(tree), QString("Root(A(A1),B(B1(B1a)),C)"));
+    QCOMPARE(tree.entries[0].parent, -1);
+}
+
+void tst_NodeTree::indentedTextSkipsBlankLines() {
+    QCOMPARE(describe(NodeTree::fromIndentedText(u"\n\nRoot\n\n\tA\n\t  \nB\n")),
+             QString("Root(A,B)"));
+    QVERIFY(NodeTree::fromIndentedText(u"").isEmpty());
+    QVERIFY(NodeTree::fromIndentedText(u"\n\t\n").isEmpty());
+}
+
+void tst_NodeTree::markdownHeadingsAndLists() {
+    const QString md = "# Plan\n"
+                       "\n"
+                       "Some prose that is ignored.\n"
+                       "\n"
+                       "## Goals ##\n"
+                       "\n"
+                       "- Ship\n"
+                       "  - Docs\n"
+                       "  - [x] Tests\n"
+                       "- Review\n"
+                       "\n"
+                       "```\n"
+                       "- not an item\n"
+                       "```\n"
+                       "\n"
+                       "### Stretch\n"
+                       "1. Speed\n"
+                       "## C#\n"
+                       "---\n";
+    QCOMPARE(describe(NodeTree::fromMarkdown(md)),
+             QString("Plan(Goals(Ship(Docs,Tests),Review,Stretch(Speed)),C#)"));
+}
+
+void tst_NodeTree::markdownWithoutTitleGetsDefaultRoot() {
+    QCOMPARE(describe(NodeTree::fromMarkdown(u"## A\n- a1\n## B\n")),
+             QString("Central Topic(A(a1),B)"));
+    QVERIFY(NodeTree::fromMarkdown(u"Just a paragraph.\n").isEmpty());
+}
+
+void tst_NodeTree::opmlSingleTopLevelOutline() {
+    const QByteArray opml = "<?xml version=\"1.0\"?>\n"
+                            "<opml version=\"2.0\"><head><title>Doc</title></head><body>"
+                            "<outline text=\"Root\">"
+                            "<outline text=\"A\"><outline title=\"A1\"/></outline>"
+                            "<outline text=\"B &amp; C\"/>"
+                            "</outline>"
+                            "</body></opml>";
+    const auto tree = NodeTree::fromOpml(opml);
+    QCOMPARE(describe(tree), QString("Root(A(A1),B & C)"));
+    QCOMPARE(tree.entries[0].parent, -1);
+}
+
+void tst_NodeTree::opmlSeveralTopLevelOutlines() {
+    const QByteArray opml = "<opml version=\"2.0\"><head><title>Doc</title></head><body>"
+                            "<outline text=\"A\"/>"
+                            "<outline text=\"B\"><outline text=\"B1\"/></outline>"
+                            "</body></opml>";
+    QCOMPARE(describe(NodeTree::fromOpml(opml)), QString("Doc(A,B(B1))"));
+}
+
+void tst_NodeTree::opmlInvalid() {
+    QVERIFY(NodeTree::fromOpml("<opml><body><outline text=\"A\">").isEmpty());
+    QVERIFY(NodeTree::fromOpml("<opml><head/><body/></opml>").isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_NodeTree)
+#include "tst_NodeTree.moc"
@@ -0,0 +1,260 @@
+#include "core/Commands.h"
+#include "core/TemplateRegistry.h"
+#include "layout/LayoutAlgorithmRegistry.h"
+#include "scene/MindMapScene.h"
+#include "scene/MindMapSerializer.h"
+#include "scene/NodeItem.h"
+#include "ui/OutlineModel.h"
+#include "ui/OutlineWidget.h"
+
+#include <QAbstractItemModelTester>
+#include <QSignalSpy>
+#include <QTest>
+#include <QTreeView>
+#include <QUndoStack>
+
+class tst_OutlineModel : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void commandsBecomeRowChanges();
+    void editTouchesOneRow();
+    void expansionSurvivesEditsAndTabSwitches();
+    void handlesAreValidatedAndRowsCached();
+    void chunkedBranchFetchesOnExpand();
+    void largeMapOpensToDefaultDepth();
+};
+
+void tst_OutlineModel::initTestCase() {
+    TemplateRegistry::instance().loadBuiltins();
+    LayoutAlgorithmRegistry::instance().registerBuiltins();
+}
+
+void tst_OutlineModel::commandsBecomeRowChanges() {
+    MindMapScene scene;
+    OutlineModel model;
+    model.setScene(&scene);
+    // Fails the test on any inconsistency between signals and the tree
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+    auto* root = scene.rootNode();
+    auto* a = scene.addNode("A", root);
+    auto* b = scene.addNode("B", root);
+    scene.addNode("A1", a);
+    scene.addNode("A2", a);
+    QCOMPARE(model.rowCount(model.indexForNode(root)), 2);
+    QCOMPARE(model.indexForNode(b).row(), 1);
+    QCOMPARE(model.nodeForIndex(model.index(1, 0, model.indexForNode(a)))->text(), QString("A2"));
+
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy moved(&model, &QAbstractItemModel::rowsMoved);
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+
+    auto* stack = scene.undoStack();
+    stack->push(new RemoveNodeCommand(&scene, a));
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(model.rowCount(model.indexForNode(root)), 1);
+    stack->undo();
+    QCOMPARE(model.rowCount(model.indexForNode(root)), 2);
+    QCOMPARE(model.index(0, 0, model.indexForNode(root)).data().toString(), QString("A"));
+
+    // Undo brought A back as a new item with the same ID
+    const quint64 aId = model.index(0, 0, model.indexForNode(root))
+                            .data(OutlineModel::NodeIdRole)
+                            .value<quint64>();
+    scene.reparentNodes({scene.nodeById(aId)}, b);
+    QCOMPARE(moved.count(), 1);
+    QCOMPARE(model.rowCount(model.indexForNode(b)), 1);
+    stack->undo();
+    QCOMPARE(moved.count(), 2);
+    QCOMPARE(model.rowCount(model.indexForNode(b)), 0);
+
+    // None of the above rebuilt the model; loading does, once
+    QCOMPARE(reset.count(), 0);
+    QVERIFY(inserted.count() > 0);
+    QVERIFY(scene.importFromText("Root\n\tX\n\tY\n\t\tY1"));
+    QVERIFY(reset.count() >= 1);
+    const QModelIndex newRoot = model.indexForNode(scene.rootNode());
+    if (model.canFetchMore(newRoot))
+        model.fetchMore(newRoot);
+    QCOMPARE(model.rowCount(newRoot), 2);
+}
+
+void tst_OutlineModel::editTouchesOneRow() {
+    MindMapScene scene;
+    OutlineModel model;
+    model.setScene(&scene);
+    QList<NodeItem*> nodes;
+    for (int i = 0; i < 50; ++i)
+        nodes.append(scene.addNode(QString("Topic %1").arg(i), scene.rootNode()));
+
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    scene.undoStack()->push(new EditTextCommand(&scene, nodes[7], nodes[7]->text(), "Renamed"));
+
+    QCOMPARE(changed.count(), 1);
+    const QModelIndex index = changed.first().at(0).value<QModelIndex>();
+    QCOMPARE(index, model.indexForNode(nodes[7]));
+    QCOMPARE(index.data().toString(), QString("Renamed"));
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(inserted.count(), 0);
+
+    // Search highlights are per-row changes too
+    changed.clear();
+    scene.setSearchMatches({nodes[3], nodes[9]});
+    QCOMPARE(changed.count(), 2);
+    QVERIFY(model.indexForNode(nodes[3]).data(Qt::BackgroundRole).isValid());
+    QVERIFY(!model.indexForNode(nodes[4]).data(Qt::BackgroundRole).isValid());
+}
+
+void tst_OutlineModel::expansionSurvivesEditsAndTabSwitches() {
+    MindMapScene first;
+    auto* a = first.addNode("A", first.rootNode());
+    auto* b = first.addNode("B", first.rootNode());
+    first.addNode("A1", a);
+    first.addNode("B1", b);
+    MindMapScene second;
+
+    OutlineWidget outline;
+    outline.setScene(&first);
+    auto* model = outline.model();
+    auto* tree = outline.treeView();
+    QVERIFY(tree->isExpanded(model->indexForNode(a)));
+
+    // The user collapses A; edits elsewhere leave that alone
+    tree->collapse(model->indexForNode(a));
+    first.undoStack()->push(new EditTextCommand(&first, b, "B", "Bee"));
+    first.addNode("B2", b);
+    QVERIFY(!tree->isExpanded(model->indexForNode(a)));
+    QVERIFY(tree->isExpanded(model->indexForNode(b)));
+
+    // So does switching to another tab and back
+    outline.setScene(&second);
+    QVERIFY(tree->isExpanded(model->indexForNode(second.rootNode())));
+    outline.setScene(&first);
+    QVERIFY(!tree->isExpanded(model->indexForNode(a)));
+    QVERIFY(tree->isExpanded(model->indexForNode(b)));
+
+    // Selecting on the canvas moves the outline's current row
+    first.clearSelection();
+    b->setSelected(true);
+    QCOMPARE(tree->currentIndex(), model->indexForNode(b));
+}
+
+void tst_OutlineModel::handlesAreValidatedAndRowsCached() {
+    MindMapScene scene;
+    OutlineModel model;
+    model.setScene(&scene);
+    auto* root = scene.rootNode();
+    QList<NodeItem*> nodes;
+    for (int i = 0; i < 20000; ++i)
+        nodes.append(scene.addNode(QString("Topic %1").arg(i), root));
+
+    // An index outliving its node resolves to nothing instead of a dangling pointer
+    const QModelIndex stale = model.indexForNode(nodes.last());
+    scene.undoStack()->push(new RemoveNodeCommand(&scene, nodes.takeLast()));
+    QCOMPARE(model.nodeForIndex(stale), nullptr);
+    QVERIFY(!stale.data().isValid());
+
+    // An insert at the front shifts every row; lookups stay correct and cheap
+    nodes.prepend(scene.createChildNode("First", root, 0));
+    for (int i = nodes.size() - 1; i >= 0; --i) {
+        const QModelIndex index = model.indexForNode(nodes[i]);
+        QCOMPARE(index.row(), i);
+        QCOMPARE(model.nodeForIndex(index), nodes[i]);
+    }
+    const QModelIndex rootIndex = model.indexForNode(root);
+    QCOMPARE(model.rowCount(rootIndex), nodes.size());
+    QCOMPARE(model.index(0, 0, rootIndex).data().toString(), QString("First"));
+    QCOMPARE(model.index(nodes.size() - 1, 0, rootIndex).data().toString(),
+             QString("Topic 19998"));
+}
+
+void tst_OutlineModel::chunkedBranchFetchesOnExpand() {
+    const int bigCount = MindMapSerializer::kChunkNodeThreshold;
+    MindMapScene source;
+    auto* big = source.addNode("Big", source.rootNode());
+    for (int i = 0; i < bigCount; ++i)
+        source.addNode(QString("Item %1").arg(i), big);
+
+    MindMapScene scene;
+    QVERIFY(scene.fromJson(source.toJson()));
+    OutlineModel model;
+    model.setScene(&scene);
+
+    // The unread branch shows an expand arrow but has no rows until fetched
+    const QModelIndex root = model.index(0, 0);
+    if (model.canFetchMore(root))
+        model.fetchMore(root);
+    const QModelIndex bigIndex = model.index(0, 0, root);
+    NodeItem* loadedBig = model.nodeForIndex(bigIndex);
+    QVERIFY(scene.isChunkPending(loadedBig));
+    QVERIFY(model.hasChildren(bigIndex));
+    QCOMPARE(model.rowCount(bigIndex), 0);
+
+    // Fetching reads the chunk
+    QVERIFY(model.canFetchMore(bigIndex));
+    model.fetchMore(bigIndex);
+    QVERIFY(!scene.isChunkPending(loadedBig));
+    QVERIFY(!model.canFetchMore(bigIndex));
+    QCOMPARE(model.rowCount(bigIndex), bigCount);
+    QCOMPARE(model.index(3, 0, bigIndex).data().toString(), QString("Item 3"));
+}
+
+void tst_OutlineModel::largeMapOpensToDefaultDepth() {
+    // 20 topics x 20 subtopics x 20 details, well past the expand-all limit
+    QString text = "Root\n";
+    for (int i = 0; i < 20; ++i) {
+        text += QString("\tTopic %1\n").arg(i);
+        for (int j = 0; j < 20; ++j) {
+            text += QString("\t\tSub %1.%2\n").arg(i).arg(j);
+            for (int k = 0; k < 20; ++k)
+                text += QString("\t\t\tDetail %1.%2.%3\n").arg(i).arg(j).arg(k);
+        }
+    }
+    MindMapScene scene;
+    QVERIFY(scene.importFromText(text));
+    QVERIFY(scene.nodeCount() > OutlineWidget::kExpandAllNodeLimit);
+
+    OutlineWidget outline;
+    outline.setScene(&scene);
+
+    // Only the topics and their subtopics are fetched; no detail has a row
+    auto* model = outline.model();
+    auto* tree = outline.treeView();
+    const QModelIndex rootIndex = model->indexForNode(scene.rootNode());
+    QCOMPARE(model->rowCount(rootIndex), 20);
+    int fetchedRows = 0;
+    for (int i = 0; i < model->rowCount(rootIndex); ++i) {
+        const QModelIndex topicIndex = model->index(i, 0, rootIndex);
+        fetchedRows += model->rowCount(topicIndex);
+        for (int j = 0; j < model->rowCount(topicIndex); ++j) {
+            const QModelIndex subIndex = model->index(j, 0, topicIndex);
+            QVERIFY(model->canFetchMore(subIndex));
+            QCOMPARE(model->rowCount(subIndex), 0);
+        }
+    }
+    QCOMPARE(fetchedRows, 20 * 20);
+
+    NodeItem* topic = scene.rootNode()->childAt(4);
+    NodeItem* sub = topic->childAt(7);
+    QVERIFY(tree->isExpanded(model->indexForNode(scene.rootNode())));
+    QVERIFY(tree->isExpanded(model->indexForNode(topic)));
+    QVERIFY(!tree->isExpanded(model->indexForNode(sub)));
+    // Details were never fetched
+    QVERIFY(!model->isFetched(sub));
+    QVERIFY(!model->indexForNode(sub->childAt(0)).isValid());
+
+    // Selecting one on the canvas fetches its branch and makes it current
+    NodeItem* detail = sub->childAt(11);
+    detail->setSelected(true);
+    QVERIFY(model->isFetched(sub));
+    QCOMPARE(tree->currentIndex(), model->indexForNode(detail));
+    QCOMPARE(model->nodeForIndex(tree->currentIndex())->text(), QString("Detail 4.7.11"));
+}
+
+QTEST_MAIN(tst_OutlineModel)
+#include "tst_OutlineModel.moc"
@@ -0,0 +1,116 @@
+#include "core/AppSettings.h"
+#include "core/TemplateRegistry.h"
+#include "layout/LayoutAlgorithmRegistry.h"
+#include "scene/MindMapScene.h"
+#include "scene/MindMapView.h"
+#include "scene/NodeItem.h"
+#include "scene/RenderStats.h"
+#include "ui/PerformanceHud.h"
+
+#include <QBuffer>
+#include <QSignalSpy>
+#include <QTest>
+
+class tst_RenderStats : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void disabledScopesRecordNothing();
+    void framesCountPaintsAndCacheHits();
+    void hudWritesCsv();
+};
+
+void tst_RenderStats::initTestCase() {
+    QCoreApplication::setOrganizationName("YMindTest");
+    QCoreApplication::setApplicationName("tst_RenderStats");
+    qRegisterMetaType<RenderStats::Frame>();
+    TemplateRegistry::instance().loadBuiltins();
+    LayoutAlgorithmRegistry::instance().registerBuiltins();
+}
+
+void tst_RenderStats::cleanupTestCase() {
+    AppSettings::instance().setShowPerformanceHud(false);
+}
+
+void tst_RenderStats::disabledScopesRecordNothing() {
+    RenderStats::setEnabled(false);
+    RenderStats::beginFrame();
+    { RenderStats::Scope scope(RenderStats::NodePaint); }
+    const auto frame = RenderStats::endFrame(0, 0);
+    QCOMPARE(frame.calls[RenderStats::NodePaint], 0);
+    QCOMPARE(frame.nsecs[RenderStats::NodePaint], qint64(0));
+
+    RenderStats::setEnabled(true);
+    RenderStats::beginFrame();
+    { RenderStats::Scope scope(RenderStats::NodePaint); }
+    QCOMPARE(RenderStats::endFrame(0, 4).calls[RenderStats::NodePaint], 1);
+    RenderStats::setEnabled(false);
+}
+
+void tst_RenderStats::framesCountPaintsAndCacheHits() {
+    MindMapScene scene;
+    for (int i = 0; i < 6; ++i)
+        scene.addNode(QString("Branch %1").arg(i), scene.rootNode());
+    scene.autoLayout(false);
+
+    MindMapView view;
+    view.setScene(&scene);
+    view.resize(1000, 700);
+    QSignalSpy frames(&view, &MindMapView::frameRendered);
+    RenderStats::setEnabled(true);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+    view.zoomToFit();
+
+    // The first frame fills every node's cache, the next one reuses them
+    view.viewport()->repaint();
+    view.viewport()->repaint();
+    QVERIFY(frames.count() >= 2);
+    const auto first = frames.at(frames.count() - 2).at(0).value<RenderStats::Frame>();
+    const auto second = frames.last().at(0).value<RenderStats::Frame>();
+    RenderStats::setEnabled(false);
+
+    QVERIFY(second.visibleNodes > 0);
+    QVERIFY(second.frameNsecs > 0);
+    QVERIFY(second.calls[RenderStats::Background] >= 1);
+    QVERIFY(second.calls[RenderStats::EdgePaint] > 0);
+    QVERIFY(second.calls[RenderStats::NodePaint] <= first.calls[RenderStats::NodePaint]);
+    QVERIFY(second.nodeCacheHitRate() >= first.nodeCacheHitRate());
+    QVERIFY(first.timestampMs <= second.timestampMs);
+}
+
+void tst_RenderStats::hudWritesCsv() {
+    MindMapScene scene;
+    scene.addNode("Child", scene.rootNode());
+    MindMapView view;
+    view.setScene(&scene);
+    view.resize(800, 600);
+    auto* hud = new PerformanceHud(&view);
+    AppSettings::instance().setShowPerformanceHud(true);
+    QVERIFY(RenderStats::isEnabled());
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    view.viewport()->repaint();
+    view.viewport()->repaint();
+    QVERIFY(hud->frameCount() >= 2);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(hud->writeCsv(&buffer));
+    const QList<QByteArray> rows = buffer.data().trimmed().split('\n');
+    QCOMPARE(rows.size(), hud->frameCount() + 1);
+    QVERIFY(rows.first().startsWith("timestamp_ms,frame_ms,visible_nodes,node_cache_hit_rate,"));
+    QVERIFY(rows.first().contains("update_path_ms"));
+    QCOMPARE(rows.last().count(','), rows.first().count(','));
+
+    // Hiding the overlay switches profiling off and drops the history
+    AppSettings::instance().setShowPerformanceHud(false);
+    QVERIFY(!RenderStats::isEnabled());
+    QCOMPARE(hud->frameCount(), 0);
+}
+
+QTEST_MAIN(tst_RenderStats)
+#include "tst_RenderStats.moc"
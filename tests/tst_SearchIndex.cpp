@@ -0,0 +1,115 @@
+#include "scene/SearchIndex.h"
+
+#include <QTest>
+
+#include <algorithm>
+
+class tst_SearchIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void foldsCaseAndDiacritics();
+    void tokenizesWordsAndIdeographs();
+    void prefixQueriesIntersect();
+    void updatesReplaceAndRemove();
+    void largeIndexQueries();
+};
+
+namespace {
+
+QList<quint64> sorted(QList<quint64> ids) {
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // namespace
+
+void tst_SearchIndex::foldsCaseAndDiacritics() {
+    QCOMPARE(SearchIndex::fold(u"Café Crème"), QString("cafe creme"));
+    QCOMPARE(SearchIndex::fold(u"ＭＡＰ ﬁle"), QString("map file"));
+    QCOMPARE(SearchIndex::fold(u"Ångström"), QString("angstrom"));
+}
+
+void tst_SearchIndex::tokenizesWordsAndIdeographs() {
+    QCOMPARE(SearchIndex::tokenize(u"Q3 road-map, v2.0!"),
+             QStringList({"q3", "road", "map", "v2", "0"}));
+    QCOMPARE(SearchIndex::tokenize(u"Plan plan PLAN"), QStringList({"plan"}));
+    QCOMPARE(SearchIndex::tokenize(u"思维导图 Map"), QStringList({"思", "维", "导", "图", "map"}));
+    QVERIFY(SearchIndex::tokenize(u"  -- ").isEmpty());
+}
+
+void tst_SearchIndex::prefixQueriesIntersect() {
+    SearchIndex index;
+    index.addNode(1, u"Marketing plan");
+    index.addNode(2, u"Market research");
+    index.addNode(3, u"Résumé review");
+    index.addNode(4, u"思维导图");
+
+    QCOMPARE(sorted(index.find(u"mark")), QList<quint64>({1, 2}));
+    QCOMPARE(index.find(u"market pl"), QList<quint64>({1}));
+    QCOMPARE(index.find(u"PLAN market"), QList<quint64>({1}));
+    QCOMPARE(index.find(u"resume"), QList<quint64>({3}));
+    QCOMPARE(index.find(u"导图"), QList<quint64>({4}));
+    QVERIFY(index.find(u"marketing research").isEmpty());
+    QVERIFY(index.find(u"").isEmpty());
+    QVERIFY(index.find(u"?!").isEmpty());
+}
+
+void tst_SearchIndex::updatesReplaceAndRemove() {
+    SearchIndex index;
+    index.addNode(1, u"Alpha beta");
+    index.addNode(2, u"Beta gamma");
+    QCOMPARE(index.tokenCount(), 3);
+
+    // Re-adding replaces the old tokens, and unused tokens are dropped
+    index.addNode(1, u"Delta");
+    QVERIFY(index.find(u"alpha").isEmpty());
+    QCOMPARE(index.find(u"beta"), QList<quint64>({2}));
+    QCOMPARE(index.find(u"del"), QList<quint64>({1}));
+    QCOMPARE(index.tokenCount(), 3);
+
+    index.removeNode(2);
+    index.removeNode(42);
+    QVERIFY(index.find(u"gamma").isEmpty());
+    QCOMPARE(index.nodeCount(), 1);
+    QCOMPARE(index.tokenCount(), 1);
+
+    index.clear();
+    QCOMPARE(index.nodeCount(), 0);
+    QVERIFY(index.find(u"delta").isEmpty());
+}
+
+void tst_SearchIndex::largeIndexQueries() {
+    // 100k topics drawn from a small vocabulary, like a real map's repeated words
+    const QStringList words = {"project", "review", "budget", "design", "launch",
+                               "market",  "team",   "risk",   "goal",   "plan"};
+    SearchIndex index;
+    for (int i = 0; i < 100000; ++i) {
+        index.addNode(quint64(i + 1), QString("%1 %2 item%3")
+                                          .arg(words[i % words.size()],
+                                               words[(i / 10) % words.size()])
+                                          .arg(i));
+    }
+    QCOMPARE(index.nodeCount(), 100000);
+
+    // item4242 and item42420..item42429
+    QList<quint64> narrow{4243};
+    for (quint64 id = 42421; id <= 42430; ++id)
+        narrow.append(id);
+    QCOMPARE(sorted(index.find(u"item4242")), narrow);
+
+    // "budget" and a word starting with "rev", in either place
+    QList<quint64> broad;
+    for (int i = 0; i < 100000; ++i) {
+        const int first = i % 10;
+        const int second = (i / 10) % 10;
+        if ((first == 2 && second == 1) || (first == 1 && second == 2))
+            broad.append(quint64(i + 1));
+    }
+    QCOMPARE(broad.size(), 2000);
+    QCOMPARE(sorted(index.find(u"budget rev")), broad);
+    QCOMPARE(sorted(index.find(u"rev budget")), broad);
+}
+
+QTEST_MAIN(tst_SearchIndex)
+#include "tst_SearchIndex.moc"
@@ -0,0 +1,357 @@
+#include "core/AppSettings.h"
+#include "core/Commands.h"
+#include "core/TemplateRegistry.h"
+#include "layout/LayoutAlgorithmRegistry.h"
+#include "scene/MindMapScene.h"
+#include "scene/MindMapView.h"
+#include "scene/NodeItem.h"
+#include "ui/TabManager.h"
+
+#include <QAbstractButton>
+#include <QAction>
+#include <QApplication>
+#include <QCoreApplication>
+#include <QMessageBox>
+#include <QSignalSpy>
+#include <QStackedWidget>
+#include <QTabBar>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTimer>
+#include <QUndoStack>
+
+class tst_TabManager : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void restoreReadsOnlyTheCurrentTab();
+    void sessionKeepsUnshownTabsAsSaved();
+    void hibernatedTabWakesOnSwitch();
+    void memoryBudgetHibernatesIdleTabs();
+    void openShowsProgressUntilBuilt();
+    void closingCancelsLoad();
+    void externalChangeReloadsInPlace();
+    void externalChangeAsksBeforeReplacingEdits();
+
+private:
+    QString saveMap(const QString& rootText, int childCount = 1);
+    // Clicks |button| on the next reload prompt and counts it in |asked|
+    void answerReloadPrompt(const QString& button, int* asked);
+
+    QTemporaryDir m_dir;
+};
+
+void tst_TabManager::initTestCase() {
+    QCoreApplication::setOrganizationName("YMindTest");
+    QCoreApplication::setApplicationName("tst_TabManager");
+    TemplateRegistry::instance().loadBuiltins();
+    LayoutAlgorithmRegistry::instance().registerBuiltins();
+    QVERIFY(m_dir.isValid());
+}
+
+QString tst_TabManager::saveMap(const QString& rootText, int childCount) {
+    MindMapScene scene;
+    scene.rootNode()->setText(rootText);
+    for (int i = 0; i < childCount; ++i)
+        scene.addNode("Child", scene.rootNode());
+    const QString path = m_dir.filePath(rootText + ".ymind");
+    if (!scene.saveToFile(path))
+        return {};
+    return path;
+}
+
+void tst_TabManager::answerReloadPrompt(const QString& button, int* asked) {
+    auto* poll = new QTimer(this);
+    connect(poll, &QTimer::timeout, this, [poll, button, asked]() {
+        for (QWidget* w : QApplication::topLevelWidgets()) {
+            auto* box = qobject_cast<QMessageBox*>(w);
+            if (!box || !box->isVisible() || box->objectName() != "reloadPrompt")
+                continue;
+            poll->stop();
+            poll->deleteLater();
+            ++*asked;
+            box->findChild<QAbstractButton*>(button)->click();
+            return;
+        }
+    });
+    poll->start(20);
+}
+
+void tst_TabManager::restoreReadsOnlyTheCurrentTab() {
+    const QString a = saveMap("Alpha");
+    const QString b = saveMap("Beta");
+    const QString c = saveMap("Gamma");
+    QVERIFY(!a.isEmpty() && !b.isEmpty() && !c.isEmpty());
+
+    QWidget window;
+    QAction undo;
+    QAction redo;
+    TabManager tabs(&window);
+    tabs.init(&undo, &redo);
+
+    QVERIFY(!tabs.restoreSession({}, 0));
+    QVERIFY(tabs.restoreSession({{a, 0.0, {}}, {b, 2.0, {10, 20}}, {c, 0.0, {}}}, 1));
+    QCOMPARE(tabs.tabCount(), 3);
+    QCOMPARE(tabs.currentIndex(), 1);
+    QCOMPARE(tabs.tabBar()->tabText(0), QString("Alpha.ymind"));
+
+    // Only the current tab was read
+    QVERIFY(!tabs.isTabLoaded(0));
+    QTRY_VERIFY(tabs.isTabLoaded(1));
+    QVERIFY(!tabs.isTabLoaded(2));
+    QCOMPARE(tabs.tab(1).scene->rootNode()->text(), QString("Beta"));
+    QCOMPARE(tabs.tab(1).stack->currentWidget(), tabs.tab(1).view);
+    QCOMPARE(tabs.tab(0).stack->currentWidget()->objectName(), QString("tabPlaceholder"));
+
+    // Its view is positioned once the event loop runs
+    QTRY_COMPARE(tabs.tab(1).view->transform().m11(), 2.0);
+
+    // Showing another tab reads it
+    tabs.tabBar()->setCurrentIndex(2);
+    QTRY_VERIFY(tabs.isTabLoaded(2));
+    QCOMPARE(tabs.tab(2).scene->rootNode()->text(), QString("Gamma"));
+    QVERIFY(!tabs.tab(2).scene->isModified());
+    QVERIFY(!tabs.isTabLoaded(0));
+}
+
+void tst_TabManager::sessionKeepsUnshownTabsAsSaved() {
+    const QString a = saveMap("Alpha");
+    const QString b = saveMap("Beta");
+
+    QWidget window;
+    QAction undo;
+    QAction redo;
+    TabManager tabs(&window);
+    tabs.init(&undo, &redo);
+    QVERIFY(tabs.restoreSession({{a, 1.25, {5, 6}}, {b, 0.0, {}}}, 1));
+    QTRY_VERIFY(tabs.isTabLoaded(1));
+
+    int current = -1;
+    const QList<SessionTab> session = tabs.sessionTabs(&current);
+    QCOMPARE(session.size(), 2);
+    QCOMPARE(current, 1);
+    // The unshown tab passes its saved position through untouched
+    QCOMPARE(session[0].filePath, a);
+    QCOMPARE(session[0].zoom, 1.25);
+    QCOMPARE(session[0].center, QPointF(5, 6));
+    QCOMPARE(session[1].filePath, b);
+    QVERIFY(session[1].zoom > 0.0);
+}
+
+void tst_TabManager::hibernatedTabWakesOnSwitch() {
+    const QString a = saveMap("Alpha", 50);
+    const QString b = saveMap("Beta");
+
+    QWidget window;
+    QAction undo;
+    QAction redo;
+    TabManager tabs(&window);
+    tabs.init(&undo, &redo);
+    QVERIFY(tabs.restoreSession({{a, 0.0, {}}, {b, 0.0, {}}}, 0));
+    QTRY_VERIFY(tabs.isTabLoaded(0));
+    auto* scene = tabs.tab(0).scene;
+    auto* child = scene->rootNode()->childAt(3);
+    const quint64 childId = child->id();
+    scene->undoStack()->push(new EditTextCommand(scene, child, "Child", "Edited"));
+
+    // The current tab is never hibernated
+    QVERIFY(!tabs.hibernateTab(0));
+    tabs.tabBar()->setCurrentIndex(1);
+    const qsizetype awake = tabs.tabMemoryBytes(0);
+    QVERIFY(tabs.hibernateTab(0));
+    QVERIFY(tabs.isTabHibernated(0));
+    QVERIFY(tabs.tabMemoryBytes(0) < awake);
+    QVERIFY(scene->items().isEmpty());
+    QVERIFY(tabs.tabBar()->tabToolTip(0).contains("hibernated"));
+    QVERIFY(tabs.tabBar()->tabText(0).startsWith("* "));
+
+    // Showing it again rebuilds the map with its history
+    tabs.tabBar()->setCurrentIndex(0);
+    QVERIFY(!tabs.isTabHibernated(0));
+    QCOMPARE(scene->nodeById(childId)->text(), QString("Edited"));
+    scene->undoStack()->undo();
+    QCOMPARE(scene->nodeById(childId)->text(), QString("Child"));
+}
+
+void tst_TabManager::memoryBudgetHibernatesIdleTabs() {
+    const QString a = saveMap("Alpha", 500);
+    const QString b = saveMap("Beta", 500);
+    const QString c = saveMap("Gamma");
+
+    auto& settings = AppSettings::instance();
+    const int budget = settings.tabMemoryBudgetMB();
+    const int idle = settings.hibernateAfterMinutes();
+    settings.setHibernateAfterMinutes(0);
+    settings.setTabMemoryBudgetMB(1);
+
+    QWidget window;
+    QAction undo;
+    QAction redo;
+    TabManager tabs(&window);
+    tabs.init(&undo, &redo);
+    QVERIFY(tabs.restoreSession({{a, 0.0, {}}, {b, 0.0, {}}, {c, 0.0, {}}}, 0));
+    QTRY_VERIFY(tabs.isTabLoaded(0));
+    tabs.tabBar()->setCurrentIndex(1);
+    QTRY_VERIFY(tabs.isTabLoaded(1));
+    tabs.tabBar()->setCurrentIndex(2);
+    QTRY_VERIFY(tabs.isTabLoaded(2));
+    QVERIFY(tabs.tabMemoryBytes(0) + tabs.tabMemoryBytes(1) > 1024 * 1024);
+
+    // The longest-idle tab goes first, and only as many as the budget needs
+    tabs.applyHibernationPolicy();
+    QVERIFY(tabs.isTabHibernated(0));
+    QVERIFY(!tabs.isTabHibernated(2));
+    qsizetype total = 0;
+    for (int i = 0; i < tabs.tabCount(); ++i)
+        total += tabs.tabMemoryBytes(i);
+    QVERIFY(total <= 1024 * 1024 || tabs.isTabHibernated(1));
+
+    settings.setTabMemoryBudgetMB(budget);
+    settings.setHibernateAfterMinutes(idle);
+}
+
+void tst_TabManager::openShowsProgressUntilBuilt() {
+    const QString path = saveMap("Large", 5000);
+
+    QWidget window;
+    QAction undo;
+    QAction redo;
+    TabManager tabs(&window);
+    tabs.init(&undo, &redo);
+    tabs.addNewTab();
+
+    // The tab is there at once, with a progress page over an empty scene
+    const int index = tabs.openTab(path);
+    QCOMPARE(tabs.tabCount(), 2);
+    QCOMPARE(tabs.currentIndex(), index);
+    QVERIFY(tabs.isTabLoading(index));
+    QCOMPARE(tabs.tab(index).stack->currentWidget()->objectName(), QString("tabLoadingPage"));
+    QCOMPARE(tabs.findTabByFilePath(path), index);
+
+    QTRY_VERIFY(!tabs.isTabLoading(index));
+    auto* scene = tabs.tab(index).scene;
+    QCOMPARE(scene->rootNode()->text(), QString("Large"));
+    QCOMPARE(scene->nodeCount(), 5001);
+    QVERIFY(!scene->isModified());
+    QCOMPARE(tabs.tab(index).stack->currentWidget(), tabs.tab(index).view);
+    QVERIFY(AppSettings::instance().recentFiles().contains(path));
+}
+
+void tst_TabManager::closingCancelsLoad() {
+    const QString path = saveMap("Closed", 5000);
+
+    QWidget window;
+    QAction undo;
+    QAction redo;
+    TabManager tabs(&window);
+    tabs.init(&undo, &redo);
+    tabs.addNewTab();
+
+    const int index = tabs.openTab(path);
+    QVERIFY(tabs.isTabLoading(index));
+    tabs.closeTab(index);
+    QCOMPARE(tabs.tabCount(), 1);
+    QCOMPARE(tabs.findTabByFilePath(path), -1);
+    // The worker's late result goes nowhere
+    QTest::qWait(200);
+    QCOMPARE(tabs.tabCount(), 1);
+}
+
+void tst_TabManager::externalChangeReloadsInPlace() {
+    const QString path = saveMap("Watched", 3);
+
+    QWidget window;
+    QAction undo;
+    QAction redo;
+    TabManager tabs(&window);
+    tabs.init(&undo, &redo);
+    tabs.addNewTab();
+    const int index = tabs.openTab(path);
+    QTRY_VERIFY(tabs.isTabLoaded(index));
+    auto* scene = tabs.tab(index).scene;
+    auto* first = scene->rootNode()->childAt(0);
+    const int steps = scene->undoStack()->count();
+    QSignalSpy reloaded(&tabs, &TabManager::tabReloaded);
+
+    // Our own save is not an external change
+    QVERIFY(scene->saveToFile(path));
+    QTest::qWait(TabManager::kReloadDelayMs * 3);
+    QCOMPARE(reloaded.count(), 0);
+
+    // Another writer renames one node and adds another
+    {
+        MindMapScene other;
+        QVERIFY(other.loadFromFile(path));
+        other.rootNode()->childAt(0)->setText("Changed elsewhere");
+        other.addNode("Added elsewhere", other.rootNode());
+        QVERIFY(other.saveToFile(path));
+    }
+    QTRY_COMPARE(reloaded.count(), 1);
+    QCOMPARE(reloaded.at(0).at(0).toInt(), index);
+    QCOMPARE(reloaded.at(0).at(1).toInt(), 2);
+
+    // The items were updated in place; the map matches the file, one undo away
+    QCOMPARE(scene->rootNode()->childAt(0), first);
+    QCOMPARE(first->text(), QString("Changed elsewhere"));
+    QCOMPARE(scene->rootNode()->childNodes().size(), 4);
+    QVERIFY(!scene->isModified());
+    QCOMPARE(scene->undoStack()->count(), steps + 1);
+    scene->undoStack()->undo();
+    QCOMPARE(first->text(), QString("Child"));
+    QCOMPARE(scene->rootNode()->childNodes().size(), 3);
+}
+
+void tst_TabManager::externalChangeAsksBeforeReplacingEdits() {
+    const QString path = saveMap("Edited", 3);
+
+    QWidget window;
+    QAction undo;
+    QAction redo;
+    TabManager tabs(&window);
+    tabs.init(&undo, &redo);
+    tabs.addNewTab();
+    const int index = tabs.openTab(path);
+    QTRY_VERIFY(tabs.isTabLoaded(index));
+    auto* scene = tabs.tab(index).scene;
+    auto* first = scene->rootNode()->childAt(0);
+    auto* last = scene->rootNode()->childAt(2);
+    scene->undoStack()->push(new EditTextCommand(scene, last, "Child", "Mine"));
+    QVERIFY(scene->isModified());
+    QSignalSpy reloaded(&tabs, &TabManager::tabReloaded);
+
+    const auto writeElsewhere = [&path](const QString& text) {
+        MindMapScene other;
+        QVERIFY(other.loadFromFile(path));
+        other.rootNode()->childAt(0)->setText(text);
+        QVERIFY(other.saveToFile(path));
+    };
+
+    // Keeping the edits leaves the map as it was
+    int asked = 0;
+    answerReloadPrompt("keepButton", &asked);
+    writeElsewhere("Changed elsewhere");
+    QTRY_COMPARE(asked, 1);
+    QTest::qWait(TabManager::kReloadDelayMs * 3);
+    QCOMPARE(reloaded.count(), 0);
+    QCOMPARE(first->text(), QString("Child"));
+    QCOMPARE(last->text(), QString("Mine"));
+    QVERIFY(scene->isModified());
+
+    // Reloading replaces them, one undo step away
+    asked = 0;
+    answerReloadPrompt("reloadButton", &asked);
+    writeElsewhere("Changed again");
+    QTRY_COMPARE(reloaded.count(), 1);
+    QCOMPARE(asked, 1);
+    QCOMPARE(first->text(), QString("Changed again"));
+    QCOMPARE(last->text(), QString("Child"));
+    QVERIFY(!scene->isModified());
+    scene->undoStack()->undo();
+    QCOMPARE(first->text(), QString("Child"));
+    QCOMPARE(last->text(), QString("Mine"));
+    QVERIFY(scene->isModified());
+}
+
+QTEST_MAIN(tst_TabManager)
+#include "tst_TabManager.moc"
@@ -0,0 +1,110 @@
+#include "core/TemplateRegistry.h"
+#include "layout/LayoutAlgorithmRegistry.h"
+#include "scene/MindMapScene.h"
+#include "scene/NodeItem.h"
+#include "ui/ThumbnailCache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+class tst_ThumbnailCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void renderDrawsSavedMap();
+    void renderRejectsForeignJson();
+    void cacheKeyFollowsFile();
+    void thumbnailRendersInBackgroundAndIsCached();
+};
+
+void tst_ThumbnailCache::initTestCase() {
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(ThumbnailCache::cacheDirectory()).removeRecursively();
+    TemplateRegistry::instance().loadBuiltins();
+    LayoutAlgorithmRegistry::instance().registerBuiltins();
+}
+
+void tst_ThumbnailCache::renderDrawsSavedMap() {
+    MindMapScene scene;
+    scene.rootNode()->setText("Root");
+    scene.addNode("A", scene.rootNode());
+    scene.addNode("B", scene.rootNode());
+
+    const QSize size(ThumbnailCache::kWidth, ThumbnailCache::kHeight);
+    QImage image = ThumbnailCache::render(scene.toJson(), size, {});
+    QCOMPARE(image.size(), size);
+
+    // Something was drawn, and the background stays transparent
+    int opaque = 0;
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            if (qAlpha(image.pixel(x, y)) > 0)
+                ++opaque;
+        }
+    }
+    QVERIFY(opaque > 0);
+    QCOMPARE(qAlpha(image.pixel(0, 0)), 0);
+}
+
+void tst_ThumbnailCache::renderRejectsForeignJson() {
+    QVERIFY(ThumbnailCache::render(QJsonObject{{"format", "other"}}, QSize(10, 10), {}).isNull());
+}
+
+void tst_ThumbnailCache::cacheKeyFollowsFile() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("map.ymind");
+    QVERIFY(ThumbnailCache::cacheKey(path, "light").isEmpty());
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("{}");
+    file.close();
+
+    const QString key = ThumbnailCache::cacheKey(path, "light");
+    QVERIFY(!key.isEmpty());
+    QCOMPARE(ThumbnailCache::cacheKey(path, "light"), key);
+    QVERIFY(ThumbnailCache::cacheKey(path, "dark") != key);
+
+    QVERIFY(file.open(QIODevice::Append));
+    file.write(" ");
+    file.close();
+    QVERIFY(ThumbnailCache::cacheKey(path, "light") != key);
+}
+
+void tst_ThumbnailCache::thumbnailRendersInBackgroundAndIsCached() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("map.ymind");
+
+    MindMapScene scene;
+    scene.addNode("Child", scene.rootNode());
+    QVERIFY(scene.saveToFile(path));
+
+    auto& cache = ThumbnailCache::instance();
+    QSignalSpy spy(&cache, &ThumbnailCache::thumbnailReady);
+    QVERIFY(spy.isValid());
+
+    // Nothing is rendered on the calling thread
+    QVERIFY(cache.thumbnail(path).isNull());
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(spy.first().at(0).toString(), path);
+    QVERIFY(!spy.first().at(1).value<QImage>().isNull());
+    QCOMPARE(QDir(ThumbnailCache::cacheDirectory()).entryList({"*.png"}).size(), 1);
+
+    // Unchanged file: the image comes from memory and no signal follows
+    spy.clear();
+    QVERIFY(!cache.thumbnail(path).isNull());
+    QVERIFY(!spy.wait(300));
+
+    QDir(ThumbnailCache::cacheDirectory()).removeRecursively();
+}
+
+QTEST_MAIN(tst_ThumbnailCache)
+#include "tst_ThumbnailCache.moc"